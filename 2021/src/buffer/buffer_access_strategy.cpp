@@ -0,0 +1,36 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.cpp
+//
+// Identification: src/buffer/buffer_access_strategy.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_access_strategy.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+namespace {
+
+/** Small enough for a scan's ring to stay in L2. */
+constexpr size_t BULK_READ_RING_BYTES = 256 * 1024;
+/** Larger, so that dirty frames get written back in batches rather than one per new page. */
+constexpr size_t BULK_WRITE_RING_BYTES = 16 * 1024 * 1024;
+
+}  // namespace
+
+BufferAccessStrategy::BufferAccessStrategy(BufferAccessType type, size_t pool_size, size_t min_ring_size)
+    : type_(type) {
+  size_t ring_bytes = type == BufferAccessType::BULK_READ ? BULK_READ_RING_BYTES : BULK_WRITE_RING_BYTES;
+  // a ring must never crowd out the rest of the pool
+  size_t ring_size = std::max({size_t{1}, min_ring_size, std::min(ring_bytes / PAGE_SIZE, pool_size / 8)});
+  ring_.resize(ring_size);
+}
+
+}  // namespace bustub
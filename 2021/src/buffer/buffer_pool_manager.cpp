@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager.cpp
+//
+// Identification: src/buffer/buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_manager.h"
+
+#include <algorithm>
+#include <fstream>
+#include <thread>  // NOLINT
+#include <unordered_set>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+namespace {
+
+/** Warm-up file layout: magic, page count, then the page ids, hottest first. */
+constexpr uint32_t WARM_UP_MAGIC = 0x57505542;  // "BUPW"
+
+}  // namespace
+
+Page *BufferPoolManager::NewPage(page_id_t *page_id, PageSegment &segment, BufferAccessStrategy *strategy) {
+  std::scoped_lock lock(segment.latch_);
+  if (segment.next_ == segment.end_) {
+    page_id_t first = AllocateExtentImp(segment.extent_pages_);
+    if (first == INVALID_PAGE_ID) {
+      return NewPgImp(page_id, strategy);
+    }
+    segment.next_ = first;
+    segment.end_ = first + static_cast<page_id_t>(segment.extent_pages_);
+    segment.num_extents_++;
+  }
+  // a page id is only used up once its page exists; if every frame is pinned the next call tries the same id again
+  Page *page = NewPgAtImp(segment.next_, strategy);
+  if (page != nullptr) {
+    *page_id = segment.next_++;
+  }
+  return page;
+}
+
+bool BufferPoolManager::DumpResidentPages(const std::string &path) {
+  std::vector<page_id_t> page_ids = GetResidentPages();
+  std::ofstream out(path, std::ios::binary | std::ios::trunc | std::ios::out);
+  if (!out.is_open()) {
+    LOG_DEBUG("cannot open warm-up file %s", path.c_str());
+    return false;
+  }
+  uint32_t magic = WARM_UP_MAGIC;
+  uint64_t count = page_ids.size();
+  out.write(reinterpret_cast<const char *>(&magic), sizeof(magic));
+  out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+  out.write(reinterpret_cast<const char *>(page_ids.data()), static_cast<std::streamsize>(count * sizeof(page_id_t)));
+  out.flush();
+  return !out.fail();
+}
+
+size_t BufferPoolManager::WarmUp(const std::string &path, size_t num_threads) {
+  std::ifstream in(path, std::ios::binary | std::ios::in);
+  if (!in.is_open()) {
+    return 0;
+  }
+  uint32_t magic = 0;
+  uint64_t count = 0;
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char *>(&count), sizeof(count));
+  if (in.fail() || magic != WARM_UP_MAGIC) {
+    LOG_DEBUG("%s is not a warm-up file", path.c_str());
+    return 0;
+  }
+  // every loaded page stays pinned until all reads are done, so only the hottest pool-size pages can come back
+  std::vector<page_id_t> hot_first(std::min<uint64_t>(count, GetPoolSize()));
+  in.read(reinterpret_cast<char *>(hot_first.data()),
+          static_cast<std::streamsize>(hot_first.size() * sizeof(page_id_t)));
+  if (in.fail()) {
+    LOG_DEBUG("warm-up file %s is truncated", path.c_str());
+    return 0;
+  }
+  std::unordered_set<page_id_t> seen;
+  hot_first.erase(std::remove_if(hot_first.begin(), hot_first.end(),
+                                 [&seen](page_id_t page_id) {
+                                   return page_id == INVALID_PAGE_ID || !seen.insert(page_id).second;
+                                 }),
+                  hot_first.end());
+
+  // Read in file offset order; each thread takes one contiguous run, so its reads stay sequential on disk.
+  std::vector<page_id_t> by_offset = hot_first;
+  std::sort(by_offset.begin(), by_offset.end());
+  num_threads = std::max<size_t>(1, std::min(num_threads, by_offset.size()));
+  std::vector<char> loaded(by_offset.size(), 0);
+  std::vector<std::thread> readers;
+  size_t chunk = (by_offset.size() + num_threads - 1) / num_threads;
+  for (size_t begin = 0; begin < by_offset.size(); begin += chunk) {
+    size_t end = std::min(by_offset.size(), begin + chunk);
+    readers.emplace_back([this, &by_offset, &loaded, begin, end] {
+      for (size_t i = begin; i < end; i++) {
+        loaded[i] = static_cast<char>(FetchPgImp(by_offset[i]) != nullptr);
+      }
+    });
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  // unpin coldest first, so the hottest pages end up the most recently used
+  size_t num_loaded = 0;
+  for (auto it = hot_first.rbegin(); it != hot_first.rend(); ++it) {
+    size_t i = std::lower_bound(by_offset.begin(), by_offset.end(), *it) - by_offset.begin();
+    if (loaded[i] != 0) {
+      UnpinPgImp(*it, false);
+      num_loaded++;
+    }
+  }
+  return num_loaded;
+}
+
+}  // namespace bustub
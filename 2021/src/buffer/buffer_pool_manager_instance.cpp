@@ -12,29 +12,59 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 #include "common/macros.h"
 
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager) {}
+                                                     LogManager *log_manager, ReplacerPolicy replacer_policy,
+                                                     const FrameArenaOptions &arena_options)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, replacer_policy, PageRouting::MODULO,
+                                arena_options) {}
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                                                     DiskManager *disk_manager, LogManager *log_manager)
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerPolicy replacer_policy, PageRouting routing,
+                                                     const FrameArenaOptions &arena_options)
     : pool_size_(pool_size),
       num_instances_(num_instances),
       instance_index_(instance_index),
-      next_page_id_(instance_index),
+      routing_(routing),
+      arena_(pool_size, arena_options),
       disk_manager_(disk_manager),
-      log_manager_(log_manager) {
+      log_manager_(log_manager),
+      page_table_(pool_size),
+      num_unpinned_frames_(pool_size),
+      prefetcher_(this, pool_size) {
   BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
   BUSTUB_ASSERT(
       instance_index < num_instances,
       "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
+  // Page ids come from the disk manager, one allocation partition per instance so that every instance only hands
+  // out ids that route back to it. The first instance sets that up for the whole pool.
+  if (instance_index_ == 0) {
+    disk_manager_->SetAllocationPartitions(num_instances, [num_instances, routing](page_id_t page_id) {
+      return InstanceForPage(page_id, num_instances, routing);
+    });
+  }
   // We allocate a consecutive memory space for the buffer pool.
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size);
+  pages_ = arena_.GetPages();
+  switch (replacer_policy) {
+    case ReplacerPolicy::CLOCK:
+      replacer_ = new ClockReplacer(pool_size);
+      break;
+    case ReplacerPolicy::LRU_K:
+      replacer_ = new LRUKReplacer(pool_size);
+      break;
+    case ReplacerPolicy::LRU:
+    default:
+      replacer_ = new LRUReplacer(pool_size);
+      break;
+  }
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
@@ -43,132 +73,333 @@ BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
-  delete[] pages_;
+  prefetcher_.Stop();
+  StopPageCleaner();
   delete replacer_;
 }
 
-bool BufferPoolManagerInstance::find_replace(frame_id_t *frame_id) {
+bool BufferPoolManagerInstance::find_replace(frame_id_t *frame_id, page_id_t *writeback_page_id,
+                                             BufferAccessStrategy *strategy) {
+  *writeback_page_id = INVALID_PAGE_ID;
+  if (strategy != nullptr && ReuseRingFrame(strategy, frame_id, writeback_page_id)) {
+    return true;
+  }
   if (!free_list_.empty()) {
     *frame_id = free_list_.front();
     free_list_.pop_front();
     return true;
   }
-  // free list is not empty
-  // use is pointer right!
+  // free list is empty, the replacer has to give us a victim
+  while (replacer_->Victim(frame_id)) {
+    // A hit may have pinned the frame after the replacer handed it out; such a frame is skipped here and goes
+    // back into the replacer when its last pin is dropped.
+    if (EvictFrame(*frame_id, writeback_page_id)) {
+      return true;
+    }
+  }
 
-  // the frame id tha is to be replaced
-  if (replacer_->Victim(frame_id)) {
-    page_id_t replace_page_id = -1;
+  return false;
+}
+
+bool BufferPoolManagerInstance::ReuseRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id,
+                                               page_id_t *writeback_page_id) {
+  BufferAccessStrategy::Slot *slot = strategy->NextSlot();
+  // Frames are only reassigned under latch_, so if the frame still holds the page the ring loaded into it, nobody
+  // outside the ring has taken it over. Then it only remains to check that it is not pinned.
+  if (slot->owner_ != this || pages_[slot->frame_id_].page_id_ != slot->page_id_ ||
+      !EvictFrame(slot->frame_id_, writeback_page_id)) {
+    return false;
+  }
+  // The frame leaves the replacer exactly as a victim would, past and all: a Pin would count the reuse as a reference,
+  // and under LRU-K a ring frame would pile up the references of every page that passed through it.
+  replacer_->Remove(slot->frame_id_);
+  *frame_id = slot->frame_id_;
+  return true;
+}
 
-    for (const auto &p : page_table_) {
-      page_id_t pid = p.first;
-      frame_id_t fid = p.second;
+bool BufferPoolManagerInstance::EvictFrame(frame_id_t frame_id, page_id_t *writeback_page_id) {
+  // pages_ is indexed by frame id, so the victim's page id is right there and we
+  // never have to walk the page table to find out who lives in this frame
+  Page *replace_page = &pages_[frame_id];
 
-      if (fid == *frame_id) {
-        replace_page_id = pid;
-        break;
-      }
+  // Hits pin under the page table stripe latch, so checking the pin count under that same latch is final. The entry
+  // must point at this very frame: the page may have moved on to another one meanwhile.
+  if (!page_table_.RemoveIf(replace_page->page_id_, [frame_id, replace_page](frame_id_t fid) {
+        return fid == frame_id && replace_page->pin_count_ == 0;
+      })) {
+    return false;
+  }
+
+  // dirty page which need to be written back. The caller does the write after dropping latch_; until then the
+  // page sits in pending_writes_ so nobody reads the stale copy from disk.
+  if (replace_page->is_dirty_) {
+    *writeback_page_id = replace_page->page_id_;
+    pending_writes_.insert(replace_page->page_id_);
+    replace_page->is_dirty_ = false;
+    dirty_evictions_.Add();
+  } else {
+    clean_evictions_.Add();
+  }
+  replace_page->page_id_ = INVALID_PAGE_ID;
+  return true;
+}
+
+Page *BufferPoolManagerInstance::ClaimFrame(frame_id_t frame_id, page_id_t page_id) {
+  Page *page = &pages_[frame_id];
+  page->page_id_ = page_id;
+  page->pin_count_ = 1;
+  num_unpinned_frames_--;
+  page->is_dirty_ = false;
+  // anyone who finds the page from now on pins it and waits in WaitForIo until FinishIo
+  page->io_in_progress_ = true;
+  page_table_.Insert(page_id, frame_id);
+  return page;
+}
+
+std::unique_lock<std::mutex> BufferPoolManagerInstance::LockLatch() {
+  latch_acquisitions_.Add();
+  std::unique_lock lock(latch_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    // only a contended acquisition pays for reading the clock
+    latch_contended_.Add();
+    auto start = std::chrono::steady_clock::now();
+    lock.lock();
+    latch_wait_.RecordSince(start);
+  }
+  return lock;
+}
+
+void BufferPoolManagerInstance::ReadFromDisk(page_id_t page_id, char *data) {
+  auto start = std::chrono::steady_clock::now();
+  disk_manager_->ReadPage(page_id, data);
+  read_latency_.RecordSince(start);
+}
+
+void BufferPoolManagerInstance::WriteToDisk(page_id_t page_id, Page *page) {
+  auto start = std::chrono::steady_clock::now();
+  if (enable_logging && log_manager_ != nullptr && page->has_lsn_) {
+    // write-ahead: the log records that changed the page reach the disk before the page does
+    log_manager_->Flush(page->GetLSN());
+  }
+  disk_manager_->WritePage(page_id, page->data_);
+  write_latency_.RecordSince(start);
+}
+
+void BufferPoolManagerInstance::ReadFromDisk(const std::vector<page_id_t> &page_ids, const std::vector<char *> &data) {
+  auto start = std::chrono::steady_clock::now();
+  disk_manager_->ReadPages(page_ids.data(), data.data(), page_ids.size());
+  // the pages are read back to back, so each one is charged its share of the batch
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    read_latency_.Record(elapsed.count() / page_ids.size());
+  }
+}
+
+void BufferPoolManagerInstance::FinishIo(Page *page, page_id_t writeback_page_id) {
+  {
+    auto lock = LockLatch();
+    if (writeback_page_id != INVALID_PAGE_ID) {
+      pending_writes_.erase(writeback_page_id);
     }
+    // the write-back is done, and the page now in the frame has not been stamped yet
+    page->has_lsn_ = false;
+    page->io_in_progress_ = false;
+  }
+  io_cv_.notify_all();
+}
 
-    if (replace_page_id != -1) {
-      Page *replace_page = &pages_[*frame_id];
+void BufferPoolManagerInstance::WaitForIo(Page *page) {
+  if (!page->io_in_progress_) {
+    return;
+  }
+  std::unique_lock lock(latch_);
+  io_cv_.wait(lock, [page] { return !page->io_in_progress_; });
+}
 
-      // dirty page which need to be writeen back
-      if (replace_page->is_dirty_) {
-        char *data = pages_[page_table_[replace_page->page_id_]].data_;
-        disk_manager_->WritePage(replace_page->page_id_, data);
-        replace_page->pin_count_ = 0;  // Reset pin_count
-      }
+Page *BufferPoolManagerInstance::PinResident(page_id_t page_id, bool touch_replacer) {
+  Page *page = nullptr;
+  page_table_.FindAndApply(page_id, [this, touch_replacer, &page](frame_id_t frame_id) {
+    page = &pages_[frame_id];
+    if (page->pin_count_++ == 0) {
+      num_unpinned_frames_--;
+    }
+    // erase from replacer
+    if (touch_replacer) {
+      replacer_->Pin(frame_id);
+    }
+  });
+  return page;
+}
 
-      page_table_.erase(replace_page->page_id_);
+void BufferPoolManagerInstance::RunPageCleaner(const PageCleanerConfig &config) {
+  std::scoped_lock lock(cleaner_latch_);
+  if (cleaner_running_) {
+    return;
+  }
+  cleaner_running_ = true;
+  cleaner_thread_ = new std::thread([this, config] {
+    std::unique_lock cleaner_lock(cleaner_latch_);
+    while (cleaner_running_) {
+      cleaner_lock.unlock();
+      CleanColdFrames(config);
+      cleaner_lock.lock();
+      cleaner_cv_.wait_for(cleaner_lock, config.interval_, [this] { return !cleaner_running_; });
     }
-    return true;
+  });
+}
+
+void BufferPoolManagerInstance::StopPageCleaner() {
+  {
+    std::scoped_lock lock(cleaner_latch_);
+    if (!cleaner_running_) {
+      return;
+    }
+    cleaner_running_ = false;
   }
+  cleaner_cv_.notify_all();
+  cleaner_thread_->join();
+  delete cleaner_thread_;
+  cleaner_thread_ = nullptr;
+}
 
-  return false;
+size_t BufferPoolManagerInstance::CleanColdFrames(const PageCleanerConfig &config) {
+  std::vector<frame_id_t> cold_frames = replacer_->PeekVictims(config.clean_watermark_);
+  if (cold_frames.empty()) {
+    return 0;
+  }
+  // frames only change hands under latch_, so take one snapshot of who lives where
+  std::vector<page_id_t> cold_pages;
+  {
+    std::scoped_lock lock(latch_);
+    for (frame_id_t frame_id : cold_frames) {
+      if (pages_[frame_id].is_dirty_ && pages_[frame_id].page_id_ != INVALID_PAGE_ID) {
+        cold_pages.push_back(pages_[frame_id].page_id_);
+      }
+    }
+  }
+
+  size_t writes = 0;
+  for (page_id_t page_id : cold_pages) {
+    if (writes == config.max_writes_per_round_) {
+      break;
+    }
+    // Pin without warming the frame up. The pin keeps it from being evicted during the write; if it is evicted
+    // right before, PinResident simply misses.
+    Page *page = PinResident(page_id, false);
+    if (page == nullptr) {
+      continue;
+    }
+    if (!page->io_in_progress_ && page->is_dirty_) {
+      page->is_dirty_ = false;
+      WriteToDisk(page_id, page);
+      background_writes_.Add();
+      writes++;
+    }
+    UnpinPgImp(page_id, false);
+  }
+  return writes;
 }
 
 bool BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) {
   // Make sure you call DiskManager::WritePage!
-  // It has get the lock outside
-  //latch_.lock();
-
-  auto iter = page_table_.find(page_id);
-  if (iter == page_table_.end() || page_id == INVALID_PAGE_ID) {
-    latch_.unlock();
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  // hold a pin instead of latch_ across the write, that alone keeps the frame from being evicted; a flush is not an
+  // access, so leave the replacer alone
+  Page *page = PinResident(page_id, false);
+  if (page == nullptr) {
     return false;
   }
+  WaitForIo(page);
+  // clear the flag before writing: an unpin that dirties the page concurrently must win
+  page->is_dirty_ = false;
+  WriteToDisk(page_id, page);
+  UnpinPgImp(page_id, false);
+  return true;
+}
 
-  frame_id_t flush_id = iter->second;
-  disk_manager_->WritePage(page_id, pages_[flush_id].data_);
+void BufferPoolManagerInstance::FlushAllPgsImp() {
+  // write all resident pages into the disk, one page at a time
+  std::vector<page_id_t> resident;
+  {
+    std::scoped_lock lock(latch_);
+    for (size_t i = 0; i < pool_size_; i++) {
+      if (pages_[i].page_id_ != INVALID_PAGE_ID) {
+        resident.push_back(pages_[i].page_id_);
+      }
+    }
+  }
+  for (page_id_t page_id : resident) {
+    FlushPgImp(page_id);
+  }
+  // writes only reach the OS page cache; flushing everything is a durability point, e.g. for a checkpoint
+  disk_manager_->Sync();
+}
 
-  // flush should be successfull
-  //latch_.unlock();
+Page *BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) { return NewPgImp(page_id, nullptr); }
 
-  return true;
+Page *BufferPoolManagerInstance::NewPgImp(page_id_t *page_id, BufferAccessStrategy *strategy) {
+  Page *page = CreatePage(INVALID_PAGE_ID, strategy);
+  if (page != nullptr) {
+    *page_id = page->page_id_;
+  }
+  return page;
 }
 
-void BufferPoolManagerInstance::FlushAllPgsImp() {
-  // You can do it!
-  // write all dirty pages into the disk yes!
-  latch_.lock();
-  for (auto item : page_table_) {
-    // item is page_id_t
-    FlushPgImp(item.first);
-  }
-  latch_.unlock();
-  return;
+page_id_t BufferPoolManagerInstance::AllocateExtentImp(size_t num_pages) {
+  return disk_manager_->AllocateExtent(num_pages);
+}
+
+Page *BufferPoolManagerInstance::NewPgAtImp(page_id_t page_id, BufferAccessStrategy *strategy) {
+  ValidatePageId(page_id);
+  return CreatePage(page_id, strategy);
 }
 
-Page *BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) {
+Page *BufferPoolManagerInstance::CreatePage(page_id_t new_page_id, BufferAccessStrategy *strategy) {
   // 0.   Make sure you call AllocatePage!
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
-  // 4.   Set the page ID output parameter. Return a pointer to P.
-  latch_.lock();
-
-  page_id_t new_page_id = AllocatePage();
-
-  bool is_all = true;
-  for (int i = 0; i < static_cast<int>(pool_size_); i++) {
-    if (pages_[i].pin_count_ == 0) {
-      is_all = false;
-      break;
-    }
-  }
-  // all pages are pinned
+  // 4.   Return a pointer to P; NewPgImp hands its page id out.
 
-  if (is_all) {
-    latch_.unlock();
+  // all pages are pinned, fail before touching latch_ or burning a page id
+  if (num_unpinned_frames_ == 0) {
+    new_page_failures_.Add();
     return nullptr;
   }
 
+  auto lock = LockLatch();
   frame_id_t victim_frame_id;
-  if (!find_replace(&victim_frame_id)) {
-    latch_.unlock();
+  page_id_t writeback_page_id;
+  if (!find_replace(&victim_frame_id, &writeback_page_id, strategy)) {
+    new_page_failures_.Add();
     return nullptr;
   }
+  new_pages_.Add();
+  if (new_page_id == INVALID_PAGE_ID) {
+    new_page_id = AllocatePage();
+  }
+  Page *victim_page = ClaimFrame(victim_frame_id, new_page_id);
+  if (strategy != nullptr) {
+    strategy->SetCurrent(this, victim_frame_id, new_page_id);
+  }
+  lock.unlock();
 
-  Page *victim_page = &pages_[victim_frame_id];
-  victim_page->page_id_ = new_page_id;
-  victim_page->pin_count_++;
-  // move to the front
-  replacer_->Pin(victim_frame_id);
-
-  // forget to add the new mapping
-  page_table_[new_page_id] = victim_frame_id;
-
-  victim_page->is_dirty_ = false;
-  *page_id = new_page_id;
-
-  disk_manager_->WritePage(victim_page->GetPageId(), victim_page->GetData());
-
-  latch_.unlock();
+  // disk I/O happens without latch_; the frame is pinned and marked as in I/O
+  if (writeback_page_id != INVALID_PAGE_ID) {
+    WriteToDisk(writeback_page_id, victim_page);
+    foreground_writes_.Add();
+  }
+  victim_page->ResetMemory();
+  WriteToDisk(new_page_id, victim_page);
+  FinishIo(victim_page, writeback_page_id);
   return victim_page;
 }
 
-Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) {
+Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) { return FetchPgImp(page_id, nullptr); }
+
+Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -176,49 +407,55 @@ Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  latch_.lock();
-
-  std::unordered_map<page_id_t, frame_id_t>::iterator it = page_table_.find(page_id);
-
-  if (it != page_table_.end()) {
-    frame_id_t frame_id = it->second;
-    Page *page = &pages_[frame_id];
+  // 1.1 hits only take the page table stripe latch, never latch_. A bulk access does not make the page any hotter.
+  fetches_.Add();
+  Page *page = PinResident(page_id, strategy == nullptr);
+  if (page != nullptr) {
+    hits_.Add();
+    // the page may still be on its way in from disk
+    WaitForIo(page);
+    return page;
+  }
 
-    page->pin_count_++;
-    // erase form replacer
-    replacer_->Pin(frame_id);
+  if (num_unpinned_frames_ == 0) {
+    fetch_failures_.Add();
+    return nullptr;
+  }
 
-    latch_.unlock();
+  auto lock = LockLatch();
+  // Frames are only (re)assigned under latch_, so the page may have been brought in while we waited for it. If it
+  // is being written out by an eviction right now, wait for that write: the copy on disk is stale until then.
+  while ((page = PinResident(page_id, strategy == nullptr)) == nullptr && pending_writes_.count(page_id) != 0) {
+    io_cv_.wait(lock);
+  }
+  if (page != nullptr) {
+    hits_.Add();
+    lock.unlock();
+    WaitForIo(page);
     return page;
   }
 
   frame_id_t replace_id;
-  if (!find_replace(&replace_id)) {
-    latch_.unlock();
+  page_id_t writeback_page_id;
+  if (!find_replace(&replace_id, &writeback_page_id, strategy)) {
+    fetch_failures_.Add();
     return nullptr;
   }
-  Page *replacepage = &pages_[replace_id];
-
-  if (replacepage->IsDirty()) {
-    disk_manager_->WritePage(replacepage->page_id_, replacepage->data_);
+  misses_.Add();
+  // publish the page as loading, so concurrent fetchers of P wait on this frame instead of reading it again
+  page = ClaimFrame(replace_id, page_id);
+  if (strategy != nullptr) {
+    strategy->SetCurrent(this, replace_id, page_id);
   }
+  lock.unlock();
 
-  page_table_.erase(replacepage->page_id_);
-  // target frame id is always here
-  page_table_[page_id] = replace_id;
-
-  Page *newPage = replacepage;
-  disk_manager_->ReadPage(page_id, newPage->data_);
-  newPage->page_id_ = page_id;
-  newPage->pin_count_++;
-  newPage->is_dirty_ = false;
-  replacer_->Pin(replace_id);
-
-  latch_.unlock();
-
-  //return nullptr;
-  return newPage;
-
+  if (writeback_page_id != INVALID_PAGE_ID) {
+    WriteToDisk(writeback_page_id, page);
+    foreground_writes_.Add();
+  }
+  ReadFromDisk(page_id, page->data_);
+  FinishIo(page, writeback_page_id);
+  return page;
 }
 
 bool BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) {
@@ -227,90 +464,242 @@ bool BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) {
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-  latch_.lock();
-
-  // DeallocatePage(page_id);
-
-  if (page_table_.find(page_id) == page_table_.end()) {
-    latch_.unlock();
-    return true;
+  std::unique_lock lock(latch_);
+  // an eviction may still be writing the page out; it must land before the page can be handed out again
+  while (pending_writes_.count(page_id) != 0) {
+    io_cv_.wait(lock);
   }
 
-  frame_id_t del_frame_id = page_table_[page_id];
-  Page *del_page = &pages_[del_frame_id];
-
-  if (del_page->pin_count_ > 0) {
-    latch_.unlock();
-    // someone pin on the page
-    return false;
-  }
-
-  if (del_page->is_dirty_) {
-    FlushPgImp(page_id);
+  frame_id_t del_frame_id = -1;
+  bool pinned = false;
+  if (!page_table_.RemoveIf(page_id, [this, &del_frame_id, &pinned](frame_id_t frame_id) {
+        del_frame_id = frame_id;
+        pinned = pages_[frame_id].pin_count_ > 0;
+        return !pinned;
+      })) {
+    // not resident at all, so free it on disk only; or someone pin on the page
+    if (!pinned) {
+      DeallocatePage(page_id);
+    }
+    return !pinned;
   }
+  Page *del_page = &pages_[del_frame_id];
 
   // delete in the disk
   DeallocatePage(page_id);
 
-  page_table_.erase(page_id);
+  // the frame must not come back out of the replacer once it sits in the free list, nor keep the deleted page's past
+  replacer_->Remove(del_frame_id);
 
   del_page->is_dirty_ = false;
   del_page->pin_count_ = 0;
   del_page->page_id_ = INVALID_PAGE_ID;
 
   free_list_.push_back(del_frame_id);
-  latch_.unlock();
-
   return true;
 }
 
-// OK I successfully get all the results!
-// Which is always amazing for me.
-
 bool BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) {
-  latch_.lock();
-
-  auto iter = page_table_.find(page_id);
-  if (iter == page_table_.end()) {
-    latch_.unlock();
+  bool unpinned = true;
+  // same stripe latch as the hit path, so a pin and an unpin of one page never interleave with the replacer calls
+  page_table_.FindAndApply(page_id, [this, is_dirty, &unpinned](frame_id_t frame_id) {
+    Page *unpinned_page = &pages_[frame_id];
+    if (is_dirty) {
+      unpinned_page->is_dirty_ = true;
+    }
+    if (unpinned_page->pin_count_ == 0) {
+      unpinned = false;
+      return;
+    }
+    if (--unpinned_page->pin_count_ == 0) {
+      num_unpinned_frames_++;
+      replacer_->Unpin(frame_id);
+    }
+  });
+  // a page that is not resident counts as unpinned
+  return unpinned;
+}
 
-    // this is a damn hole!
-    return true;
+size_t BufferPoolManagerInstance::FetchPgsImp(const page_id_t *page_ids, size_t num_pages, Page **pages) {
+  fetches_.Add(num_pages);
+  // 1. Pin the resident pages under their stripe latches, then update the replacer for all of them in one call.
+  //    Until then a victim search may still pick one of these frames, but EvictFrame sees the pin and skips it.
+  std::vector<frame_id_t> hit_frames;
+  std::vector<size_t> misses;
+  hit_frames.reserve(num_pages);
+  for (size_t i = 0; i < num_pages; i++) {
+    pages[i] = PinResident(page_ids[i], false);
+    if (pages[i] != nullptr) {
+      hit_frames.push_back(static_cast<frame_id_t>(pages[i] - pages_));
+    } else {
+      misses.push_back(i);
+    }
   }
-
-  frame_id_t unpinned_frame_id = iter->second;
-  Page *unpinned_page = &pages_[unpinned_frame_id];
-  if (is_dirty) {
-    unpinned_page->is_dirty_ = true;
+  if (!hit_frames.empty()) {
+    replacer_->PinAll(hit_frames);
+    hits_.Add(hit_frames.size());
   }
 
-  // the exercises there are somehow complex for us.
-  if (unpinned_page->pin_count_ == 0) {
-    latch_.unlock();
-    return false;
+  // 2. Claim frames for the misses under one acquisition of latch_, then do their I/O together. A miss whose page
+  //    is still being written out may be waiting on a write-back of this very batch, so it ends the round instead.
+  size_t next = 0;
+  bool out_of_frames = false;
+  while (next < misses.size() && !out_of_frames) {
+    std::vector<Page *> claimed;
+    std::vector<page_id_t> writebacks;
+    {
+      auto lock = LockLatch();
+      while (next < misses.size()) {
+        size_t i = misses[next];
+        // brought in meanwhile, by another thread or by an earlier occurrence of the same id in this batch
+        if ((pages[i] = PinResident(page_ids[i])) != nullptr) {
+          hits_.Add();
+          next++;
+          continue;
+        }
+        if (pending_writes_.count(page_ids[i]) != 0) {
+          if (!claimed.empty()) {
+            break;
+          }
+          io_cv_.wait(lock);
+          continue;
+        }
+        frame_id_t frame_id;
+        page_id_t writeback_page_id;
+        if (!find_replace(&frame_id, &writeback_page_id)) {
+          out_of_frames = true;
+          break;
+        }
+        misses_.Add();
+        pages[i] = ClaimFrame(frame_id, page_ids[i]);
+        claimed.push_back(pages[i]);
+        writebacks.push_back(writeback_page_id);
+        next++;
+      }
+    }
+    if (claimed.empty()) {
+      continue;
+    }
+
+    for (size_t j = 0; j < claimed.size(); j++) {
+      if (writebacks[j] != INVALID_PAGE_ID) {
+        WriteToDisk(writebacks[j], claimed[j]);
+        foreground_writes_.Add();
+      }
+    }
+    // read in file offset order, so that runs of adjacent pages need no seek
+    std::vector<Page *> by_offset = claimed;
+    std::sort(by_offset.begin(), by_offset.end(), [](Page *a, Page *b) { return a->page_id_ < b->page_id_; });
+    std::vector<page_id_t> read_ids;
+    std::vector<char *> read_data;
+    for (Page *page : by_offset) {
+      read_ids.push_back(page->page_id_);
+      read_data.push_back(page->data_);
+    }
+    ReadFromDisk(read_ids, read_data);
+    {
+      auto lock = LockLatch();
+      for (size_t j = 0; j < claimed.size(); j++) {
+        if (writebacks[j] != INVALID_PAGE_ID) {
+          pending_writes_.erase(writebacks[j]);
+        }
+        claimed[j]->has_lsn_ = false;
+        claimed[j]->io_in_progress_ = false;
+      }
+    }
+    io_cv_.notify_all();
   }
-  unpinned_page->pin_count_--;
-  if (unpinned_page->GetPinCount() == 0) {
-    replacer_->Unpin(unpinned_frame_id);
+  if (next < misses.size()) {
+    // every frame is pinned
+    fetch_failures_.Add(misses.size() - next);
   }
 
-  // NULL
-  latch_.unlock();
-  return true;
+  // 3. Pages found resident may still be on their way in from disk.
+  size_t fetched = 0;
+  for (size_t i = 0; i < num_pages; i++) {
+    if (pages[i] != nullptr) {
+      WaitForIo(pages[i]);
+      fetched++;
+    }
+  }
+  return fetched;
+}
+
+bool BufferPoolManagerInstance::UnpinPgsImp(const page_id_t *page_ids, size_t num_pages, bool is_dirty) {
+  bool unpinned = true;
+  for (size_t i = 0; i < num_pages; i++) {
+    page_table_.FindAndApply(page_ids[i], [this, is_dirty, &unpinned](frame_id_t frame_id) {
+      Page *unpinned_page = &pages_[frame_id];
+      if (is_dirty) {
+        unpinned_page->is_dirty_ = true;
+      }
+      if (unpinned_page->pin_count_ == 0) {
+        unpinned = false;
+        return;
+      }
+      if (--unpinned_page->pin_count_ == 0) {
+        num_unpinned_frames_++;
+        // Under the stripe latch, as in UnpinPgImp: once the latch is dropped the page may be deleted and its frame
+        // put on the free list, and a late unpin would hand that frame to the replacer as well.
+        replacer_->Unpin(frame_id);
+      }
+    });
+  }
+  return unpinned;
 }
 
 page_id_t BufferPoolManagerInstance::AllocatePage() {
-  const page_id_t next_page_id = next_page_id_;
-  next_page_id_ += num_instances_;
-  ValidatePageId(next_page_id);
-  return next_page_id;
+  const page_id_t page_id = disk_manager_->AllocatePage(instance_index_);
+  ValidatePageId(page_id);
+  return page_id;
 }
 
+std::vector<page_id_t> BufferPoolManagerInstance::GetResidentPages() {
+  std::vector<page_id_t> hot_first;
+  std::vector<char> listed(pool_size_, 0);
+  // frames only change hands under latch_; pins may still come and go, so the order is a snapshot
+  std::scoped_lock lock(latch_);
+  for (size_t i = 0; i < pool_size_; i++) {
+    if (pages_[i].page_id_ != INVALID_PAGE_ID && pages_[i].pin_count_ > 0) {
+      hot_first.push_back(pages_[i].page_id_);
+      listed[i] = 1;
+    }
+  }
+  std::vector<frame_id_t> cold_first = replacer_->PeekVictims(pool_size_);
+  for (auto it = cold_first.rbegin(); it != cold_first.rend(); ++it) {
+    if (pages_[*it].page_id_ != INVALID_PAGE_ID && listed[*it] == 0) {
+      hot_first.push_back(pages_[*it].page_id_);
+      listed[*it] = 1;
+    }
+  }
+  return hot_first;
+}
 
-// all code should be wrapped, damn it!
+BufferPoolStats BufferPoolManagerInstance::GetStats() {
+  BufferPoolStats stats;
+  stats.pool_size_ = pool_size_;
+  {
+    std::scoped_lock lock(latch_);
+    stats.resident_pages_ = pool_size_ - free_list_.size();
+  }
+  stats.pinned_frames_ = pool_size_ - num_unpinned_frames_;
+  stats.fetches_ = fetches_.Get();
+  stats.hits_ = hits_.Get();
+  stats.misses_ = misses_.Get();
+  stats.fetch_failures_ = fetch_failures_.Get();
+  stats.new_pages_ = new_pages_.Get();
+  stats.new_page_failures_ = new_page_failures_.Get();
+  stats.dirty_evictions_ = dirty_evictions_.Get();
+  stats.clean_evictions_ = clean_evictions_.Get();
+  stats.latch_acquisitions_ = latch_acquisitions_.Get();
+  stats.latch_contended_ = latch_contended_.Get();
+  stats.read_latency_ = read_latency_.Snapshot();
+  stats.write_latency_ = write_latency_.Snapshot();
+  stats.latch_wait_ = latch_wait_.Snapshot();
+  return stats;
+}
 
-// Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) 
 void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
-  assert(page_id % num_instances_ == instance_index_);  // allocated pages mod back to this BPI
+  assert(InstanceForPage(page_id, num_instances_, routing_) == instance_index_);  // allocated pages route back here
 }
 }  // namespace bustub
\ No newline at end of file
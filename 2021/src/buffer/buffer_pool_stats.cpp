@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace bustub {
+
+uint64_t HistogramSnapshot::PercentileNanos(double quantile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  auto rank = static_cast<uint64_t>(std::ceil(quantile * count_));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; i++) {
+    seen += buckets_[i];
+    if (seen >= rank && buckets_[i] != 0) {
+      return (uint64_t{1} << (i + 1)) - 1;
+    }
+  }
+  return (uint64_t{1} << NUM_BUCKETS) - 1;
+}
+
+HistogramSnapshot &HistogramSnapshot::operator+=(const HistogramSnapshot &other) {
+  for (size_t i = 0; i < NUM_BUCKETS; i++) {
+    buckets_[i] += other.buckets_[i];
+  }
+  count_ += other.count_;
+  total_nanos_ += other.total_nanos_;
+  return *this;
+}
+
+void LatencyHistogram::Record(uint64_t nanos) {
+  // index of the highest set bit, so [2^i, 2^(i+1)) lands in bucket i
+  size_t bucket = nanos == 0 ? 0 : 63 - __builtin_clzll(nanos);
+  if (bucket >= HistogramSnapshot::NUM_BUCKETS) {
+    bucket = HistogramSnapshot::NUM_BUCKETS - 1;
+  }
+  Shard &shard = shards_[StatsShard()];
+  shard.buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+  shard.total_nanos_.fetch_add(nanos, std::memory_order_relaxed);
+}
+
+HistogramSnapshot LatencyHistogram::Snapshot() const {
+  HistogramSnapshot snapshot;
+  for (const auto &shard : shards_) {
+    for (size_t i = 0; i < HistogramSnapshot::NUM_BUCKETS; i++) {
+      uint64_t n = shard.buckets_[i].load(std::memory_order_relaxed);
+      snapshot.buckets_[i] += n;
+      snapshot.count_ += n;
+    }
+    snapshot.total_nanos_ += shard.total_nanos_.load(std::memory_order_relaxed);
+  }
+  return snapshot;
+}
+
+BufferPoolStats &BufferPoolStats::operator+=(const BufferPoolStats &other) {
+  pool_size_ += other.pool_size_;
+  resident_pages_ += other.resident_pages_;
+  pinned_frames_ += other.pinned_frames_;
+  fetches_ += other.fetches_;
+  hits_ += other.hits_;
+  misses_ += other.misses_;
+  fetch_failures_ += other.fetch_failures_;
+  new_pages_ += other.new_pages_;
+  new_page_failures_ += other.new_page_failures_;
+  dirty_evictions_ += other.dirty_evictions_;
+  clean_evictions_ += other.clean_evictions_;
+  latch_acquisitions_ += other.latch_acquisitions_;
+  latch_contended_ += other.latch_contended_;
+  read_latency_ += other.read_latency_;
+  write_latency_ += other.write_latency_;
+  latch_wait_ += other.latch_wait_;
+  return *this;
+}
+
+namespace {
+
+void DumpHistogram(std::ostringstream *out, const char *name, const HistogramSnapshot &histogram) {
+  *out << name << ": count=" << histogram.count_ << " mean_us=" << histogram.MeanNanos() / 1000
+       << " p50_us<=" << static_cast<double>(histogram.PercentileNanos(0.5)) / 1000
+       << " p99_us<=" << static_cast<double>(histogram.PercentileNanos(0.99)) / 1000
+       << " p999_us<=" << static_cast<double>(histogram.PercentileNanos(0.999)) / 1000 << "\n";
+}
+
+}  // namespace
+
+std::string BufferPoolStats::ToString() const {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(3);
+  out << "frames: pool_size=" << pool_size_ << " resident=" << resident_pages_ << " pinned=" << pinned_frames_
+      << "\n";
+  out << "fetches: total=" << fetches_ << " hits=" << hits_ << " misses=" << misses_ << " failed=" << fetch_failures_
+      << " hit_ratio=" << (fetches_ == 0 ? 0.0 : static_cast<double>(hits_) / fetches_) << "\n";
+  out << "new_pages: created=" << new_pages_ << " failed=" << new_page_failures_ << "\n";
+  out << "evictions: dirty=" << dirty_evictions_ << " clean=" << clean_evictions_ << "\n";
+  out << "latch: acquisitions=" << latch_acquisitions_ << " contended=" << latch_contended_ << "\n";
+  DumpHistogram(&out, "read_latency", read_latency_);
+  DumpHistogram(&out, "write_latency", write_latency_);
+  DumpHistogram(&out, "latch_wait", latch_wait_);
+  return out.str();
+}
+
+}  // namespace bustub
@@ -14,16 +14,71 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : num_pages_(num_pages), states_(std::make_unique<std::atomic<uint8_t>[]>(num_pages)) {
+  for (size_t i = 0; i < num_pages_; i++) {
+    states_[i].store(ABSENT, std::memory_order_relaxed);
+  }
+}
 
 ClockReplacer::~ClockReplacer() = default;
 
-bool ClockReplacer::Victim(frame_id_t *frame_id) { return false; }
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  // Two sweeps clear every reference bit, so a third sweep only comes up empty if other threads keep pinning
+  // frames out from under the hand; give up then instead of spinning.
+  for (size_t step = 0; step < 3 * num_pages_ && size_.load() > 0; step++) {
+    size_t i = clock_hand_.fetch_add(1) % num_pages_;
+    uint8_t state = states_[i].load();
+    if (state == REFERENCED) {
+      // second chance; losing this race just means the frame was pinned or referenced again
+      states_[i].compare_exchange_strong(state, UNREFERENCED);
+    } else if (state == UNREFERENCED && states_[i].compare_exchange_strong(state, ABSENT)) {
+      size_--;
+      *frame_id = static_cast<frame_id_t>(i);
+      return true;
+    }
+  }
+  return false;
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  if (states_[frame_id].exchange(ABSENT) != ABSENT) {
+    size_--;
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  // a frame that is already in the clock keeps its reference bit untouched
+  uint8_t expected = ABSENT;
+  if (states_[frame_id].compare_exchange_strong(expected, REFERENCED)) {
+    size_++;
+  }
+}
 
-size_t ClockReplacer::Size() { return 0; }
+std::vector<frame_id_t> ClockReplacer::PeekVictims(size_t max_frames) {
+  // Walk one revolution from the hand: unreferenced frames are the ones the next sweep evicts, referenced frames
+  // follow once their bit is cleared. The answer is a hint; it may be stale by the time the caller acts on it.
+  std::vector<frame_id_t> victims;
+  std::vector<frame_id_t> referenced;
+  size_t hand = clock_hand_.load();
+  for (size_t step = 0; step < num_pages_ && victims.size() < max_frames; step++) {
+    size_t i = (hand + step) % num_pages_;
+    uint8_t state = states_[i].load(std::memory_order_relaxed);
+    if (state == UNREFERENCED) {
+      victims.push_back(static_cast<frame_id_t>(i));
+    } else if (state == REFERENCED) {
+      referenced.push_back(static_cast<frame_id_t>(i));
+    }
+  }
+  for (size_t j = 0; j < referenced.size() && victims.size() < max_frames; j++) {
+    victims.push_back(referenced[j]);
+  }
+  return victims;
+}
+
+size_t ClockReplacer::Size() {
+  int64_t size = size_.load();
+  return size > 0 ? static_cast<size_t>(size) : 0;
+}
 
 }  // namespace bustub
@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+
+#include <cstdint>
+#include <new>
+
+#ifdef BUSTUB_HAVE_LIBNUMA
+#include <numa.h>
+#endif
+
+#include "common/exception.h"
+
+namespace bustub {
+
+namespace {
+
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+size_t RoundUp(size_t n, size_t multiple) { return (n + multiple - 1) / multiple * multiple; }
+
+}  // namespace
+
+FrameArena::FrameArena(size_t num_frames, const FrameArenaOptions &options) : num_frames_(num_frames) {
+  size_t data_bytes = num_frames * PAGE_SIZE;
+  void *mapping = MAP_FAILED;
+
+  if (options.huge_pages_) {
+    // explicit huge pages only exist if the administrator reserved them (vm.nr_hugepages)
+    mapping_bytes_ = RoundUp(data_bytes, HUGE_PAGE_SIZE);
+    mapping = mmap(nullptr, mapping_bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (mapping != MAP_FAILED) {
+      backing_ = FrameBacking::HUGETLB;
+      data_ = static_cast<char *>(mapping);
+    } else {
+      // over-allocate so the data can start on a huge page boundary, where khugepaged can collapse it
+      mapping_bytes_ = RoundUp(data_bytes, HUGE_PAGE_SIZE) + HUGE_PAGE_SIZE;
+      mapping = mmap(nullptr, mapping_bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (mapping != MAP_FAILED) {
+        auto aligned = RoundUp(reinterpret_cast<uintptr_t>(mapping), HUGE_PAGE_SIZE);
+        data_ = reinterpret_cast<char *>(aligned);
+        if (madvise(data_, RoundUp(data_bytes, HUGE_PAGE_SIZE), MADV_HUGEPAGE) == 0) {
+          backing_ = FrameBacking::TRANSPARENT_HUGE_PAGES;
+        }
+      }
+    }
+  } else {
+    mapping_bytes_ = data_bytes;
+    mapping = mmap(nullptr, mapping_bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    data_ = static_cast<char *>(mapping);
+  }
+  if (mapping == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot map the buffer pool frames");
+  }
+  mapping_ = static_cast<char *>(mapping);
+
+#ifdef BUSTUB_HAVE_LIBNUMA
+  // bind before anything touches the data, so no page gets faulted in on the wrong node first
+  if (options.numa_node_ >= 0 && numa_available() >= 0 && options.numa_node_ <= numa_max_node()) {
+    numa_tonode_memory(mapping_, mapping_bytes_, options.numa_node_);
+    numa_node_ = options.numa_node_;
+  }
+#endif
+
+  // Anonymous mappings are zero-filled on first touch, so the frames need no ResetMemory here; the data stays
+  // uncommitted until the buffer pool first uses each frame.
+  pages_ = static_cast<Page *>(::operator new[](num_frames_ * sizeof(Page), std::align_val_t(alignof(Page))));
+  for (size_t i = 0; i < num_frames_; i++) {
+    new (&pages_[i]) Page(data_ + i * PAGE_SIZE);
+  }
+}
+
+FrameArena::~FrameArena() {
+  for (size_t i = 0; i < num_frames_; i++) {
+    pages_[i].~Page();
+  }
+  ::operator delete[](pages_, std::align_val_t(alignof(Page)));
+  munmap(mapping_, mapping_bytes_);
+}
+
+int FrameArena::NumNumaNodes() {
+#ifdef BUSTUB_HAVE_LIBNUMA
+  if (numa_available() >= 0) {
+    return numa_num_configured_nodes();
+  }
+#endif
+  return 1;
+}
+
+}  // namespace bustub
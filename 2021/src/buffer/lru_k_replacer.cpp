@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, uint64_t correlated_period)
+    : k_(k), correlated_period_(correlated_period), frames_(num_pages) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs at least one reference per frame");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+void LRUKReplacer::RecordAccess(FrameInfo *info) {
+  uint64_t now = ++current_tick_;
+  if (!info->history_.empty() && now - info->history_.back() <= correlated_period_) {
+    // same burst, e.g. the next tuple on a page being scanned: only move the burst's end forward
+    info->history_.back() = now;
+    return;
+  }
+  if (info->history_.size() == k_) {
+    info->history_.erase(info->history_.begin());
+  }
+  info->history_.push_back(now);
+}
+
+std::pair<std::set<std::pair<uint64_t, frame_id_t>> *, uint64_t> LRUKReplacer::QueueOf(const FrameInfo &info) {
+  if (info.history_.size() < k_) {
+    return {&history_queue_, info.history_.back()};
+  }
+  return {&cache_queue_, info.history_.front()};
+}
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lock(latch_);
+  auto *queue = history_queue_.empty() ? &cache_queue_ : &history_queue_;
+  if (queue->empty()) {
+    return false;
+  }
+  *frame_id = queue->begin()->second;
+  queue->erase(queue->begin());
+  // the frame is about to hold a different page, which starts without a past
+  frames_[*frame_id].history_.clear();
+  frames_[*frame_id].evictable_ = false;
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  PinFrame(frame_id);
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  UnpinFrame(frame_id);
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  FrameInfo &info = frames_[frame_id];
+  if (info.evictable_) {
+    auto [queue, key] = QueueOf(info);
+    queue->erase({key, frame_id});
+    info.evictable_ = false;
+  }
+  info.history_.clear();
+}
+
+void LRUKReplacer::PinAll(const std::vector<frame_id_t> &frame_ids) {
+  std::scoped_lock lock(latch_);
+  for (frame_id_t frame_id : frame_ids) {
+    PinFrame(frame_id);
+  }
+}
+
+void LRUKReplacer::PinFrame(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  if (info.evictable_) {
+    auto [queue, key] = QueueOf(info);
+    queue->erase({key, frame_id});
+    info.evictable_ = false;
+  }
+  RecordAccess(&info);
+}
+
+void LRUKReplacer::UnpinFrame(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  if (info.evictable_) {
+    return;
+  }
+  if (info.history_.empty()) {
+    // loaded by a miss, which does not go through Pin
+    RecordAccess(&info);
+  }
+  auto [queue, key] = QueueOf(info);
+  queue->emplace(key, frame_id);
+  info.evictable_ = true;
+}
+
+std::vector<frame_id_t> LRUKReplacer::PeekVictims(size_t max_frames) {
+  std::scoped_lock lock(latch_);
+  std::vector<frame_id_t> victims;
+  for (const auto *queue : {&history_queue_, &cache_queue_}) {
+    for (auto it = queue->begin(); it != queue->end() && victims.size() < max_frames; ++it) {
+      victims.push_back(it->second);
+    }
+  }
+  return victims;
+}
+
+size_t LRUKReplacer::Size() {
+  std::scoped_lock lock(latch_);
+  return history_queue_.size() + cache_queue_.size();
+}
+
+}  // namespace bustub
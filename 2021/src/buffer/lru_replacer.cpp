@@ -39,27 +39,37 @@ bool LRUReplacer::Victim(frame_id_t *frame_id) {
 
 void LRUReplacer::Pin(frame_id_t frame_id) {
   // show that the frame is pinned by a process
-  latch_.lock();
+  std::scoped_lock lock(latch_);
+  PinFrame(frame_id);
+}
+
+void LRUReplacer::Unpin(frame_id_t frame_id) {
+  // a page is unpinned by process
+  std::scoped_lock lock(latch_);
+  UnpinFrame(frame_id);
+}
 
+void LRUReplacer::PinAll(const std::vector<frame_id_t> &frame_ids) {
+  std::scoped_lock lock(latch_);
+  for (frame_id_t frame_id : frame_ids) {
+    PinFrame(frame_id);
+  }
+}
+
+void LRUReplacer::PinFrame(frame_id_t frame_id) {
   // update the newest thing here
   // which is always LRU algorithm
-  if (lru_map_.count(frame_id) != 0) {
-    lru_list_.erase(lru_map_[frame_id]);
-    lru_map_.erase(frame_id);
+  auto it = lru_map_.find(frame_id);
+  if (it != lru_map_.end()) {
+    lru_list_.erase(it->second);
+    lru_map_.erase(it);
   }
-
-  latch_.unlock();
-  return;
 }
 
-// debug loser! damn it!
-void LRUReplacer::Unpin(frame_id_t frame_id) {
-  // a page is unpinned by process
-  latch_.lock();
+void LRUReplacer::UnpinFrame(frame_id_t frame_id) {
   // whether it is in the replacer?
   // page in free list is always free
   if (lru_map_.count(frame_id) != 0) {
-    latch_.unlock();
     return;
   }
 
@@ -70,19 +80,26 @@ void LRUReplacer::Unpin(frame_id_t frame_id) {
     lru_list.pop_back();
     lru_map.erase(del_frame_id);
     */
-    
+
     frame_id_t del_frame_id = lru_list_.front();
     lru_list_.pop_front();
     lru_map_.erase(del_frame_id);
-    
   }
 
   // del the min thing? yes
   lru_list_.push_front(frame_id);
   // iterator
   lru_map_[frame_id] = lru_list_.begin();
-  latch_.unlock();
-  return;
+}
+
+std::vector<frame_id_t> LRUReplacer::PeekVictims(size_t max_frames) {
+  std::scoped_lock lock(latch_);
+  std::vector<frame_id_t> victims;
+  // the least recently used frame sits at the back
+  for (auto it = lru_list_.rbegin(); it != lru_list_.rend() && victims.size() < max_frames; ++it) {
+    victims.push_back(*it);
+  }
+  return victims;
 }
 
 size_t LRUReplacer::Size() { return lru_list_.size(); }
@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace bustub {
+
+namespace {
+
+constexpr size_t MAX_STRIPES = 64;
+constexpr size_t MIN_SLOTS_PER_STRIPE = 8;
+
+size_t NextPowerOfTwo(size_t n) {
+  size_t p = 1;
+  while (p < n) {
+    p <<= 1;
+  }
+  return p;
+}
+
+}  // namespace
+
+PageTable::PageTable(size_t num_frames) {
+  // roughly one stripe per 16 frames, so small pools do not pay for 64 mostly empty stripes
+  num_stripes_ = std::min(MAX_STRIPES, NextPowerOfTwo((num_frames + 15) / 16));
+  stripes_ = std::make_unique<Stripe[]>(num_stripes_);
+
+  // keep the load factor at or below 1/2 when the pool is full and the hash spreads evenly
+  size_t slots_per_stripe = std::max(MIN_SLOTS_PER_STRIPE, NextPowerOfTwo(2 * num_frames / num_stripes_ + 1));
+  for (size_t i = 0; i < num_stripes_; i++) {
+    stripes_[i].slots_.resize(slots_per_stripe);
+    stripes_[i].mask_ = slots_per_stripe - 1;
+  }
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "an empty slot cannot be inserted");
+  size_t hash = Hash(page_id);
+  Stripe &stripe = StripeFor(page_id);
+  std::scoped_lock lock(stripe.latch_);
+
+  size_t slot;
+  if (stripe.Lookup(page_id, hash, &slot)) {
+    stripe.slots_[slot].frame_id_ = frame_id;
+    return;
+  }
+  if ((stripe.size_ + 1) * 4 > stripe.slots_.size() * 3) {
+    stripe.Grow();
+  }
+  slot = hash & stripe.mask_;
+  while (stripe.slots_[slot].page_id_ != INVALID_PAGE_ID) {
+    slot = (slot + 1) & stripe.mask_;
+  }
+  stripe.slots_[slot] = {page_id, frame_id};
+  stripe.size_++;
+}
+
+bool PageTable::Stripe::Lookup(page_id_t page_id, size_t hash, size_t *slot) const {
+  // empty slots hold INVALID_PAGE_ID, so test for one first: INVALID_PAGE_ID itself is never in the table
+  for (size_t i = hash & mask_;; i = (i + 1) & mask_) {
+    if (slots_[i].page_id_ == INVALID_PAGE_ID) {
+      return false;
+    }
+    if (slots_[i].page_id_ == page_id) {
+      *slot = i;
+      return true;
+    }
+  }
+}
+
+void PageTable::Stripe::Erase(size_t slot) {
+  // backward-shift deletion: pull later members of the probe run into the hole so lookups never need tombstones
+  size_t hole = slot;
+  for (size_t i = (hole + 1) & mask_; slots_[i].page_id_ != INVALID_PAGE_ID; i = (i + 1) & mask_) {
+    size_t home = Hash(slots_[i].page_id_) & mask_;
+    // move the entry iff its home does not lie cyclically in (hole, i]
+    bool home_between = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+    if (!home_between) {
+      slots_[hole] = slots_[i];
+      hole = i;
+    }
+  }
+  slots_[hole] = Slot{};
+  size_--;
+}
+
+void PageTable::Stripe::Grow() {
+  std::vector<Slot> old = std::move(slots_);
+  slots_.assign(old.size() * 2, Slot{});
+  mask_ = slots_.size() - 1;
+  for (const Slot &entry : old) {
+    if (entry.page_id_ == INVALID_PAGE_ID) {
+      continue;
+    }
+    size_t i = Hash(entry.page_id_) & mask_;
+    while (slots_[i].page_id_ != INVALID_PAGE_ID) {
+      i = (i + 1) & mask_;
+    }
+    slots_[i] = entry;
+  }
+}
+
+}  // namespace bustub
@@ -12,12 +12,14 @@
 
 #include "buffer/parallel_buffer_pool_manager.h"
 
-namespace bustub {
+#include <algorithm>
 
-// so many exercises!  damn it!
+namespace bustub {
 
 ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager) {
+                                                     LogManager *log_manager, ReplacerPolicy replacer_policy,
+                                                     PageRouting routing, const FrameArenaOptions &arena_options)
+    : routing_(routing), prefetcher_(this, num_instances * pool_size) {
   // Allocate and create individual BufferPoolManagerInstances
 
   /*
@@ -29,12 +31,16 @@ ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_
   num_instances_ = num_instances;
   parallel_pool_size_ = num_instances * pool_size;
   each_pool_size_ = pool_size;
-  search_num_ = 0;
 
   // init of all protected things
+  int num_numa_nodes = FrameArena::NumNumaNodes();
   for (size_t i = 0; i < num_instances; i++) {
-    BufferPoolManagerInstance *tmp =
-        new BufferPoolManagerInstance(pool_size, num_instances, i, disk_manager, log_manager);
+    FrameArenaOptions instance_arena_options = arena_options;
+    if (arena_options.numa_node_ == FrameArenaOptions::SPREAD_NUMA_NODES) {
+      instance_arena_options.numa_node_ = static_cast<int>(i % num_numa_nodes);
+    }
+    auto *tmp = new BufferPoolManagerInstance(pool_size, num_instances, i, disk_manager, log_manager, replacer_policy,
+                                              routing, instance_arena_options);
     bufpoolIns_vector_.push_back(tmp);
 
     // not a same namespace
@@ -46,6 +52,7 @@ ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_
 
 // Update constructor to destruct all BufferPoolManagerInstances and deallocate any associated memory
 ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  prefetcher_.Stop();
   // empty all spaces
   for (size_t i = 0; i < num_instances_; i++) {
     delete (latch_vector_[i]);
@@ -60,15 +67,17 @@ size_t ParallelBufferPoolManager::GetPoolSize() {
 
 BufferPoolManager *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
   // Get BufferPoolManager responsible for handling given page id. You can use this method in your other methods.
-  size_t target_loc = page_id % num_instances_;
+  size_t target_loc = InstanceForPage(page_id, num_instances_, routing_);
 
   return bufpoolIns_vector_[target_loc];
 }
 
-Page *ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) {
+Page *ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) { return FetchPgImp(page_id, nullptr); }
+
+Page *ParallelBufferPoolManager::FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) {
   // Fetch page for page_id from responsible BufferPoolManagerInstance
   BufferPoolManager *select_bufferpool_ins = GetBufferPoolManager(page_id);
-  Page *res = select_bufferpool_ins->wrap_FetchPgImp(page_id);
+  Page *res = select_bufferpool_ins->wrap_FetchPgImp(page_id, strategy);
 
   return res;
 }
@@ -79,6 +88,62 @@ bool ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) {
   return res;
 }
 
+void ParallelBufferPoolManager::GroupByInstance(const page_id_t *page_ids, size_t num_pages,
+                                                std::vector<page_id_t> *grouped_ids, std::vector<size_t> *positions,
+                                                std::vector<size_t> *offsets) {
+  offsets->assign(num_instances_ + 1, 0);
+  for (size_t i = 0; i < num_pages; i++) {
+    (*offsets)[InstanceForPage(page_ids[i], num_instances_, routing_) + 1]++;
+  }
+  for (size_t instance = 0; instance < num_instances_; instance++) {
+    (*offsets)[instance + 1] += (*offsets)[instance];
+  }
+  grouped_ids->resize(num_pages);
+  positions->resize(num_pages);
+  std::vector<size_t> next(offsets->begin(), offsets->end() - 1);
+  for (size_t i = 0; i < num_pages; i++) {
+    size_t j = next[InstanceForPage(page_ids[i], num_instances_, routing_)]++;
+    (*grouped_ids)[j] = page_ids[i];
+    (*positions)[j] = i;
+  }
+}
+
+size_t ParallelBufferPoolManager::FetchPgsImp(const page_id_t *page_ids, size_t num_pages, Page **pages) {
+  std::vector<page_id_t> grouped_ids;
+  std::vector<size_t> positions;
+  std::vector<size_t> offsets;
+  GroupByInstance(page_ids, num_pages, &grouped_ids, &positions, &offsets);
+  std::vector<Page *> grouped_pages(num_pages);
+  size_t fetched = 0;
+  for (size_t instance = 0; instance < num_instances_; instance++) {
+    size_t begin = offsets[instance];
+    size_t count = offsets[instance + 1] - begin;
+    if (count != 0) {
+      fetched += bufpoolIns_vector_[instance]->wrap_FetchPgsImp(&grouped_ids[begin], count, &grouped_pages[begin]);
+    }
+  }
+  for (size_t j = 0; j < num_pages; j++) {
+    pages[positions[j]] = grouped_pages[j];
+  }
+  return fetched;
+}
+
+bool ParallelBufferPoolManager::UnpinPgsImp(const page_id_t *page_ids, size_t num_pages, bool is_dirty) {
+  std::vector<page_id_t> grouped_ids;
+  std::vector<size_t> positions;
+  std::vector<size_t> offsets;
+  GroupByInstance(page_ids, num_pages, &grouped_ids, &positions, &offsets);
+  bool unpinned = true;
+  for (size_t instance = 0; instance < num_instances_; instance++) {
+    size_t begin = offsets[instance];
+    size_t count = offsets[instance + 1] - begin;
+    if (count != 0) {
+      unpinned = bufpoolIns_vector_[instance]->wrap_UnpinPgsImp(&grouped_ids[begin], count, is_dirty) && unpinned;
+    }
+  }
+  return unpinned;
+}
+
 bool ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) {
   // Flush page_id from responsible BufferPoolManagerInstance
   BufferPoolManager *select_bufferpool_ins = GetBufferPoolManager(page_id);
@@ -86,7 +151,9 @@ bool ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) {
   return res;
 }
 
-Page *ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) {
+Page *ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) { return NewPgImp(page_id, nullptr); }
+
+Page *ParallelBufferPoolManager::NewPgImp(page_id_t *page_id, BufferAccessStrategy *strategy) {
   // create new page. We will request page allocation in a round robin manner from the underlying
   // BufferPoolManagerInstances
   // 1.   From a starting index of the BPMIs, call NewPageImpl until either 1) success and return 2) looped around to
@@ -94,30 +161,26 @@ Page *ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) {
   // 2.   Bump the starting index (mod number of instances) to start search at a different BPMI each time this function
   // is called
 
-  // this should be derectly right.
-
-  // NULL
-  latch_for_robin_.lock();
-  size_t search_times = 0;
-  Page *res = nullptr;
-
-  for (search_times = 0; search_times < num_instances_; search_times++) {
-    BufferPoolManager *select_bufferpool_ins = bufpoolIns_vector_[search_num_];
-    res = select_bufferpool_ins->wrap_NewPgImp(page_id);
-
-    search_times++;
-    search_num_ = (search_num_ + 1) % num_instances_;  // next number
-
-    if (res != nullptr || res != NULL) {
-      // find it!
-      latch_for_robin_.unlock();
+  // Claim a starting index without a lock; concurrent callers start at different instances.
+  size_t start = next_instance_.fetch_add(1, std::memory_order_relaxed);
+  for (size_t i = 0; i < num_instances_; i++) {
+    BufferPoolManager *select_bufferpool_ins = bufpoolIns_vector_[(start + i) % num_instances_];
+    Page *res = select_bufferpool_ins->wrap_NewPgImp(page_id, strategy);
+    if (res != nullptr) {
       return res;
     }
   }
-  // can't find where it is the bug?
-  // damn it!
-  latch_for_robin_.unlock();
-  return res;
+  // every instance is full of pinned pages
+  return nullptr;
+}
+
+page_id_t ParallelBufferPoolManager::AllocateExtentImp(size_t num_pages) {
+  // all instances allocate from the same disk manager
+  return bufpoolIns_vector_[0]->wrap_AllocateExtentImp(num_pages);
+}
+
+Page *ParallelBufferPoolManager::NewPgAtImp(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return GetBufferPoolManager(page_id)->wrap_NewPgAtImp(page_id, strategy);
 }
 
 bool ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) {
@@ -138,4 +201,67 @@ void ParallelBufferPoolManager::FlushAllPgsImp() {
     bufpoolIns_vector_[i]->wrap_FlushAllPgsImpl();
   }
 }
+
+void ParallelBufferPoolManager::RunPageCleaners(const PageCleanerConfig &config) {
+  for (auto *instance : bufpoolIns_vector_) {
+    instance->RunPageCleaner(config);
+  }
+}
+
+void ParallelBufferPoolManager::StopPageCleaners() {
+  for (auto *instance : bufpoolIns_vector_) {
+    instance->StopPageCleaner();
+  }
+}
+
+uint64_t ParallelBufferPoolManager::GetForegroundWriteCount() const {
+  uint64_t writes = 0;
+  for (auto *instance : bufpoolIns_vector_) {
+    writes += instance->GetForegroundWriteCount();
+  }
+  return writes;
+}
+
+std::vector<page_id_t> ParallelBufferPoolManager::GetResidentPages() {
+  std::vector<std::vector<page_id_t>> per_instance;
+  size_t longest = 0;
+  for (auto *instance : bufpoolIns_vector_) {
+    per_instance.push_back(instance->GetResidentPages());
+    longest = std::max(longest, per_instance.back().size());
+  }
+  std::vector<page_id_t> hot_first;
+  for (size_t rank = 0; rank < longest; rank++) {
+    for (const auto &pages : per_instance) {
+      if (rank < pages.size()) {
+        hot_first.push_back(pages[rank]);
+      }
+    }
+  }
+  return hot_first;
+}
+
+std::vector<BufferPoolStats> ParallelBufferPoolManager::GetInstanceStats() {
+  std::vector<BufferPoolStats> stats;
+  stats.reserve(num_instances_);
+  for (auto *instance : bufpoolIns_vector_) {
+    stats.push_back(instance->GetStats());
+  }
+  return stats;
+}
+
+BufferPoolStats ParallelBufferPoolManager::GetStats() {
+  BufferPoolStats total;
+  for (auto *instance : bufpoolIns_vector_) {
+    total += instance->GetStats();
+  }
+  return total;
+}
+
+uint64_t ParallelBufferPoolManager::GetBackgroundWriteCount() const {
+  uint64_t writes = 0;
+  for (auto *instance : bufpoolIns_vector_) {
+    writes += instance->GetBackgroundWriteCount();
+  }
+  return writes;
+}
 }  // namespace bustub
@@ -0,0 +1,107 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// prefetcher.cpp
+//
+// Identification: src/buffer/prefetcher.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/prefetcher.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+Prefetcher::Prefetcher(BufferPoolManager *bpm, size_t pool_size, size_t max_queued)
+    : bpm_(bpm), pool_size_(pool_size), max_depth_(std::min(MAX_CHAIN_DEPTH, pool_size / 4)), max_queued_(max_queued) {
+  // a single page ahead would be recycled by the next one before the scan has caught up
+  if (max_depth_ < 2) {
+    max_depth_ = 0;
+  }
+}
+
+Prefetcher::~Prefetcher() { Stop(); }
+
+void Prefetcher::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  for (page_id_t page_id : page_ids) {
+    Enqueue({page_id, 1, nullptr});
+  }
+}
+
+void Prefetcher::PrefetchChain(page_id_t page_id, size_t depth, BufferPoolManager::next_page_fn next_page) {
+  Enqueue({page_id, depth, next_page});
+}
+
+void Prefetcher::Enqueue(Request request) {
+  request.depth_ = std::min(request.depth_, max_depth_);
+  if (request.page_id_ == INVALID_PAGE_ID || request.depth_ == 0) {
+    return;
+  }
+  {
+    std::scoped_lock lock(latch_);
+    if (stopped_ || queue_.size() >= max_queued_) {
+      return;
+    }
+    queue_.push_back(request);
+    if (thread_ == nullptr) {
+      thread_ = new std::thread(&Prefetcher::WorkerLoop, this);
+    }
+  }
+  cv_.notify_one();
+}
+
+void Prefetcher::Stop() {
+  std::thread *thread;
+  {
+    std::scoped_lock lock(latch_);
+    stopped_ = true;
+    queue_.clear();
+    thread = thread_;
+    thread_ = nullptr;
+  }
+  cv_.notify_all();
+  if (thread != nullptr) {
+    thread->join();
+    delete thread;
+  }
+}
+
+void Prefetcher::WorkerLoop() {
+  strategy_ = std::make_unique<BufferAccessStrategy>(BufferAccessType::BULK_READ, pool_size_, max_depth_);
+  std::unique_lock lock(latch_);
+  while (true) {
+    cv_.wait(lock, [this] { return stopped_ || !queue_.empty(); });
+    if (stopped_) {
+      return;
+    }
+    Request request = queue_.front();
+    queue_.pop_front();
+    lock.unlock();
+
+    // walk the chain; pages that are already resident cost a pin and, for chains, a look at the next pointer
+    for (size_t i = 0; i < request.depth_ && request.page_id_ != INVALID_PAGE_ID; i++) {
+      Page *page = bpm_->FetchPage(request.page_id_, *strategy_);
+      if (page == nullptr) {
+        // every frame is pinned, the scan will have to wait for its own reads
+        break;
+      }
+      prefetched_++;
+      page_id_t page_id = request.page_id_;
+      request.page_id_ = INVALID_PAGE_ID;
+      if (request.next_page_ != nullptr && i + 1 < request.depth_) {
+        page->RLatch();
+        request.page_id_ = request.next_page_(page);
+        page->RUnlatch();
+      }
+      bpm_->UnpinPage(page_id, false);
+    }
+
+    lock.lock();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_only_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/read_only_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/read_only_buffer_pool_manager.h"
+
+namespace bustub {
+
+ReadOnlyBufferPoolManager::ReadOnlyBufferPoolManager(DiskManager *disk_manager)
+    : disk_manager_(disk_manager),
+      num_pages_(disk_manager->GetNumMappedPages()),
+      views_(std::make_unique<std::atomic<Page *>[]>(num_pages_)) {
+  BUSTUB_ASSERT(disk_manager->IsReadOnly(), "a read-only buffer pool needs a read-only disk manager");
+}
+
+ReadOnlyBufferPoolManager::~ReadOnlyBufferPoolManager() {
+  for (page_id_t page_id = 0; page_id < num_pages_; page_id++) {
+    delete views_[page_id].load(std::memory_order_relaxed);
+  }
+}
+
+Page *ReadOnlyBufferPoolManager::FetchPgImp(page_id_t page_id) {
+  if (page_id < 0 || page_id >= num_pages_) {
+    return nullptr;
+  }
+  std::atomic<Page *> &slot = views_[page_id];
+  Page *page = slot.load(std::memory_order_acquire);
+  if (page == nullptr) {
+    // the mapping is PROT_READ, so a stray write through the view faults instead of changing the file
+    auto *view = new Page(const_cast<char *>(disk_manager_->GetMappedPage(page_id)));
+    view->page_id_ = page_id;
+    if (slot.compare_exchange_strong(page, view, std::memory_order_acq_rel)) {
+      page = view;
+    } else {
+      // another fetch installed a view first; page now holds it
+      delete view;
+    }
+  }
+  page->pin_count_.fetch_add(1, std::memory_order_relaxed);
+  return page;
+}
+
+bool ReadOnlyBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) {
+  BUSTUB_ASSERT(!is_dirty, "pages of a read-only buffer pool cannot be modified");
+  Page *page = page_id >= 0 && page_id < num_pages_ ? views_[page_id].load(std::memory_order_acquire) : nullptr;
+  if (page == nullptr) {
+    return false;
+  }
+  int pin_count = page->pin_count_.load(std::memory_order_relaxed);
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1, std::memory_order_relaxed));
+  return true;
+}
+
+bool ReadOnlyBufferPoolManager::FlushPgImp(page_id_t page_id) { return page_id >= 0 && page_id < num_pages_; }
+
+Page *ReadOnlyBufferPoolManager::NewPgImp(page_id_t *page_id) { return nullptr; }
+
+bool ReadOnlyBufferPoolManager::DeletePgImp(page_id_t page_id) { return false; }
+
+void ReadOnlyBufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  size_t begin = 0;
+  for (size_t i = 1; i <= page_ids.size(); i++) {
+    if (i == page_ids.size() || page_ids[i] != page_ids[i - 1] + 1) {
+      disk_manager_->AdviseWillNeed(page_ids[begin], i - begin);
+      begin = i;
+    }
+  }
+}
+
+}  // namespace bustub
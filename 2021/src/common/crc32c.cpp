@@ -0,0 +1,208 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.cpp
+//
+// Identification: src/common/crc32c.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/crc32c.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** The reflected CRC32C polynomial. */
+constexpr uint32_t POLYNOMIAL = 0x82F63B78;
+
+/**
+ * The hardware path runs three independent streams of STRIPE bytes each, which keeps the CPU's CRC unit busy instead
+ * of waiting out the latency of every instruction, and then stitches the three CRCs together.
+ */
+constexpr size_t STRIPE = 256;
+
+/**
+ * All functions below work on the raw CRC register: no initial or final inversion. That makes the register a linear
+ * function of its previous value and the data, so zeros_[k][b] can hold the effect of STRIPE zero bytes on byte k of
+ * the register having the value b.
+ */
+struct Crc32cTables {
+  uint32_t slices_[8][256];
+  uint32_t zeros_[4][256];
+
+  Crc32cTables() {
+    for (uint32_t b = 0; b < 256; b++) {
+      uint32_t crc = b;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 1) != 0 ? (crc >> 1) ^ POLYNOMIAL : crc >> 1;
+      }
+      slices_[0][b] = crc;
+    }
+    for (uint32_t b = 0; b < 256; b++) {
+      for (int k = 1; k < 8; k++) {
+        slices_[k][b] = (slices_[k - 1][b] >> 8) ^ slices_[0][slices_[k - 1][b] & 0xff];
+      }
+    }
+    // push every register bit through STRIPE zero bytes once, then combine the bits of each byte value
+    uint32_t basis[32];
+    for (int bit = 0; bit < 32; bit++) {
+      uint32_t crc = 1U << bit;
+      for (size_t i = 0; i < STRIPE; i++) {
+        crc = slices_[0][crc & 0xff] ^ (crc >> 8);
+      }
+      basis[bit] = crc;
+    }
+    for (int k = 0; k < 4; k++) {
+      for (uint32_t b = 0; b < 256; b++) {
+        uint32_t crc = 0;
+        for (int bit = 0; bit < 8; bit++) {
+          if ((b & (1U << bit)) != 0) {
+            crc ^= basis[8 * k + bit];
+          }
+        }
+        zeros_[k][b] = crc;
+      }
+    }
+  }
+};
+
+const Crc32cTables &Tables() {
+  static const Crc32cTables tables;
+  return tables;
+}
+
+uint32_t SoftwareUpdate(uint32_t crc, const uint8_t *p, size_t size) {
+  const Crc32cTables &t = Tables();
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  while (size > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0) {
+    crc = t.slices_[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    size--;
+  }
+  while (size >= 8) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    word ^= crc;
+    crc = t.slices_[7][word & 0xff] ^ t.slices_[6][(word >> 8) & 0xff] ^ t.slices_[5][(word >> 16) & 0xff] ^
+          t.slices_[4][(word >> 24) & 0xff] ^ t.slices_[3][(word >> 32) & 0xff] ^ t.slices_[2][(word >> 40) & 0xff] ^
+          t.slices_[1][(word >> 48) & 0xff] ^ t.slices_[0][word >> 56];
+    p += 8;
+    size -= 8;
+  }
+#endif
+  while (size > 0) {
+    crc = t.slices_[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    size--;
+  }
+  return crc;
+}
+
+/** @return the register after STRIPE more zero bytes */
+inline uint32_t ShiftStripe(const Crc32cTables &t, uint32_t crc) {
+  return t.zeros_[0][crc & 0xff] ^ t.zeros_[1][(crc >> 8) & 0xff] ^ t.zeros_[2][(crc >> 16) & 0xff] ^
+         t.zeros_[3][crc >> 24];
+}
+
+#if defined(__x86_64__)
+
+__attribute__((target("sse4.2"))) uint32_t HardwareUpdate(uint32_t crc, const uint8_t *p, size_t size) {
+  const Crc32cTables &t = Tables();
+  while (size > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0) {
+    crc = _mm_crc32_u8(crc, *p++);
+    size--;
+  }
+  uint64_t word;
+  while (size >= 3 * STRIPE) {
+    uint64_t crc0 = crc;
+    uint64_t crc1 = 0;
+    uint64_t crc2 = 0;
+    for (size_t i = 0; i < STRIPE; i += 8) {
+      memcpy(&word, p + i, sizeof(word));
+      crc0 = _mm_crc32_u64(crc0, word);
+      memcpy(&word, p + STRIPE + i, sizeof(word));
+      crc1 = _mm_crc32_u64(crc1, word);
+      memcpy(&word, p + 2 * STRIPE + i, sizeof(word));
+      crc2 = _mm_crc32_u64(crc2, word);
+    }
+    // crc(a b) = shift(crc(a), |b|) ^ crc(b) when b's CRC starts from 0
+    crc = ShiftStripe(t, ShiftStripe(t, static_cast<uint32_t>(crc0)) ^ static_cast<uint32_t>(crc1)) ^
+          static_cast<uint32_t>(crc2);
+    p += 3 * STRIPE;
+    size -= 3 * STRIPE;
+  }
+  uint64_t crc64 = crc;
+  while (size >= 8) {
+    memcpy(&word, p, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+    p += 8;
+    size -= 8;
+  }
+  crc = static_cast<uint32_t>(crc64);
+  while (size > 0) {
+    crc = _mm_crc32_u8(crc, *p++);
+    size--;
+  }
+  return crc;
+}
+
+bool HasHardwareCrc() {
+  static const bool has_sse42 = __builtin_cpu_supports("sse4.2");
+  return has_sse42;
+}
+
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+
+uint32_t HardwareUpdate(uint32_t crc, const uint8_t *p, size_t size) {
+  while (size > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0) {
+    crc = __crc32cb(crc, *p++);
+    size--;
+  }
+  uint64_t word;
+  while (size >= 8) {
+    memcpy(&word, p, sizeof(word));
+    crc = __crc32cd(crc, word);
+    p += 8;
+    size -= 8;
+  }
+  while (size > 0) {
+    crc = __crc32cb(crc, *p++);
+    size--;
+  }
+  return crc;
+}
+
+bool HasHardwareCrc() { return true; }
+
+#else
+
+uint32_t HardwareUpdate(uint32_t crc, const uint8_t *p, size_t size) { return SoftwareUpdate(crc, p, size); }
+
+bool HasHardwareCrc() { return false; }
+
+#endif
+
+}  // namespace
+
+uint32_t Crc32c(const char *data, size_t size, uint32_t crc) {
+  const auto *p = reinterpret_cast<const uint8_t *>(data);
+  return ~(HasHardwareCrc() ? HardwareUpdate(~crc, p, size) : SoftwareUpdate(~crc, p, size));
+}
+
+uint32_t Crc32cSoftware(const char *data, size_t size, uint32_t crc) {
+  return ~SoftwareUpdate(~crc, reinterpret_cast<const uint8_t *>(data), size);
+}
+
+bool Crc32cIsHardwareAccelerated() { return HasHardwareCrc(); }
+
+}  // namespace bustub
@@ -0,0 +1,224 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz4.cpp
+//
+// Identification: src/common/lz4.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/lz4.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+/*
+ * A block is a series of sequences: a token whose high nibble is the number of literals and low nibble the match
+ * length minus MIN_MATCH (15 meaning more length bytes follow, each adding up to 255), the literals, a two-byte
+ * little endian offset back into the output, and the match length bytes. The last sequence has literals only.
+ */
+constexpr size_t MIN_MATCH = 4;
+/** The format requires the last LAST_LITERALS bytes to be literals, and the last match to start MFLIMIT before. */
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MFLIMIT = 12;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 12;
+/** Every 2^SKIP_TRIGGER bytes without a match, the search takes one more byte per step. */
+constexpr int SKIP_TRIGGER = 6;
+/**
+ * Most literal runs and matches are short. Away from the ends of the buffers they are copied in fixed-size chunks
+ * that may run past the end of the copy, which is overwritten by what follows.
+ */
+constexpr size_t WILD_COPY = 16;
+
+uint32_t Read32(const uint8_t *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint32_t Hash(uint32_t sequence) { return (sequence * 2654435761U) >> (32 - HASH_BITS); }
+
+/** Append a length that did not fit into its nibble. @return false if out of room */
+bool WriteLength(uint8_t **op, const uint8_t *oend, size_t length) {
+  for (; length >= 255; length -= 255) {
+    if (*op == oend) {
+      return false;
+    }
+    *(*op)++ = 255;
+  }
+  if (*op == oend) {
+    return false;
+  }
+  *(*op)++ = static_cast<uint8_t>(length);
+  return true;
+}
+
+/** Read the length bytes after a nibble of 15. @return false if the input ends first */
+bool ReadLength(const uint8_t **ip, const uint8_t *iend, size_t *length) {
+  uint8_t byte;
+  do {
+    if (*ip == iend) {
+      return false;
+    }
+    byte = *(*ip)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+/** Append a sequence. @return false if out of room */
+bool WriteSequence(uint8_t **op, const uint8_t *oend, const uint8_t *literals, size_t num_literals, size_t offset,
+                   size_t match_length) {
+  if (*op == oend) {
+    return false;
+  }
+  uint8_t *token = (*op)++;
+  *token = static_cast<uint8_t>(std::min<size_t>(num_literals, 15) << 4);
+  if (num_literals >= 15 && !WriteLength(op, oend, num_literals - 15)) {
+    return false;
+  }
+  if (static_cast<size_t>(oend - *op) < num_literals) {
+    return false;
+  }
+  memcpy(*op, literals, num_literals);
+  *op += num_literals;
+  if (match_length == 0) {
+    return true;
+  }
+  if (oend - *op < 2) {
+    return false;
+  }
+  *(*op)++ = static_cast<uint8_t>(offset);
+  *(*op)++ = static_cast<uint8_t>(offset >> 8);
+  match_length -= MIN_MATCH;
+  *token |= static_cast<uint8_t>(std::min<size_t>(match_length, 15));
+  return match_length < 15 || WriteLength(op, oend, match_length - 15);
+}
+
+}  // namespace
+
+size_t Lz4Compress(const char *src, size_t size, char *dst, size_t capacity) {
+  const auto *base = reinterpret_cast<const uint8_t *>(src);
+  const uint8_t *iend = base + size;
+  const uint8_t *anchor = base;
+  auto *op = reinterpret_cast<uint8_t *>(dst);
+  const uint8_t *oend = op + capacity;
+
+  if (size > MFLIMIT) {
+    const uint8_t *match_limit = iend - MFLIMIT;
+    const uint8_t *match_end_limit = iend - LAST_LITERALS;
+    uint32_t table[1 << HASH_BITS] = {};
+    const uint8_t *ip = base + 1;
+    while (ip < match_limit) {
+      uint32_t sequence = Read32(ip);
+      uint32_t &slot = table[Hash(sequence)];
+      const uint8_t *ref = base + slot;
+      slot = static_cast<uint32_t>(ip - base);
+      if (static_cast<size_t>(ip - ref) > MAX_OFFSET || Read32(ref) != sequence) {
+        ip += 1 + ((ip - anchor) >> SKIP_TRIGGER);
+        continue;
+      }
+      while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+        ip--;
+        ref--;
+      }
+      size_t length = MIN_MATCH;
+      while (ip + length < match_end_limit && ip[length] == ref[length]) {
+        length++;
+      }
+      if (!WriteSequence(&op, oend, anchor, ip - anchor, ip - ref, length)) {
+        return 0;
+      }
+      ip += length;
+      anchor = ip;
+      // remember a position inside the match too, it is often where the next repetition starts
+      if (ip < match_limit) {
+        table[Hash(Read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - base);
+      }
+    }
+  }
+  if (!WriteSequence(&op, oend, anchor, iend - anchor, 0, 0)) {
+    return 0;
+  }
+  return op - reinterpret_cast<uint8_t *>(dst);
+}
+
+bool Lz4Decompress(const char *src, size_t size, char *dst, size_t capacity, size_t *decompressed_size) {
+  const auto *ip = reinterpret_cast<const uint8_t *>(src);
+  const uint8_t *iend = ip + size;
+  auto *obase = reinterpret_cast<uint8_t *>(dst);
+  uint8_t *op = obase;
+  const uint8_t *oend = obase + capacity;
+
+  while (true) {
+    if (ip == iend) {
+      return false;
+    }
+    uint8_t token = *ip++;
+    size_t num_literals = token >> 4;
+    if (num_literals == 15 && !ReadLength(&ip, iend, &num_literals)) {
+      return false;
+    }
+    if (num_literals > static_cast<size_t>(iend - ip) || num_literals > static_cast<size_t>(oend - op)) {
+      return false;
+    }
+    if (num_literals <= WILD_COPY && iend - ip >= static_cast<ptrdiff_t>(WILD_COPY) &&
+        oend - op >= static_cast<ptrdiff_t>(WILD_COPY)) {
+      memcpy(op, ip, WILD_COPY);
+    } else {
+      memcpy(op, ip, num_literals);
+    }
+    ip += num_literals;
+    op += num_literals;
+    if (ip == iend) {
+      break;
+    }
+
+    if (iend - ip < 2) {
+      return false;
+    }
+    size_t offset = ip[0] | static_cast<size_t>(ip[1]) << 8;
+    ip += 2;
+    size_t length = token & 15;
+    if (length == 15 && !ReadLength(&ip, iend, &length)) {
+      return false;
+    }
+    length += MIN_MATCH;
+    if (offset == 0 || offset > static_cast<size_t>(op - obase) || length > static_cast<size_t>(oend - op)) {
+      return false;
+    }
+    const uint8_t *ref = op - offset;
+    if (offset >= WILD_COPY && static_cast<size_t>(oend - op) >= length + WILD_COPY) {
+      // every chunk reads bytes that were written before it
+      for (size_t copied = 0; copied < length; copied += WILD_COPY) {
+        memcpy(op + copied, ref + copied, WILD_COPY);
+      }
+    } else if (offset >= length) {
+      memcpy(op, ref, length);
+    } else if (offset == 1) {
+      memset(op, *ref, length);
+    } else {
+      // the match overlaps itself: a pattern of offset bytes repeats, so every copy can take all of it written so far
+      size_t copied = 0;
+      while (copied < length) {
+        size_t chunk = std::min(length - copied, offset + copied);
+        memcpy(op + copied, ref, chunk);
+        copied += chunk;
+      }
+    }
+    op += length;
+  }
+  *decompressed_size = op - obase;
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+
+/** Kinds of bulk access that should not take over the shared buffer pool. */
+enum class BufferAccessType {
+  /** Large sequential scans. */
+  BULK_READ,
+  /** Bulk inserts, e.g. loading a table. */
+  BULK_WRITE,
+};
+
+/**
+ * BufferAccessStrategy is a hint passed to FetchPage/NewPage by an operation that touches many pages exactly once.
+ *
+ * Instead of evicting pages from the shared replacer on every miss, such an operation recycles a small private ring
+ * of frames: a miss first tries to reuse the frame the ring handed out ring_size misses ago, and only falls back to
+ * the replacer when that frame is pinned or has been taken over by another page. Hits through a strategy do not
+ * warm the page up in the replacer either. A strategy belongs to one scan or insert and is not thread safe.
+ */
+class BufferAccessStrategy {
+ public:
+  /**
+   * Creates a new strategy with the default ring size for its type, capped at an eighth of the pool.
+   * @param type the kind of bulk access
+   * @param pool_size size of the buffer pool the strategy is used with
+   * @param min_ring_size frames the ring holds regardless of the cap, for callers that keep that many pages in flight
+   */
+  BufferAccessStrategy(BufferAccessType type, size_t pool_size, size_t min_ring_size = 1);
+
+  ~BufferAccessStrategy() = default;
+
+  DISALLOW_COPY_AND_MOVE(BufferAccessStrategy);
+
+  /** @return the kind of bulk access */
+  BufferAccessType GetType() const { return type_; }
+
+  /** @return the number of frames in the ring */
+  size_t GetRingSize() const { return ring_.size(); }
+
+ private:
+  friend class BufferPoolManagerInstance;
+
+  /** A frame the ring handed out, and the page it was given to. */
+  struct Slot {
+    const BufferPoolManager *owner_ = nullptr;
+    frame_id_t frame_id_ = -1;
+    page_id_t page_id_ = INVALID_PAGE_ID;
+  };
+
+  /** Advance to the next ring slot and return it; the slot may be empty or owned by another instance. */
+  Slot *NextSlot() {
+    current_ = (current_ + 1) % ring_.size();
+    return &ring_[current_];
+  }
+
+  /** Record the frame a miss ended up using in the current slot. */
+  void SetCurrent(const BufferPoolManager *owner, frame_id_t frame_id, page_id_t page_id) {
+    ring_[current_] = {owner, frame_id, page_id};
+  }
+
+  BufferAccessType type_;
+  std::vector<Slot> ring_;
+  size_t current_ = 0;
+};
+
+}  // namespace bustub
@@ -14,12 +14,17 @@
 
 #include <list>
 #include <mutex>  // NOLINT
+#include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_segment.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
@@ -30,6 +35,8 @@ class BufferPoolManager {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (*)(enum CallbackType, const page_id_t page_id);
+  /** Returns the id of the page after the given (read-latched) page in a chain, e.g. TablePage::GetNextPageId. */
+  using next_page_fn = page_id_t (*)(Page *page);
 
   BufferPoolManager() = default;
   /**
@@ -84,6 +91,139 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Fetch the requested page on behalf of a bulk operation; a miss recycles a frame of the strategy's ring.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the scan
+   * @return the requested page
+   */
+  Page *FetchPage(page_id_t page_id, BufferAccessStrategy &strategy) { return FetchPgImp(page_id, &strategy); }
+
+  /**
+   * Create a new page on behalf of a bulk operation; the page goes into a frame of the strategy's ring.
+   * @param[out] page_id id of created page
+   * @param strategy the access strategy of the insert
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPage(page_id_t *page_id, BufferAccessStrategy &strategy) { return NewPgImp(page_id, &strategy); }
+
+  /**
+   * Create a new page in a segment: the next page of the segment's current extent, reserving a new extent when the
+   * current one is used up. A buffer pool that cannot reserve extents creates an ordinary page instead.
+   * @param[out] page_id id of created page
+   * @param segment the segment of the table or index the page is for
+   * @param strategy the access strategy of a bulk insert, or nullptr
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPage(page_id_t *page_id, PageSegment &segment, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Fetch several pages at once, e.g. all the pages an index probe or a join is about to touch. Implementations
+   * take each of their latches once per batch instead of once per page, and read the misses together.
+   * @param page_ids ids of the pages to fetch; an id may repeat, it is then pinned once per occurrence
+   * @param num_pages number of ids
+   * @param[out] pages pages[i] is page_ids[i], pinned, or nullptr if it could not be fetched (every frame pinned)
+   * @return number of pages fetched
+   */
+  size_t FetchPages(const page_id_t *page_ids, size_t num_pages, Page **pages) {
+    return FetchPgsImp(page_ids, num_pages, pages);
+  }
+
+  /**
+   * Unpin several pages at once; the counterpart of FetchPages.
+   * @param page_ids ids of the pages to unpin, once per occurrence
+   * @param num_pages number of ids
+   * @param is_dirty true if the pages should be marked as dirty
+   * @return false if any of the pages had a pin count of 0 before this call, true otherwise
+   */
+  bool UnpinPages(const page_id_t *page_ids, size_t num_pages, bool is_dirty) {
+    return UnpinPgsImp(page_ids, num_pages, is_dirty);
+  }
+
+  /**
+   * Fetch a page and take its read latch. The latch and the pin are released when the guard is dropped.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of a bulk operation, or nullptr
+   * @return the guard, empty if the page could not be fetched
+   */
+  ReadPageGuard FetchPageRead(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) {
+    return ReadPageGuard(this, FetchPgImp(page_id, strategy));
+  }
+
+  /**
+   * Fetch a page and take its write latch. The latch and the pin are released, and the page is marked dirty, when
+   * the guard is dropped.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of a bulk operation, or nullptr
+   * @return the guard, empty if the page could not be fetched
+   */
+  WritePageGuard FetchPageWrite(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) {
+    return WritePageGuard(this, FetchPgImp(page_id, strategy));
+  }
+
+  /**
+   * Fetch a page for optimistic, latch-free reads; see OptimisticPageGuard. The pin is released when the guard is
+   * dropped.
+   * @param page_id id of page to be fetched
+   * @return the guard, empty if the page could not be fetched
+   */
+  OptimisticPageGuard FetchPageOptimistic(page_id_t page_id) {
+    return OptimisticPageGuard(this, FetchPgImp(page_id, nullptr));
+  }
+
+  /**
+   * Create a new page and take its write latch, for initializing it.
+   * @param[out] page_id id of created page
+   * @param strategy the access strategy of a bulk operation, or nullptr
+   * @return the guard, empty if no new pages could be created
+   */
+  WritePageGuard NewPageGuarded(page_id_t *page_id, BufferAccessStrategy *strategy = nullptr) {
+    return WritePageGuard(this, NewPgImp(page_id, strategy));
+  }
+
+  /**
+   * Start reading pages into the pool in the background. This is a hint; a buffer pool without a prefetcher
+   * ignores it.
+   * @param page_ids ids of allocated pages
+   */
+  virtual void PrefetchPages(const std::vector<page_id_t> &page_ids) {}
+
+  /**
+   * Start reading a chain of pages into the pool in the background: page_id, then the page next_page finds in it,
+   * up to depth pages. This is a hint; a buffer pool without a prefetcher ignores it. TableIterator is the only
+   * caller: B+ tree leaf scans do not read ahead.
+   * @param page_id first page of the chain
+   * @param depth number of pages to read ahead, at most GetMaxPrefetchDepth()
+   * @param next_page extracts the next page id from a page
+   */
+  virtual void PrefetchChain(page_id_t page_id, size_t depth, next_page_fn next_page) {}
+
+  /** @return the deepest chain PrefetchChain reads ahead; 0 if the pool does not read ahead */
+  virtual size_t GetMaxPrefetchDepth() const { return 0; }
+
+  /**
+   * @return ids of the pages in the pool, hottest first: pinned pages, then the replacer's candidates from the most
+   * to the least recently useful. A buffer pool that cannot tell returns nothing.
+   */
+  virtual std::vector<page_id_t> GetResidentPages() { return {}; }
+
+  /**
+   * Save the resident page set, hottest first, so that WarmUp can bring it back after a restart.
+   * @param path file to write
+   * @return false if the file could not be written
+   */
+  bool DumpResidentPages(const std::string &path);
+
+  /**
+   * Load the pages saved by DumpResidentPages, as many of the hottest ones as fit. Reads are issued in page id
+   * (i.e. file offset) order, split over several threads; afterwards the pages are unpinned coldest first, so the
+   * replacer ranks them as they were ranked when dumped. Meant to run before the pool serves any traffic.
+   * @param path file written by DumpResidentPages
+   * @param num_threads number of threads reading pages
+   * @return number of pages loaded, 0 if the file is missing or malformed
+   */
+  size_t WarmUp(const std::string &path, size_t num_threads = 4);
+
   /** @return size of the buffer pool */
   virtual size_t GetPoolSize() = 0;
 
@@ -105,6 +245,9 @@ class BufferPoolManager {
   Page* wrap_FetchPgImp(page_id_t page_id) {
     return FetchPgImp(page_id);
   }
+  Page* wrap_FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) {
+    return FetchPgImp(page_id, strategy);
+  }
   bool wrap_UnpinPgImp(page_id_t page_id, bool is_dirty) {
     return UnpinPgImp(page_id, is_dirty);
   }
@@ -114,12 +257,27 @@ class BufferPoolManager {
   Page* wrap_NewPgImp(page_id_t *page_id) {
     return NewPgImp(page_id);
   }
+  Page* wrap_NewPgImp(page_id_t *page_id, BufferAccessStrategy *strategy) {
+    return NewPgImp(page_id, strategy);
+  }
   bool wrap_DeletePgImp(page_id_t page_id) {
     return DeletePgImp(page_id);
   }
   void wrap_FlushAllPgsImpl() {
     FlushAllPgsImp();
   }
+  size_t wrap_FetchPgsImp(const page_id_t *page_ids, size_t num_pages, Page **pages) {
+    return FetchPgsImp(page_ids, num_pages, pages);
+  }
+  bool wrap_UnpinPgsImp(const page_id_t *page_ids, size_t num_pages, bool is_dirty) {
+    return UnpinPgsImp(page_ids, num_pages, is_dirty);
+  }
+  page_id_t wrap_AllocateExtentImp(size_t num_pages) {
+    return AllocateExtentImp(num_pages);
+  }
+  Page* wrap_NewPgAtImp(page_id_t page_id, BufferAccessStrategy *strategy) {
+    return NewPgAtImp(page_id, strategy);
+  }
 
  protected:
   /**
@@ -129,6 +287,14 @@ class BufferPoolManager {
    */
   virtual Page *FetchPgImp(page_id_t page_id) = 0;
 
+  /**
+   * Fetch the requested page through an access strategy. Implementations without rings ignore the strategy.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy, nullptr for a normal fetch
+   * @return the requested page
+   */
+  virtual Page *FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) { return FetchPgImp(page_id); }
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -137,6 +303,37 @@ class BufferPoolManager {
    */
   virtual bool UnpinPgImp(page_id_t page_id, bool is_dirty) = 0;
 
+  /**
+   * Fetch several pages. The default fetches them one by one.
+   * @param page_ids ids of the pages to fetch
+   * @param num_pages number of ids
+   * @param[out] pages the pinned pages, nullptr for those that could not be fetched
+   * @return number of pages fetched
+   */
+  virtual size_t FetchPgsImp(const page_id_t *page_ids, size_t num_pages, Page **pages) {
+    size_t fetched = 0;
+    for (size_t i = 0; i < num_pages; i++) {
+      pages[i] = FetchPgImp(page_ids[i]);
+      fetched += pages[i] != nullptr ? 1 : 0;
+    }
+    return fetched;
+  }
+
+  /**
+   * Unpin several pages. The default unpins them one by one.
+   * @param page_ids ids of the pages to unpin
+   * @param num_pages number of ids
+   * @param is_dirty true if the pages should be marked as dirty
+   * @return false if any page pin count was <= 0 before this call, true otherwise
+   */
+  virtual bool UnpinPgsImp(const page_id_t *page_ids, size_t num_pages, bool is_dirty) {
+    bool unpinned = true;
+    for (size_t i = 0; i < num_pages; i++) {
+      unpinned = UnpinPgImp(page_ids[i], is_dirty) && unpinned;
+    }
+    return unpinned;
+  }
+
   /**
    * Flushes the target page to disk.
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
@@ -151,6 +348,29 @@ class BufferPoolManager {
    */
   virtual Page *NewPgImp(page_id_t *page_id) = 0;
 
+  /**
+   * Creates a new page through an access strategy. Implementations without rings ignore the strategy.
+   * @param[out] page_id id of created page
+   * @param strategy the access strategy, nullptr for a normal allocation
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual Page *NewPgImp(page_id_t *page_id, BufferAccessStrategy *strategy) { return NewPgImp(page_id); }
+
+  /**
+   * Reserve an extent of contiguous pages on disk.
+   * @param num_pages number of pages in the extent
+   * @return the first page of the extent, or INVALID_PAGE_ID if this buffer pool does not do extents
+   */
+  virtual page_id_t AllocateExtentImp(size_t num_pages) { return INVALID_PAGE_ID; }
+
+  /**
+   * Creates a new page for a page id that is already allocated, i.e. a page of a reserved extent.
+   * @param page_id id of the page
+   * @param strategy the access strategy, nullptr for a normal allocation
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual Page *NewPgAtImp(page_id_t page_id, BufferAccessStrategy *strategy) { return nullptr; }
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
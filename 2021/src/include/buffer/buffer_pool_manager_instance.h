@@ -12,18 +12,70 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
 #include <list>
-#include <mutex>  // NOLINT
-#include <unordered_map>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_table.h"
+#include "buffer/prefetcher.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
+/**
+ * Knobs for the background page cleaner, see BufferPoolManagerInstance::RunPageCleaner.
+ */
+struct PageCleanerConfig {
+  /** How often the cleaner wakes up. */
+  std::chrono::milliseconds interval_{10};
+  /** Rate limit: the most pages the cleaner writes per wake-up. */
+  size_t max_writes_per_round_ = 32;
+  /** The cleaner tries to keep this many of the coldest evictable frames clean. */
+  size_t clean_watermark_ = 64;
+};
+
+/**
+ * How a parallel buffer pool maps page ids to its instances.
+ */
+enum class PageRouting {
+  /** page_id % num_instances: consecutive pages of one table land on consecutive instances. */
+  MODULO,
+  /** A mixing hash of the page id, so that any regular stride of page ids still spreads evenly. */
+  HASH
+};
+
+/**
+ * @param page_id id of the page
+ * @param num_instances number of instances in the pool
+ * @param routing how page ids are mapped
+ * @return index of the instance that owns page_id
+ */
+inline uint32_t InstanceForPage(page_id_t page_id, uint32_t num_instances, PageRouting routing) {
+  auto h = static_cast<uint32_t>(page_id);
+  if (routing == PageRouting::HASH) {
+    // murmur3 finalizer
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+  }
+  return h % num_instances;
+}
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
  */
@@ -34,8 +86,12 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_policy the replacement policy used to pick victim frames
+   * @param arena_options huge page and NUMA placement of the frames
    */
-  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerPolicy replacer_policy = ReplacerPolicy::LRU,
+                            const FrameArenaOptions &arena_options = FrameArenaOptions());
   /**
    * Creates a new BufferPoolManagerInstance.
    * @param pool_size the size of the buffer pool
@@ -43,9 +99,15 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param instance_index index of this BPI in the parallel BPM
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_policy the replacement policy used to pick victim frames
+   * @param routing how the parallel BPM maps page ids to instances; this BPI only hands out ids that map to itself
+   * @param arena_options huge page and NUMA placement of the frames
    */
   BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                            DiskManager *disk_manager, LogManager *log_manager = nullptr);
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerPolicy replacer_policy = ReplacerPolicy::LRU,
+                            PageRouting routing = PageRouting::MODULO,
+                            const FrameArenaOptions &arena_options = FrameArenaOptions());
 
   /**
    * Destroys an existing BufferPoolManagerInstance.
@@ -58,15 +120,120 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @return pointer to all the pages in the buffer pool */
   Page *GetPages() { return pages_; }
 
-  // add some extra wrap function
-  Page* wrap_FetchPgImp(page_id_t page_id);
-  bool wrap_UnpinPgImp(page_id_t page_id, bool is_dirty);
-  bool wrap_FlushPgImp(page_id_t page_id);
-  Page* wrap_NewPgImp(page_id_t *page_id);
-  bool wrap_DeletePgImp(page_id_t page_id);
-  void wrap_FlushAllPgsImpl();
+  /** @return the memory holding the frames */
+  const FrameArena &GetFrameArena() const { return arena_; }
+
+  /**
+   * Start a background thread that writes out dirty pages at the cold end of the replacer ahead of eviction, so
+   * that foreground fetches find clean victims. Does nothing if the cleaner is already running.
+   * @param config cleaner interval, rate limit and clean-frame watermark
+   */
+  void RunPageCleaner(const PageCleanerConfig &config = PageCleanerConfig());
+
+  /** Stop and join the page cleaner thread, if it is running. */
+  void StopPageCleaner();
+
+  /** @return number of dirty victims written out by the thread that needed their frame */
+  uint64_t GetForegroundWriteCount() const { return foreground_writes_.Get(); }
+
+  /** @return number of dirty pages written out by the page cleaner */
+  uint64_t GetBackgroundWriteCount() const { return background_writes_.Get(); }
+
+  void PrefetchPages(const std::vector<page_id_t> &page_ids) override { prefetcher_.PrefetchPages(page_ids); }
+
+  void PrefetchChain(page_id_t page_id, size_t depth, next_page_fn next_page) override {
+    prefetcher_.PrefetchChain(page_id, depth, next_page);
+  }
+
+  size_t GetMaxPrefetchDepth() const override { return prefetcher_.GetMaxDepth(); }
+
+  /** @return number of pages fetched by the prefetcher */
+  uint64_t GetPrefetchCount() const { return prefetcher_.GetPrefetchCount(); }
+
+  /** @return a snapshot of this instance's occupancy, counters and latency histograms */
+  BufferPoolStats GetStats();
+
+  std::vector<page_id_t> GetResidentPages() override;
+
  protected:
-  bool find_replace(frame_id_t *frema_id);
+  /**
+   * Acquire latch_, counting the acquisition and, if it had to wait for another thread, how long it waited.
+   * @return the held lock
+   */
+  std::unique_lock<std::mutex> LockLatch();
+
+  /** Read a page from disk into a frame, recording the latency. */
+  void ReadFromDisk(page_id_t page_id, char *data);
+
+  /** Write a frame to disk, after the log records that changed it if it carries an LSN, recording the latency. */
+  void WriteToDisk(page_id_t page_id, Page *page);
+
+  /** Read several pages into frames with one DiskManager call, recording the latency of each page. */
+  void ReadFromDisk(const std::vector<page_id_t> &page_ids, const std::vector<char *> &data);
+
+  /**
+   * Pick a frame to reuse, from the strategy's ring first if there is one, then the free list, then the replacer.
+   * Caller must hold latch_.
+   * @param[out] frame_id the frame to reuse
+   * @param[out] writeback_page_id the dirty page the frame still holds and the caller must write out before reusing
+   * it, or INVALID_PAGE_ID. It stays in pending_writes_ until FinishIo.
+   * @param strategy the access strategy of the caller, or nullptr
+   * @return false if every frame is pinned
+   */
+  bool find_replace(frame_id_t *frame_id, page_id_t *writeback_page_id, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Take back the frame in the strategy's next ring slot, if it still holds the page the ring put there and nobody
+   * has it pinned. Caller must hold latch_.
+   * @return false if the slot is empty or its frame cannot be reused
+   */
+  bool ReuseRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id, page_id_t *writeback_page_id);
+
+  /**
+   * Drop an unpinned frame's page from the page table so the frame can be reused. Caller must hold latch_.
+   * @return false if the frame got pinned in the meantime
+   */
+  bool EvictFrame(frame_id_t frame_id, page_id_t *writeback_page_id);
+
+  /**
+   * Assign a frame to a page, pin it, and publish it in the page table with its I/O still in progress.
+   * Caller must hold latch_, and must call FinishIo once the frame's disk I/O is done.
+   * @return the page held by the frame
+   */
+  Page *ClaimFrame(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * The body of NewPgImp and NewPgAtImp: claim a frame, zero it and write the zeroed page out.
+   * @param page_id the page to create, or INVALID_PAGE_ID to allocate one once a frame is found
+   * @return the pinned page, nullptr if every frame is pinned
+   */
+  Page *CreatePage(page_id_t page_id, BufferAccessStrategy *strategy);
+
+  /**
+   * Mark the I/O on a claimed frame as done and wake up everyone waiting on it. Takes latch_.
+   * @param page the claimed page
+   * @param writeback_page_id the page that was written out of the frame first, or INVALID_PAGE_ID
+   */
+  void FinishIo(Page *page, page_id_t writeback_page_id);
+
+  /** Block until the I/O on a pinned page is done. Only takes latch_ if there is something to wait for. */
+  void WaitForIo(Page *page);
+
+  /**
+   * Pin the page if it is resident. Only takes the page table stripe latch, not latch_. The page may still be
+   * loading, see WaitForIo. With touch_replacer = false the frame keeps its place in the replacer; eviction then
+   * skips it while pinned, and the matching unpin leaves its position alone.
+   * @param page_id id of the page
+   * @return the pinned page, or nullptr if the page is not in the buffer pool
+   */
+  Page *PinResident(page_id_t page_id, bool touch_replacer = true);
+
+  /**
+   * One page cleaner pass: write out the dirty pages among the coldest evictable frames.
+   * @return number of pages written
+   */
+  size_t CleanColdFrames(const PageCleanerConfig &config);
+
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
@@ -74,6 +241,14 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   Page *FetchPgImp(page_id_t page_id) override;
 
+  /**
+   * Fetch the requested page, recycling a frame of the strategy's ring on a miss.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy, nullptr for a normal fetch
+   * @return the requested page
+   */
+  Page *FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -82,6 +257,16 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   bool UnpinPgImp(page_id_t page_id, bool is_dirty) override;
 
+  /**
+   * Fetch several pages. Hits pin under their page table stripe latches and then go through the replacer in one
+   * call; misses claim their frames under a single acquisition of latch_ and are read in page id order with one
+   * DiskManager::ReadPages call.
+   */
+  size_t FetchPgsImp(const page_id_t *page_ids, size_t num_pages, Page **pages) override;
+
+  /** Unpin several pages; frames whose pin count drops to zero go back to the replacer in one call. */
+  bool UnpinPgsImp(const page_id_t *page_ids, size_t num_pages, bool is_dirty) override;
+
   /**
    * Flushes the target page to disk.
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
@@ -96,6 +281,29 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   Page *NewPgImp(page_id_t *page_id) override;
 
+  /**
+   * Creates a new page in a frame of the strategy's ring.
+   * @param[out] page_id id of created page
+   * @param strategy the access strategy, nullptr for a normal allocation
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPgImp(page_id_t *page_id, BufferAccessStrategy *strategy) override;
+
+  /**
+   * Reserves an extent of contiguous pages on disk.
+   * @param num_pages number of pages in the extent
+   * @return the first page of the extent
+   */
+  page_id_t AllocateExtentImp(size_t num_pages) override;
+
+  /**
+   * Creates a new page for an allocated page id, e.g. a page of a reserved extent.
+   * @param page_id id of the page; must route to this instance
+   * @param strategy the access strategy, nullptr for a normal allocation
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPgAtImp(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -109,18 +317,16 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   void FlushAllPgsImp() override;
 
   /**
-   * Allocate a page on disk.∂
+   * Allocate a page on disk, from this instance's partition of the disk manager's allocator.
    * @return the id of the allocated page
    */
   page_id_t AllocatePage();
 
   /**
-   * Deallocate a page on disk.
+   * Deallocate a page on disk, so that this instance can hand it out again.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id) { disk_manager_->DeallocatePage(page_id); }
 
   /**
    * Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions to
@@ -135,23 +341,66 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   const uint32_t num_instances_ = 1;
   /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
   const uint32_t instance_index_ = 0;
-  /** Each BPI maintains its own counter for page_ids to hand out, must ensure they mod back to its instance_index_ */
-  std::atomic<page_id_t> next_page_id_ = instance_index_;
+  /** How page ids map to instances. */
+  const PageRouting routing_ = PageRouting::MODULO;
 
-  /** Array of buffer pool pages. */
+  /** Page data and frame metadata of the buffer pool. */
+  FrameArena arena_;
+  /** Array of buffer pool pages, owned by arena_. */
   // use frame_id as bottom index
   Page *pages_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  LogManager *log_manager_;
+  /** Page table for keeping track of buffer pool pages. Internally latched per stripe. */
+  PageTable page_table_;
   /** Replacer to find unpinned pages for replacement. */
   Replacer *replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * Number of frames with a zero pin count, free ones included. Maintained on every 0 <-> 1 pin transition, so
+   * "every frame is pinned" is a single load instead of a scan over the pool.
+   */
+  std::atomic<size_t> num_unpinned_frames_;
+  /** Evicted dirty pages whose write-back is still in flight. Protected by latch_. */
+  std::unordered_set<page_id_t> pending_writes_;
+  /** Signalled, with latch_, whenever a frame finishes its I/O. */
+  std::condition_variable io_cv_;
+
+  /** Dirty victims written by foreground fetches / new pages, and pages written by the cleaner. */
+  ShardedCounter foreground_writes_;
+  ShardedCounter background_writes_;
+
+  /** Counters and histograms reported by GetStats, see BufferPoolStats. Sharded, so they can always stay on. */
+  ShardedCounter fetches_;
+  ShardedCounter hits_;
+  ShardedCounter misses_;
+  ShardedCounter fetch_failures_;
+  ShardedCounter new_pages_;
+  ShardedCounter new_page_failures_;
+  ShardedCounter dirty_evictions_;
+  ShardedCounter clean_evictions_;
+  ShardedCounter latch_acquisitions_;
+  ShardedCounter latch_contended_;
+  LatencyHistogram read_latency_;
+  LatencyHistogram write_latency_;
+  LatencyHistogram latch_wait_;
+
+  /** The page cleaner thread, nullptr when not running. */
+  std::thread *cleaner_thread_ = nullptr;
+  /** Protects cleaner_running_ and wakes the cleaner up early on shutdown. */
+  std::mutex cleaner_latch_;
+  std::condition_variable cleaner_cv_;
+  bool cleaner_running_ = false;
+  /** Reads pages ahead of scans; its thread starts with the first request. */
+  Prefetcher prefetcher_;
+  /**
+   * Protects the free list, pending_writes_ and every (re)assignment of a frame to a page: misses, new pages and
+   * deletes. It is never held across disk I/O. Hits, unpins and flushes do not take it; they synchronize with
+   * eviction through the page table stripe latches.
+   */
   std::mutex latch_;
 };
 }  // namespace bustub
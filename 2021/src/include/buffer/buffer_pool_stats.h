@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace bustub {
+
+/** Number of shards of every counter and histogram. Threads are spread over them round robin. */
+static constexpr size_t STATS_SHARDS = 16;
+
+/** @return the shard of the calling thread */
+inline size_t StatsShard() {
+  static std::atomic<size_t> next_shard{0};
+  thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % STATS_SHARDS;
+  return shard;
+}
+
+/**
+ * A counter split into cache-line-sized shards. Threads bump their own shard with a relaxed add, so hot paths that
+ * count on every call do not bounce one line between cores; reads sum the shards.
+ */
+class ShardedCounter {
+ public:
+  void Add(uint64_t n = 1) { shards_[StatsShard()].value_.fetch_add(n, std::memory_order_relaxed); }
+
+  /** @return the sum over all shards; concurrent adds may or may not be included */
+  uint64_t Get() const {
+    uint64_t sum = 0;
+    for (const auto &shard : shards_) {
+      sum += shard.value_.load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> value_{0};
+  };
+  std::array<Shard, STATS_SHARDS> shards_;
+};
+
+/**
+ * A merged, point-in-time copy of a LatencyHistogram. Bucket i counts latencies in [2^i, 2^(i+1)) nanoseconds;
+ * bucket 0 also takes 0.
+ */
+struct HistogramSnapshot {
+  static constexpr size_t NUM_BUCKETS = 40;
+
+  std::array<uint64_t, NUM_BUCKETS> buckets_{};
+  uint64_t count_ = 0;
+  uint64_t total_nanos_ = 0;
+
+  /** @return the mean latency in nanoseconds, 0 if empty */
+  double MeanNanos() const { return count_ == 0 ? 0 : static_cast<double>(total_nanos_) / count_; }
+
+  /**
+   * @param quantile e.g. 0.99
+   * @return the upper bound of the bucket holding the quantile, in nanoseconds; 0 if empty
+   */
+  uint64_t PercentileNanos(double quantile) const;
+
+  HistogramSnapshot &operator+=(const HistogramSnapshot &other);
+};
+
+/**
+ * A sharded latency histogram with power-of-two nanosecond buckets. Recording is a few relaxed adds on the calling
+ * thread's shard.
+ */
+class LatencyHistogram {
+ public:
+  /** @param nanos one observed latency */
+  void Record(uint64_t nanos);
+
+  /** Record the time elapsed since start. */
+  void RecordSince(std::chrono::steady_clock::time_point start) {
+    Record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  /** @return the merged shards */
+  HistogramSnapshot Snapshot() const;
+
+ private:
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, HistogramSnapshot::NUM_BUCKETS> buckets_{};
+    std::atomic<uint64_t> total_nanos_{0};
+  };
+  std::array<Shard, STATS_SHARDS> shards_;
+};
+
+/**
+ * A snapshot of a buffer pool's occupancy, activity and latencies, see BufferPoolManagerInstance::GetStats.
+ */
+struct BufferPoolStats {
+  /** Number of frames. */
+  size_t pool_size_ = 0;
+  /** Frames holding a page. */
+  size_t resident_pages_ = 0;
+  /** Frames with a non-zero pin count. */
+  size_t pinned_frames_ = 0;
+  /** FetchPage calls, how many found the page resident, how many read it in, and how many failed (all pinned). */
+  uint64_t fetches_ = 0;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t fetch_failures_ = 0;
+  /** Pages created, and NewPage calls that failed because every frame was pinned. */
+  uint64_t new_pages_ = 0;
+  uint64_t new_page_failures_ = 0;
+  /** Pages evicted to reuse their frame, split by whether they had to be written back first. */
+  uint64_t dirty_evictions_ = 0;
+  uint64_t clean_evictions_ = 0;
+  /** Acquisitions of the instance latch on the miss / new page paths, and how many of them had to wait. */
+  uint64_t latch_acquisitions_ = 0;
+  uint64_t latch_contended_ = 0;
+  /** Page reads and writes issued by the pool (including the page cleaner), and waits for a contended latch. */
+  HistogramSnapshot read_latency_;
+  HistogramSnapshot write_latency_;
+  HistogramSnapshot latch_wait_;
+
+  /** Adds up the stats of several instances. */
+  BufferPoolStats &operator+=(const BufferPoolStats &other);
+
+  /** @return a multi-line, human readable dump */
+  std::string ToString() const;
+};
+
+}  // namespace bustub
@@ -12,8 +12,9 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -23,6 +24,10 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Every frame owns one atomic state word and the clock hand is an atomic counter, so Pin and Unpin are a single
+ * atomic exchange and never take a latch; concurrent Victim calls each advance the hand and race for frames with a
+ * compare-and-swap.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -43,10 +48,20 @@ class ClockReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  std::vector<frame_id_t> PeekVictims(size_t max_frames) override;
+
   size_t Size() override;
 
  private:
-  // TODO(student): implement me!
+  /** Per-frame state. A frame is in the clock iff its state is not ABSENT. */
+  enum FrameState : uint8_t { ABSENT = 0, UNREFERENCED = 1, REFERENCED = 2 };
+
+  size_t num_pages_;
+  std::unique_ptr<std::atomic<uint8_t>[]> states_;
+  /** Monotonic; the frame under the hand is clock_hand_ % num_pages_. */
+  std::atomic<size_t> clock_hand_{0};
+  /** Signed: a Pin may briefly overtake the matching Unpin's increment. */
+  std::atomic<int64_t> size_{0};
 };
 
 }  // namespace bustub
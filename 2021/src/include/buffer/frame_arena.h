@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/macros.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * Where a FrameArena's page data is allocated.
+ */
+struct FrameArenaOptions {
+  /** Let the kernel place the page data. */
+  static constexpr int NO_NUMA_NODE = -1;
+  /** Only for a ParallelBufferPoolManager: bind instance i to NUMA node i % FrameArena::NumNumaNodes(). */
+  static constexpr int SPREAD_NUMA_NODES = -2;
+
+  /**
+   * Back the page data with huge pages: explicit ones (MAP_HUGETLB) if the system has them reserved, otherwise
+   * transparent huge pages via madvise.
+   */
+  bool huge_pages_ = false;
+  /** NUMA node to bind the page data to. Ignored when built without libnuma or when the system is not NUMA. */
+  int numa_node_ = NO_NUMA_NODE;
+};
+
+/**
+ * How a FrameArena's page data ended up being backed.
+ */
+enum class FrameBacking { SMALL_PAGES, TRANSPARENT_HUGE_PAGES, HUGETLB };
+
+/**
+ * FrameArena owns the frames of a buffer pool instance. Page data lives in one page-aligned anonymous mapping,
+ * contiguous and away from the frame metadata (page id, pin count, latch, ...), which sits in a separate array with
+ * each frame on its own cache lines. Scans over the data then walk few TLB entries, and pinning or latching one frame
+ * never invalidates a line that holds another frame's bytes. Every frame's data is OS-page aligned, so frames can be
+ * read and written with direct I/O (DiskManagerOptions::direct_io_) without a bounce buffer.
+ */
+class FrameArena {
+ public:
+  /**
+   * Maps and zeroes the page data and builds the frames.
+   * @param num_frames the number of frames
+   * @param options huge page and NUMA placement
+   */
+  explicit FrameArena(size_t num_frames, const FrameArenaOptions &options = FrameArenaOptions());
+
+  ~FrameArena();
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /** @return the frames, indexed by frame id */
+  Page *GetPages() const { return pages_; }
+
+  /** @return how the page data is backed */
+  FrameBacking GetBacking() const { return backing_; }
+
+  /** @return the NUMA node the page data is bound to, or FrameArenaOptions::NO_NUMA_NODE */
+  int GetNumaNode() const { return numa_node_; }
+
+  /** @return the number of NUMA nodes with memory, 1 when built without libnuma */
+  static int NumNumaNodes();
+
+ private:
+  size_t num_frames_;
+  /** The mapping, and the page data inside it, aligned to the huge page size when backed by huge pages. */
+  char *mapping_ = nullptr;
+  size_t mapping_bytes_ = 0;
+  char *data_ = nullptr;
+  /** Frame metadata, cache line aligned. */
+  Page *pages_ = nullptr;
+  FrameBacking backing_ = FrameBacking::SMALL_PAGES;
+  int numa_node_ = FrameArenaOptions::NO_NUMA_NODE;
+};
+
+}  // namespace bustub
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The victim is the evictable frame whose K-th most recent reference lies furthest in the past. Frames with fewer
+ * than K references count as infinitely far and go first, least recently used among them first. A page touched
+ * once by a sequential scan therefore never displaces a page that keeps being re-referenced.
+ *
+ * A frame's references are its Pin calls, plus the Unpin that first adds a freshly loaded frame. References that
+ * follow the previous one within the correlated reference period are folded into it, so a scan that fetches the same
+ * page once per tuple still counts as a single reference.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of references tracked per frame
+   * @param correlated_period references closer than this many ticks of the replacer's clock count as one
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = 2, uint64_t correlated_period = 16);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  void PinAll(const std::vector<frame_id_t> &frame_ids) override;
+
+  std::vector<frame_id_t> PeekVictims(size_t max_frames) override;
+
+  size_t Size() override;
+
+ private:
+  struct FrameInfo {
+    /** Timestamps of the last (up to) k uncorrelated references, oldest first. */
+    std::vector<uint64_t> history_;
+    bool evictable_ = false;
+  };
+
+  /** Record a reference at the current tick. Caller must hold latch_. */
+  void RecordAccess(FrameInfo *info);
+
+  /** @return the queue a frame sits in while evictable and its key there. Caller must hold latch_. */
+  std::pair<std::set<std::pair<uint64_t, frame_id_t>> *, uint64_t> QueueOf(const FrameInfo &info);
+
+  /** Pin / Unpin one frame. Caller must hold latch_. */
+  void PinFrame(frame_id_t frame_id);
+  void UnpinFrame(frame_id_t frame_id);
+
+  std::mutex latch_;
+  size_t k_;
+  uint64_t correlated_period_;
+  uint64_t current_tick_ = 0;
+  std::vector<FrameInfo> frames_;
+  /** Evictable frames with fewer than k references, keyed by their last reference. */
+  std::set<std::pair<uint64_t, frame_id_t>> history_queue_;
+  /** Evictable frames with k references, keyed by their k-th most recent reference. */
+  std::set<std::pair<uint64_t, frame_id_t>> cache_queue_;
+};
+
+}  // namespace bustub
@@ -44,9 +44,17 @@ class LRUReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void PinAll(const std::vector<frame_id_t> &frame_ids) override;
+
+  std::vector<frame_id_t> PeekVictims(size_t max_frames) override;
+
   size_t Size() override;
 
  private:
+  /** Pin / Unpin one frame. Caller must hold latch_. */
+  void PinFrame(frame_id_t frame_id);
+  void UnpinFrame(frame_id_t frame_id);
+
   // TODO(student): implement me!
   std::mutex latch_;  // lock
   size_t capa_; // capacity
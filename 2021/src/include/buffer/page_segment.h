@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_segment.h
+//
+// Identification: src/include/buffer/page_segment.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageSegment is where one table or index gets its new pages from. Instead of taking whatever page id comes next,
+ * the segment reserves an extent, a run of extent_pages contiguous page ids, and hands its pages out in order before
+ * reserving the next extent. The pages of a segment then sit together on disk even while several segments grow at
+ * the same time, and a scan over them turns into long sequential reads.
+ *
+ * Pass the segment to BufferPoolManager::NewPage. The unused rest of the current extent stays reserved for the
+ * segment; a segment lives in memory only, so after a restart the rest of the extent is not used any more.
+ */
+class PageSegment {
+ public:
+  /** Extent size of tables and indexes: 256 KB with 4 KB pages. */
+  static constexpr size_t DEFAULT_EXTENT_PAGES = 64;
+
+  /** @param extent_pages number of pages reserved at once */
+  explicit PageSegment(size_t extent_pages = DEFAULT_EXTENT_PAGES) : extent_pages_(extent_pages) {
+    BUSTUB_ASSERT(extent_pages > 0, "an extent has at least one page");
+  }
+
+  ~PageSegment() = default;
+
+  DISALLOW_COPY_AND_MOVE(PageSegment);
+
+  /** @return number of pages reserved at once */
+  size_t GetExtentPages() const { return extent_pages_; }
+
+  /** @return number of extents reserved so far */
+  size_t GetNumExtents() {
+    std::scoped_lock lock(latch_);
+    return num_extents_;
+  }
+
+ private:
+  friend class BufferPoolManager;
+
+  /** Serializes page creation in the segment. */
+  std::mutex latch_;
+  const size_t extent_pages_;
+  /** The unused pages of the current extent: [next_, end_). */
+  page_id_t next_ = INVALID_PAGE_ID;
+  page_id_t end_ = INVALID_PAGE_ID;
+  size_t num_extents_ = 0;
+};
+
+/**
+ * How scattered a chain of pages (e.g. a table heap) is on disk, taken in the order a scan visits the pages.
+ */
+struct PageFragmentation {
+  /** Pages in the chain. */
+  size_t num_pages_ = 0;
+  /** Maximal runs of pages that directly follow each other on disk; 1 for a perfectly sequential chain. */
+  size_t num_runs_ = 0;
+
+  /** @return the fraction of steps of the scan that jump instead of moving to the next page on disk, in [0, 1] */
+  double Fragmentation() const {
+    return num_pages_ <= 1 ? 0 : static_cast<double>(num_runs_ - 1) / static_cast<double>(num_pages_ - 1);
+  }
+
+  /** @return the mean number of pages a sequential read can cover */
+  double MeanRunPages() const { return num_runs_ == 0 ? 0 : static_cast<double>(num_pages_) / num_runs_; }
+
+  /**
+   * @param page_ids the pages of a chain, in scan order
+   * @return the fragmentation of the chain
+   */
+  static PageFragmentation Of(const std::vector<page_id_t> &page_ids) {
+    PageFragmentation fragmentation;
+    fragmentation.num_pages_ = page_ids.size();
+    for (size_t i = 0; i < page_ids.size(); i++) {
+      if (i == 0 || page_ids[i] != page_ids[i - 1] + 1) {
+        fragmentation.num_runs_++;
+      }
+    }
+    return fragmentation;
+  }
+};
+
+}  // namespace bustub
@@ -0,0 +1,140 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps resident page ids to the frames holding them.
+ *
+ * The table is split into a power-of-two number of stripes. Each stripe is a small linear-probing hash table with its
+ * own latch, laid out on its own cache line, so lookups of pages that hash to different stripes never contend. The
+ * capacity is fixed up front from the number of frames; a stripe only grows if hash skew ever overfills it.
+ */
+class PageTable {
+ public:
+  /**
+   * Creates a new PageTable.
+   * @param num_frames the number of frames in the buffer pool, i.e. the most entries the table will ever hold
+   */
+  explicit PageTable(size_t num_frames);
+
+  ~PageTable() = default;
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  /**
+   * Looks up a page id.
+   * @param page_id id of the page
+   * @param[out] frame_id frame holding the page, if found
+   * @return true if the page is in the table
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id) {
+    return FindAndApply(page_id, [frame_id](frame_id_t found) { *frame_id = found; });
+  }
+
+  /**
+   * Looks up a page id and, if present, invokes fn(frame_id) while the stripe latch is still held. Removals of the
+   * same page take that latch too, so fn can safely update frame state (e.g. pin the frame) without racing eviction.
+   * @return true if the page is in the table
+   */
+  template <typename Fn>
+  bool FindAndApply(page_id_t page_id, Fn &&fn) {
+    Stripe &stripe = StripeFor(page_id);
+    std::scoped_lock lock(stripe.latch_);
+    size_t slot;
+    if (!stripe.Lookup(page_id, Hash(page_id), &slot)) {
+      return false;
+    }
+    fn(stripe.slots_[slot].frame_id_);
+    return true;
+  }
+
+  /**
+   * Inserts or overwrites the mapping for a page id.
+   * @param page_id id of the page
+   * @param frame_id frame holding the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Removes a page id.
+   * @param page_id id of the page
+   * @return true if the page was in the table
+   */
+  bool Remove(page_id_t page_id) {
+    return RemoveIf(page_id, [](frame_id_t frame_id) { return true; });
+  }
+
+  /**
+   * Removes a page id only if pred(frame_id) holds. pred runs under the stripe latch.
+   * @return true if the page was found and removed
+   */
+  template <typename Pred>
+  bool RemoveIf(page_id_t page_id, Pred &&pred) {
+    Stripe &stripe = StripeFor(page_id);
+    std::scoped_lock lock(stripe.latch_);
+    size_t slot;
+    if (!stripe.Lookup(page_id, Hash(page_id), &slot) || !pred(stripe.slots_[slot].frame_id_)) {
+      return false;
+    }
+    stripe.Erase(slot);
+    return true;
+  }
+
+ private:
+  struct Slot {
+    page_id_t page_id_ = INVALID_PAGE_ID;
+    frame_id_t frame_id_ = -1;
+  };
+
+  /** One independently latched linear-probing table. Aligned so that neighbouring latches do not share a line. */
+  struct alignas(64) Stripe {
+    bool Lookup(page_id_t page_id, size_t hash, size_t *slot) const;
+    void Erase(size_t slot);
+    void Grow();
+
+    std::mutex latch_;
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+    size_t size_ = 0;
+  };
+
+  /** Mixes the bits of a page id; consecutive page ids must not land in consecutive slots of one stripe. */
+  static size_t Hash(page_id_t page_id) {
+    uint64_t h = static_cast<uint32_t>(page_id);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<size_t>(h);
+  }
+
+  /** Low bits pick the slot inside a stripe, high bits pick the stripe. */
+  Stripe &StripeFor(page_id_t page_id) { return stripes_[(Hash(page_id) >> 32) & (num_stripes_ - 1)]; }
+
+  size_t num_stripes_;
+  std::unique_ptr<Stripe[]> stripes_;
+};
+
+}  // namespace bustub
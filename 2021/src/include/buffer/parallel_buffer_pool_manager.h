@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
@@ -30,9 +31,15 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    * @param pool_size the pool size of each BufferPoolManagerInstance
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_policy the replacement policy of every instance
+   * @param routing how page ids are mapped to instances
+   * @param arena_options huge page and NUMA placement of every instance's frames; with
+   * FrameArenaOptions::SPREAD_NUMA_NODES the instances are spread round robin over the NUMA nodes
    */
   ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerPolicy replacer_policy = ReplacerPolicy::LRU,
+                            PageRouting routing = PageRouting::MODULO,
+                            const FrameArenaOptions &arena_options = FrameArenaOptions());
 
   /**
    * Destroys an existing ParallelBufferPoolManager.
@@ -55,6 +62,14 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   Page *FetchPgImp(page_id_t page_id) override;
 
+  /**
+   * Fetch the requested page through an access strategy.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy, nullptr for a normal fetch
+   * @return the requested page
+   */
+  Page *FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -63,6 +78,33 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   bool UnpinPgImp(page_id_t page_id, bool is_dirty) override;
 
+  /**
+   * Fetch several pages: the ids are grouped by owning instance and every instance gets one batch.
+   * @param page_ids ids of the pages to fetch
+   * @param num_pages number of ids
+   * @param[out] pages the pinned pages, nullptr for those that could not be fetched
+   * @return number of pages fetched
+   */
+  size_t FetchPgsImp(const page_id_t *page_ids, size_t num_pages, Page **pages) override;
+
+  /**
+   * Unpin several pages, one batch per owning instance.
+   * @param page_ids ids of the pages to unpin
+   * @param num_pages number of ids
+   * @param is_dirty true if the pages should be marked as dirty
+   * @return false if any page pin count was <= 0 before this call, true otherwise
+   */
+  bool UnpinPgsImp(const page_id_t *page_ids, size_t num_pages, bool is_dirty) override;
+
+  /**
+   * Sort a batch of page ids by owning instance (a counting sort, so the caller's order is kept within an instance).
+   * @param[out] grouped_ids the ids, instance 0's first
+   * @param[out] positions positions[j] is the index in page_ids of grouped_ids[j]
+   * @param[out] offsets instance i owns grouped_ids[offsets[i], offsets[i + 1])
+   */
+  void GroupByInstance(const page_id_t *page_ids, size_t num_pages, std::vector<page_id_t> *grouped_ids,
+                       std::vector<size_t> *positions, std::vector<size_t> *offsets);
+
   /**
    * Flushes the target page to disk.
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
@@ -77,6 +119,29 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   Page *NewPgImp(page_id_t *page_id) override;
 
+  /**
+   * Creates a new page through an access strategy.
+   * @param[out] page_id id of created page
+   * @param strategy the access strategy, nullptr for a normal allocation
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPgImp(page_id_t *page_id, BufferAccessStrategy *strategy) override;
+
+  /**
+   * Reserves an extent of contiguous pages on disk. Its pages spread over the instances like any other page ids.
+   * @param num_pages number of pages in the extent
+   * @return the first page of the extent
+   */
+  page_id_t AllocateExtentImp(size_t num_pages) override;
+
+  /**
+   * Creates a new page for an allocated page id in the instance that owns it.
+   * @param page_id id of the page
+   * @param strategy the access strategy, nullptr for a normal allocation
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPgAtImp(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -89,17 +154,58 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   void FlushAllPgsImp() override;
 
+  /**
+   * Start a page cleaner on every instance.
+   * @param config cleaner settings, applied to each instance separately
+   */
+  void RunPageCleaners(const PageCleanerConfig &config = PageCleanerConfig());
+
+  /** Stop the page cleaners of all instances. */
+  void StopPageCleaners();
+
+  /** @return foreground dirty-victim writes summed over all instances */
+  uint64_t GetForegroundWriteCount() const;
+
+  /** @return page cleaner writes summed over all instances */
+  uint64_t GetBackgroundWriteCount() const;
+
+  /** Prefetch through the parallel pool, so that chains may cross instances. */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids) override { prefetcher_.PrefetchPages(page_ids); }
+
+  void PrefetchChain(page_id_t page_id, size_t depth, next_page_fn next_page) override {
+    prefetcher_.PrefetchChain(page_id, depth, next_page);
+  }
+
+  size_t GetMaxPrefetchDepth() const override { return prefetcher_.GetMaxDepth(); }
+
+  /** @return number of pages fetched by the prefetcher */
+  uint64_t GetPrefetchCount() const { return prefetcher_.GetPrefetchCount(); }
+
+  /** Interleaves the instances' lists, so the hottest pages of every instance come first. */
+  std::vector<page_id_t> GetResidentPages() override;
+
+  /** @return occupancy, counters and latency histograms of every instance, in instance order */
+  std::vector<BufferPoolStats> GetInstanceStats();
+
+  /** @return the stats of all instances added up */
+  BufferPoolStats GetStats();
+
   /** List of latches. */
   std::vector<std::mutex *> latch_vector_;
 
   /* List of BufferPoolManager*/
-  std::vector<BufferPoolManager *> bufpoolIns_vector_;
+  std::vector<BufferPoolManagerInstance *> bufpoolIns_vector_;
   size_t num_instances_;
   size_t parallel_pool_size_;
   size_t each_pool_size_;
 
-  std::mutex latch_for_robin_;
-  size_t search_num_;
+  /** How page ids are mapped to instances. */
+  PageRouting routing_;
+  /** Instance the next NewPage starts its search at; bumped atomically, so allocating threads never serialize. */
+  std::atomic<size_t> next_instance_ = 0;
+
+  /** Reads pages ahead of scans; its thread starts with the first request. */
+  Prefetcher prefetcher_;
 
   // size_t starting_index;
 };
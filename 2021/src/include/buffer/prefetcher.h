@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// prefetcher.h
+//
+// Identification: src/include/buffer/prefetcher.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * Prefetcher reads pages into a buffer pool on a background thread, so that a scan finds them resident by the time
+ * it gets there.
+ *
+ * Requests are hints: they are dropped when the queue is full or the pool has no frame to spare. The worker loads
+ * pages through its own BULK_READ ring, so read-ahead neither pollutes the shared replacer nor warms up pages that
+ * are already resident. The ring holds as many frames as a chain may be deep, so a page read ahead is not recycled
+ * before the scan gets to it; deeper chains are cut short, and a pool too small to spare two frames for read-ahead
+ * gets none. The thread is started on the first request.
+ */
+class Prefetcher {
+ public:
+  /** Longest chain read ahead in one request, whatever the pool size. */
+  static constexpr size_t MAX_CHAIN_DEPTH = 64;
+
+  /**
+   * Creates a new Prefetcher.
+   * @param bpm the buffer pool to read pages into
+   * @param pool_size the number of frames in the pool
+   * @param max_queued the most requests waiting at any time; further requests are dropped
+   */
+  Prefetcher(BufferPoolManager *bpm, size_t pool_size, size_t max_queued = 256);
+
+  /** Stops the worker. */
+  ~Prefetcher();
+
+  DISALLOW_COPY_AND_MOVE(Prefetcher);
+
+  /**
+   * Queue pages to be read in. The pages must have been allocated.
+   * @param page_ids ids of the pages
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids);
+
+  /**
+   * Queue a chain of pages to be read in: page_id, then the page next_page names in it, and so on.
+   * @param page_id first page of the chain
+   * @param depth the number of pages to read, cut down to GetMaxDepth()
+   * @param next_page extracts the next page id from a read-latched page
+   */
+  void PrefetchChain(page_id_t page_id, size_t depth, BufferPoolManager::next_page_fn next_page);
+
+  /** Drop all queued requests and join the worker. Requests after this are ignored. */
+  void Stop();
+
+  /** @return the most pages read ahead per request: a quarter of the pool, 0 if that leaves less than two frames */
+  size_t GetMaxDepth() const { return max_depth_; }
+
+  /** @return number of pages the worker has fetched, whether they were already resident or not */
+  uint64_t GetPrefetchCount() const { return prefetched_; }
+
+ private:
+  struct Request {
+    page_id_t page_id_;
+    size_t depth_;
+    BufferPoolManager::next_page_fn next_page_;
+  };
+
+  /** Queue a request and start the worker if needed. Takes latch_. */
+  void Enqueue(Request request);
+
+  void WorkerLoop();
+
+  BufferPoolManager *bpm_;
+  size_t pool_size_;
+  size_t max_depth_;
+  size_t max_queued_;
+  std::atomic<uint64_t> prefetched_{0};
+  /** Only used by the worker thread. */
+  std::unique_ptr<BufferAccessStrategy> strategy_;
+
+  /** Protects queue_, stopped_ and thread_. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  std::deque<Request> queue_;
+  bool stopped_ = false;
+  std::thread *thread_ = nullptr;
+};
+
+}  // namespace bustub
@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_only_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/read_only_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ReadOnlyBufferPoolManager serves the pages of a memory-mapped, read-only DiskManager (see
+ * DiskManagerOptions::mmap_read_only_) without copying them: FetchPage returns a Page whose data is the page inside
+ * the mapping. There are no frames, no replacer and no evictions; the OS page cache decides which pages stay in
+ * memory, and MADV_SEQUENTIAL makes it read ahead of scans over contiguous pages.
+ *
+ * A page's view is created the first time the page is fetched and lives as long as the pool, about a cache line per
+ * page. Views pin and latch like buffer pool pages, so table heap and index code run on them unchanged, but their
+ * data must never be written: NewPage and DeletePage fail, unpinning a page dirty is a bug, and a write to the data
+ * faults.
+ */
+class ReadOnlyBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ReadOnlyBufferPoolManager.
+   * @param disk_manager a disk manager opened with mmap_read_only_; it must stay open while the pool is in use
+   */
+  explicit ReadOnlyBufferPoolManager(DiskManager *disk_manager);
+
+  /**
+   * Destroys an existing ReadOnlyBufferPoolManager.
+   */
+  ~ReadOnlyBufferPoolManager() override;
+
+  DISALLOW_COPY_AND_MOVE(ReadOnlyBufferPoolManager);
+
+  /** @return the number of pages in the mapping */
+  size_t GetPoolSize() override { return num_pages_; }
+
+  /**
+   * Ask the kernel to read the pages in the background, one madvise per run of adjacent pages.
+   * @param page_ids ids of the pages
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids) override;
+
+ protected:
+  /**
+   * Fetch the requested page: pin its view over the mapping.
+   * @param page_id id of page to be fetched
+   * @return the requested page, nullptr if the page lies outside the mapping
+   */
+  Page *FetchPgImp(page_id_t page_id) override;
+
+  /**
+   * Unpin the target page.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty must be false
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  bool UnpinPgImp(page_id_t page_id, bool is_dirty) override;
+
+  /**
+   * Nothing is ever dirty, so there is nothing to flush.
+   * @param page_id id of page to be flushed
+   * @return false if the page lies outside the mapping, true otherwise
+   */
+  bool FlushPgImp(page_id_t page_id) override;
+
+  /**
+   * A read-only pool cannot create pages.
+   * @return nullptr
+   */
+  Page *NewPgImp(page_id_t *page_id) override;
+
+  /**
+   * A read-only pool cannot delete pages.
+   * @return false
+   */
+  bool DeletePgImp(page_id_t page_id) override;
+
+  /**
+   * Nothing is ever dirty, so there is nothing to flush.
+   */
+  void FlushAllPgsImp() override {}
+
+ private:
+  DiskManager *disk_manager_;
+  /** Number of mapped pages, i.e. valid page ids. */
+  const page_id_t num_pages_;
+  /** The view of every page fetched so far, indexed by page id; installed once, never replaced. */
+  std::unique_ptr<std::atomic<Page *>[]> views_;
+};
+
+}  // namespace bustub
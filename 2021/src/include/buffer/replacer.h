@@ -12,10 +12,22 @@
 
 #pragma once
 
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+/** Replacement policies a buffer pool instance can be configured with. */
+enum class ReplacerPolicy {
+  /** Exact LRU over a latched list; the default. */
+  LRU,
+  /** CLOCK with per-frame atomic reference bits; no latch on Pin/Unpin. */
+  CLOCK,
+  /** LRU-2 with a correlated reference period; keeps pages touched by a single scan from evicting hot pages. */
+  LRU_K,
+};
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -43,6 +55,32 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Stops tracking a frame that goes back to the free list: it is not victimized, and whatever the policy remembers
+   * about the page it held is forgotten, so the next page loaded into it starts fresh.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
+  /**
+   * Pins several frames, the same as calling Pin on each of them in order. Replacers with a latch take it once.
+   * @param frame_ids the ids of the frames to pin
+   */
+  virtual void PinAll(const std::vector<frame_id_t> &frame_ids) {
+    for (frame_id_t frame_id : frame_ids) {
+      Pin(frame_id);
+    }
+  }
+
+  /**
+   * Look at the frames that Victim would hand out next, coldest first, without removing them. Unpinning a frame that
+   * is already tracked must not change its position, so callers may pin and unpin these frames behind the
+   * replacer's back without warming them up.
+   * @param max_frames the maximum number of frames to return
+   * @return up to max_frames victim candidates
+   */
+  virtual std::vector<frame_id_t> PeekVictims(size_t max_frames) = 0;
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
 };
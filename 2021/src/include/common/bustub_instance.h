@@ -23,7 +23,13 @@ namespace bustub {
 
 class BustubInstance {
  public:
-  explicit BustubInstance(const std::string &db_file_name) {
+  /**
+   * @param db_file_name the database file
+   * @param warm_up_file if not empty, the buffer pool is warmed up from this file before the instance is returned,
+   * and the resident page set is saved to it again on shutdown
+   */
+  explicit BustubInstance(const std::string &db_file_name, const std::string &warm_up_file = "")
+      : warm_up_file_(warm_up_file) {
     enable_logging = false;
 
     // storage related
@@ -33,6 +39,9 @@ class BustubInstance {
     log_manager_ = new LogManager(disk_manager_);
 
     buffer_pool_manager_ = new BufferPoolManagerInstance(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    if (!warm_up_file_.empty()) {
+      buffer_pool_manager_->WarmUp(warm_up_file_);
+    }
 
     // txn related
     lock_manager_ = new LockManager();
@@ -48,6 +57,9 @@ class BustubInstance {
     }
     delete checkpoint_manager_;
     delete log_manager_;
+    if (!warm_up_file_.empty()) {
+      buffer_pool_manager_->DumpResidentPages(warm_up_file_);
+    }
     delete buffer_pool_manager_;
     delete lock_manager_;
     delete transaction_manager_;
@@ -60,6 +72,8 @@ class BustubInstance {
   TransactionManager *transaction_manager_;
   LogManager *log_manager_;
   CheckpointManager *checkpoint_manager_;
+  /** Where the resident page set is loaded from at startup and saved to at shutdown, empty for neither. */
+  std::string warm_up_file_;
 };
 
 }  // namespace bustub
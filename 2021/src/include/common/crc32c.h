@@ -0,0 +1,38 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.h
+//
+// Identification: src/include/common/crc32c.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Compute the CRC32C (Castagnoli) checksum of a buffer, the CRC used by iSCSI, ext4 and most storage engines. On
+ * x86-64 CPUs with SSE4.2 and on ARMv8 with the CRC extension it runs on the CPU's CRC instructions, elsewhere on
+ * slicing-by-8 tables.
+ * @param data the buffer
+ * @param size number of bytes
+ * @param crc the checksum of the data that comes before this buffer, 0 for none; Crc32c(b, m, Crc32c(a, n)) is the
+ * checksum of a followed by b
+ * @return the checksum
+ */
+uint32_t Crc32c(const char *data, size_t size, uint32_t crc = 0);
+
+/** Crc32c on the slicing-by-8 tables only, whatever the CPU supports. */
+uint32_t Crc32cSoftware(const char *data, size_t size, uint32_t crc = 0);
+
+/** @return true if Crc32c runs on CRC instructions */
+bool Crc32cIsHardwareAccelerated();
+
+}  // namespace bustub
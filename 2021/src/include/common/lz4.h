@@ -0,0 +1,42 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz4.h
+//
+// Identification: src/include/common/lz4.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * Compress a buffer into the LZ4 block format, so that any LZ4 implementation can decompress it. This is one greedy
+ * pass over a 4K-entry hash table, the same trade-off as LZ4's fast mode: a fair ratio on repetitive data such as
+ * table pages, and quick to give up on data that does not compress.
+ * @param src the data
+ * @param size number of bytes
+ * @param dst where the compressed block goes
+ * @param capacity size of dst
+ * @return the compressed size, or 0 if it does not fit into capacity
+ */
+size_t Lz4Compress(const char *src, size_t size, char *dst, size_t capacity);
+
+/**
+ * Decompress an LZ4 block. Malformed input is detected, never read or written past the buffers.
+ * @param src the compressed block
+ * @param size its size
+ * @param dst where the data goes
+ * @param capacity size of dst
+ * @param[out] decompressed_size number of bytes written to dst
+ * @return false if the block is malformed or does not fit into capacity
+ */
+bool Lz4Decompress(const char *src, size_t size, char *dst, size_t capacity, size_t *decompressed_size);
+
+}  // namespace bustub
@@ -13,9 +13,11 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>  // NOLINT
 #include <future>              // NOLINT
 #include <mutex>               // NOLINT
+#include <thread>              // NOLINT
 
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
@@ -25,6 +27,15 @@ namespace bustub {
 /**
  * LogManager maintains a separate thread that is awakened whenever the log buffer is full or whenever a timeout
  * happens. When the thread is awakened, the log buffer's content is written into the disk log file.
+ *
+ * Appends only take the latch to reserve their LSN and their bytes in the log buffer, and serialize the record after
+ * letting go of it, so appends from many threads overlap. The log is double buffered: the flush thread swaps the two
+ * buffers, waits for the appends still copying into the one it took, and writes it out with one DiskManager::WriteLog
+ * while new records go into the other.
+ *
+ * Commits wait for their records with Flush. A waiting commit wakes the flush thread at once, and every commit that
+ * comes in while a write is under way is written, and synced, by the next one: with many committing transactions,
+ * each sync makes a whole group of them durable.
  */
 class LogManager {
  public:
@@ -32,9 +43,12 @@ class LogManager {
       : next_lsn_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
     log_buffer_ = new char[LOG_BUFFER_SIZE];
     flush_buffer_ = new char[LOG_BUFFER_SIZE];
+    buffers_[0] = log_buffer_;
+    buffers_[1] = flush_buffer_;
   }
 
   ~LogManager() {
+    StopFlushThread();
     delete[] log_buffer_;
     delete[] flush_buffer_;
     log_buffer_ = nullptr;
@@ -46,29 +60,61 @@ class LogManager {
 
   lsn_t AppendLogRecord(LogRecord *log_record);
 
+  /**
+   * Block until every log record up to and including lsn is on disk. Without a flush thread the caller writes the
+   * log itself.
+   * @param lsn the last record to wait for; past the last record appended, wait for all of them
+   */
+  void Flush(lsn_t lsn);
+
   inline lsn_t GetNextLSN() { return next_lsn_; }
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
   inline char *GetLogBuffer() { return log_buffer_; }
 
  private:
-  // TODO(students): you may add your own member variables
+  /**
+   * Swap the buffers and write out the records appended so far, if there are any. Called by the flush thread, or by
+   * Flush and AppendLogRecord when it is not running.
+   */
+  void FlushLogBuffer();
+
+  /** @return the number of appends copying into a buffer */
+  std::atomic<int> &CopiesInto(const char *buffer) { return buffer == buffers_[0] ? copies_[0] : copies_[1]; }
 
   /** The atomic counter which records the next log sequence number. */
   std::atomic<lsn_t> next_lsn_;
   /** The log records before and including the persistent lsn have been written to disk. */
   std::atomic<lsn_t> persistent_lsn_;
 
+  /** The buffer appends go to, and the one the flush thread writes out; they trade places with every write. */
   char *log_buffer_;
   char *flush_buffer_;
+  /** The two buffers by index, for copies_. */
+  char *buffers_[2];
+  /** Per buffer, the appends that reserved their bytes in it and have not finished copying. */
+  std::atomic<int> copies_[2] = {0, 0};
 
+  /** Protects the fields below, the LSN counter and the buffer pointers. */
   std::mutex latch_;
+  /** Bytes reserved in log_buffer_, and the LSN of the last record among them. */
+  int log_buffer_bytes_ = 0;
+  lsn_t log_buffer_lsn_ = INVALID_LSN;
+  /** A thread is waiting for a write: a commit, or an append that found no room. */
+  bool flush_requested_ = false;
+  bool stop_ = false;
+
+  /** Serializes writers of the log; the buffers only trade places under it. */
+  std::mutex flush_latch_;
 
-  std::thread *flush_thread_ __attribute__((__unused__));
+  std::thread *flush_thread_ = nullptr;
 
+  /** Wakes the flush thread. */
   std::condition_variable cv_;
+  /** Wakes threads waiting for a write to finish or for room in the log buffer. */
+  std::condition_variable flushed_cv_;
 
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
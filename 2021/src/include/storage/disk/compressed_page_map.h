@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_map.h
+//
+// Identification: src/include/storage/disk/compressed_page_map.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * CompressedPageMap decides where in the db file each compressed page goes, and remembers it.
+ *
+ * The file is carved into slots of whole sectors, one page per slot, so a page that compresses to 1.2 KB takes up
+ * 1.5 KB. A page that is written again goes to a new slot, and its old slot is only retired: it becomes free once a
+ * copy of the map that no longer points to it has been saved (see Encode and ReleaseRetired). That way the last saved
+ * map and every slot it points to stay intact whatever a crash interrupts. Free space is kept as extents, merged with
+ * their neighbours, and handed out best fit.
+ *
+ * Not thread safe; DiskManager serializes access.
+ */
+class CompressedPageMap {
+ public:
+  /** Granularity of slots in the db file. */
+  static constexpr uint32_t SECTOR_SIZE = 512;
+  static_assert(PAGE_SIZE % SECTOR_SIZE == 0 && PAGE_SIZE < (1 << 16), "a page length has to fit an entry");
+
+  /** Where a page is stored. */
+  struct Location {
+    /** Byte offset in the db file. */
+    uint64_t offset_;
+    /** Number of bytes stored, PAGE_SIZE for a page kept uncompressed, 0 for a page that was never written. */
+    uint32_t length_;
+
+    bool operator==(const Location &other) const { return offset_ == other.offset_ && length_ == other.length_; }
+    bool operator!=(const Location &other) const { return !(*this == other); }
+  };
+
+  /** @return where a page is stored */
+  Location Find(page_id_t page_id) const;
+
+  /**
+   * Pick a free slot for a page.
+   * @param length number of bytes to store
+   * @return byte offset of the slot
+   */
+  uint64_t Reserve(uint32_t length);
+
+  /**
+   * Pick a free slot for a page that lies before a given offset, to move the page there.
+   * @param length number of bytes to store
+   * @param limit the slot has to end at or before this byte offset
+   * @param[out] offset byte offset of the slot
+   * @return false if there is no such slot
+   */
+  bool ReserveBefore(uint32_t length, uint64_t limit, uint64_t *offset);
+
+  /** @return the stored pages and their locations, the one furthest into the file first */
+  std::vector<std::pair<page_id_t, Location>> GetPagesFromEnd() const;
+
+  /** Give back a slot that was reserved but not published, e.g. after a failed write. */
+  void Unreserve(uint64_t offset, uint32_t length);
+
+  /** Point a page to the slot it was just written to, and retire its old slot. */
+  void Publish(page_id_t page_id, uint64_t offset, uint32_t length);
+
+  /** Forget a page, e.g. because it was deallocated, and retire its slot. */
+  void Remove(page_id_t page_id);
+
+  /**
+   * @param[out] num_retired the number of slots retired so far, which the encoded map no longer points to
+   * @return the map as saved: one entry per page id, the offset in sectors above the low 16 bits of length
+   */
+  std::vector<uint64_t> Encode(size_t *num_retired) const;
+
+  /** Free the first num_retired retired slots, once the map Encode returned with them is saved. */
+  void ReleaseRetired(size_t num_retired);
+
+  /** Replace the map with a saved one. Every slot the saved map does not point to is free. */
+  void Decode(std::vector<uint64_t> entries);
+
+  /**
+   * Drop the free space at the end of the file.
+   * @return the new size of the file in bytes
+   */
+  uint64_t Truncate();
+
+  /** @return one past the highest page id that was ever stored */
+  page_id_t GetNumPages() const { return static_cast<page_id_t>(entries_.size()); }
+
+  /** @return the number of retired slots waiting for the map to be saved */
+  size_t GetNumRetired() const { return retired_.size(); }
+
+  /** @return the number of bytes of all pages as stored, without the slack in their slots */
+  uint64_t GetStoredBytes() const { return stored_bytes_; }
+
+  /** @return the size the db file needs, in bytes */
+  uint64_t GetFileBytes() const { return end_sector_ * SECTOR_SIZE; }
+
+ private:
+  static uint64_t SectorsFor(uint32_t length) { return (length + SECTOR_SIZE - 1) / SECTOR_SIZE; }
+
+  /** Add an extent of sectors to the free space, merging it with its neighbours. */
+  void Free(uint64_t sector, uint64_t num_sectors);
+
+  /** Take an extent out of both free space indexes. */
+  void TakeFree(std::map<uint64_t, uint64_t>::iterator it);
+
+  /** Encoded entries, indexed by page id; 0 for a page that is not stored. */
+  std::vector<uint64_t> entries_;
+  /** Slots no longer pointed to, as (sector, number of sectors), oldest first. */
+  std::vector<std::pair<uint64_t, uint64_t>> retired_;
+  /** Free extents by first sector, and by (size, first sector) for best fit. */
+  std::map<uint64_t, uint64_t> free_by_sector_;
+  std::set<std::pair<uint64_t, uint64_t>> free_by_size_;
+  /** The sectors from here on have never been handed out. */
+  uint64_t end_sector_ = 0;
+  uint64_t stored_bytes_ = 0;
+};
+
+}  // namespace bustub
@@ -12,27 +12,140 @@
 
 #pragma once
 
+#include <sys/uio.h>
+
 #include <atomic>
-#include <fstream>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <functional>
 #include <future>  // NOLINT
-#include <mutex>   // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/compressed_page_map.h"
+#include "storage/disk/io_uring.h"
+#include "storage/disk/tablespace.h"
 
 namespace bustub {
 
+/**
+ * How a DiskManager does its page I/O.
+ */
+struct DiskManagerOptions {
+  /** Carry asynchronous requests through an io_uring when the kernel has one; false to always do them synchronously. */
+  bool use_io_uring_ = true;
+  /**
+   * Open the db file with O_DIRECT, so pages bypass the OS page cache and the buffer pool is the only copy in memory.
+   * Falls back to buffered I/O where the file system refuses O_DIRECT (e.g. tmpfs).
+   */
+  bool direct_io_ = false;
+  /**
+   * Open an existing db file read-only and map it into memory, e.g. for a reporting copy of the database. Pages can
+   * then be used in place through GetMappedPage instead of being copied into buffer pool frames. Writes fail, and
+   * direct_io_ is ignored: the mapping is the OS page cache.
+   */
+  bool mmap_read_only_ = false;
+  /**
+   * Stamp a CRC32C into the trailer of every page written (see PAGE_USABLE_SIZE) and check pages against it when they
+   * are read back. Costs a copy of every page written and a pass over every page read, so it is off by default.
+   */
+  bool checksums_ = false;
+  /**
+   * Store pages LZ4 compressed. A db file has to be opened with the same setting every time. direct_io_ is ignored,
+   * and the file cannot be opened with mmap_read_only_.
+   */
+  bool compress_pages_ = false;
+  /**
+   * More files to stripe the pages over, e.g. one on each device. The db file is always the first file and keeps
+   * naming the log and the side files. Empty (the default) keeps every page in the db file. A striped db has to be
+   * opened with the same files in the same order, layout and stripe size every time. It cannot be compressed or
+   * mapped read-only.
+   */
+  std::vector<std::string> stripe_files_;
+  /** How page ids are spread over the db file and stripe_files_. */
+  StripeLayout stripe_layout_ = StripeLayout::ROUND_ROBIN;
+  /** Page ids per stripe: per turn with ROUND_ROBIN, per file (but the last) with RANGE. */
+  page_id_t stripe_pages_ = Tablespace::DEFAULT_STRIPE_PAGES;
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are read and written with positional pread/pwrite on one file descriptor, so there is no shared cursor or
+ * stream buffer and I/O on different pages runs in parallel. A written page is handed to the OS but not forced to
+ * the device; Sync() is the durability barrier.
+ *
+ * Pages can also be read and written asynchronously: SubmitRead / SubmitWrite queue a request and Poll completes
+ * requests and runs their callbacks. On Linux the requests go through an io_uring, so many of them can be in flight
+ * at once; where io_uring is unavailable a request is carried out synchronously at submission and only its callback
+ * waits for Poll.
+ *
+ * DiskManager also decides which page ids are in use. An allocation bitmap, one bit per page, lets freed pages be
+ * handed out again and lets Shrink give trailing free space back to the file system. The bitmap is kept in a side
+ * file next to the db file (<name>.fsm) and written there by Sync and ShutDown, so it is as durable as the pages
+ * themselves: pages allocated after the last Sync may be handed out again after a crash. A db file without a
+ * readable map, e.g. one written by an older version, has all of its pages considered allocated.
+ *
+ * With direct I/O every transfer needs a buffer aligned to DIRECT_IO_ALIGNMENT; buffer pool frames always are. Any
+ * other buffer is copied through an aligned per-thread bounce buffer, and asynchronous requests on such buffers are
+ * carried out synchronously.
+ *
+ * With checksums_ every page is written with a CRC32C of its contents in its last PAGE_CHECKSUM_SIZE bytes, and every
+ * page read is checked against it and has the trailer cleared, so torn writes and bit rot show up at the next read
+ * instead of as a corrupted page structure much later. The checksum is taken over a private copy of the page, which is
+ * what gets written: a frame changed during the write cannot leave a checksum of other bytes behind, and since the
+ * checksum reaches the disk in the same write as the page, a crash leaves no stale ones. Neither path takes a latch. A
+ * page with a zero trailer, e.g. one written with checksums off, is not checked; a page rewritten with checksums off
+ * keeps whatever its trailer held, so a db file should keep the setting it was created with. A mismatch is logged,
+ * counted and remembered (GetCorruptPages); asynchronous reads also report it to their callback.
+ *
+ * In read-only mode the db file is mapped with MAP_SHARED and MADV_SEQUENTIAL, so the kernel reads ahead of a scan
+ * and drops the pages behind it. The mapping covers the file as it was when it was opened. No log file is created,
+ * and the allocation map is read but never written.
+ *
+ * With compress_pages_ every page is LZ4 compressed on its way to the db file and decompressed on its way back, so
+ * the buffer pool above sees plain pages. Pages are packed into sector-sized slots (see CompressedPageMap) whose
+ * locations are kept in a side file (<name>.cpm); a page that does not shrink by at least a sector is stored as is.
+ * A rewritten page moves to a new slot, and its old slot is reused only after the next save of the page map: Sync,
+ * ShutDown, or once PAGE_MAP_SAVE_INTERVAL slots wait for it. After a crash every page reads back as it was at the
+ * last save. Asynchronous requests and batched reads are carried out one page at a time.
+ *
+ * With stripe_files_ the pages are spread over several files (see Tablespace), and every read and write goes to the
+ * file that holds the page. Batched reads are split where a run of pages crosses into another file, and the pieces
+ * go into the ring together, so with one file per device all of the devices work on a batch at once. The layout is
+ * recorded in a side file (<name>.tbs), and opening the files with another layout fails instead of mixing up pages.
  */
 class DiskManager {
  public:
+  /** Maps a page id to the allocation partition that owns it, see SetAllocationPartitions. */
+  using page_partition_fn = std::function<uint32_t(page_id_t page_id)>;
+
+  /** Called when an asynchronous request completes; ok is false if the I/O failed. */
+  using io_callback_fn = std::function<void(bool ok)>;
+
+  /** Most asynchronous requests in flight at once. */
+  static constexpr unsigned ASYNC_QUEUE_DEPTH = 128;
+
+  /** With compression, the page map is saved whenever this many slots wait to be reused. */
+  static constexpr size_t PAGE_MAP_SAVE_INTERVAL = 1024;
+
+  /** Buffer and file offset alignment for direct I/O; covers devices with 512 byte and 4 KB logical blocks. */
+  static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+  static_assert(PAGE_SIZE % DIRECT_IO_ALIGNMENT == 0, "direct I/O needs page-aligned file offsets");
+
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param options io_uring, direct I/O and read-only settings
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, const DiskManagerOptions &options = DiskManagerOptions());
 
   ~DiskManager() = default;
 
@@ -48,6 +161,11 @@ class DiskManager {
    */
   void WritePage(page_id_t page_id, const char *page_data);
 
+  /**
+   * Force every page written so far to stable storage.
+   */
+  void Sync();
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
@@ -56,7 +174,150 @@ class DiskManager {
   void ReadPage(page_id_t page_id, char *page_data);
 
   /**
-   * Flush the entire log buffer into disk.
+   * Read several pages. Each run of pages that are adjacent on disk is read with a single preadv, so pass the pages
+   * in page id order.
+   * @param page_ids ids of the pages
+   * @param[out] page_data one output buffer per page
+   * @param num_pages number of pages
+   */
+  void ReadPages(const page_id_t *page_ids, char *const *page_data, size_t num_pages);
+
+  /**
+   * Queue a page read. The request reaches the disk with the next Poll (or when the queue is full).
+   * @param page_id id of the page
+   * @param[out] page_data output buffer; must stay valid until the callback has run
+   * @param callback run by Poll once the page is in page_data
+   */
+  void SubmitRead(page_id_t page_id, char *page_data, io_callback_fn callback);
+
+  /**
+   * Queue a page write, see SubmitRead.
+   * @param page_id id of the page
+   * @param page_data raw page data; must stay valid and unchanged until the callback has run
+   * @param callback run by Poll once the page is written
+   */
+  void SubmitWrite(page_id_t page_id, const char *page_data, io_callback_fn callback);
+
+  /**
+   * Send the queued requests to the disk, wait until at least min_completions requests have completed (or none is
+   * left in flight), and run the callbacks of all completed requests on the calling thread. Callbacks may submit new
+   * requests. With several threads polling, a thread may run callbacks of requests another thread submitted.
+   * @param min_completions number of completions to wait for
+   * @return number of callbacks run
+   */
+  size_t Poll(size_t min_completions = 0);
+
+  /** @return the number of asynchronous requests submitted and not yet completed by Poll */
+  size_t GetNumPending();
+
+  /** @return true if asynchronous requests go through io_uring */
+  bool UsesIoUring() const { return ring_ != nullptr; }
+
+  /** @return true if the db file was opened with O_DIRECT */
+  bool UsesDirectIo() const { return direct_io_; }
+
+  /** @return true if pages are checksummed */
+  bool UsesChecksums() const { return checksums_; }
+
+  /**
+   * Read a page from the db file without counting it and check it against its checksum, e.g. for a scrubber. A
+   * mismatch is read again and only reported if it reads back the same, so a page written while it is being checked is
+   * skipped rather than reported.
+   * @param page_id id of the page
+   * @return false if the page does not match its checksum or cannot be read; true otherwise, including for pages
+   * without a checksum and free pages
+   */
+  bool VerifyPage(page_id_t page_id);
+
+  /** @return the number of checksum mismatches reads and VerifyPage found so far */
+  uint64_t GetNumChecksumFailures() const { return checksum_failures_; }
+
+  /** @return the pages that failed their checksum and were not written again since, in page id order */
+  std::vector<page_id_t> GetCorruptPages();
+
+  /** @return one past the highest page id that is or was allocated; every allocated page lies below it */
+  page_id_t GetPageIdLimit();
+
+  /** @return true if pages are stored compressed */
+  bool UsesCompression() const { return compress_; }
+
+  /** @return the number of bytes all pages take up compressed, 0 without compression */
+  uint64_t GetNumStoredBytes();
+
+  /** @return how pages are spread over the db's files */
+  const Tablespace &GetTablespace() const { return tablespace_; }
+
+  /** @return true if the db file is mapped read-only */
+  bool IsReadOnly() const { return read_only_; }
+
+  /** @return the number of pages the read-only mapping covers, 0 if there is none */
+  page_id_t GetNumMappedPages() const { return mapped_pages_; }
+
+  /**
+   * @param page_id id of the page
+   * @return the page inside the read-only mapping, valid until ShutDown; nullptr if the page is not mapped. Writing
+   * to it faults.
+   */
+  const char *GetMappedPage(page_id_t page_id) const {
+    return page_id >= 0 && page_id < mapped_pages_ ? mapping_ + static_cast<size_t>(page_id) * PAGE_SIZE : nullptr;
+  }
+
+  /**
+   * Ask the kernel to start reading a run of mapped pages in the background. Does nothing without a mapping.
+   * @param page_id the first page of the run
+   * @param num_pages number of pages; the run is cut off at the end of the mapping
+   */
+  void AdviseWillNeed(page_id_t page_id, size_t num_pages);
+
+  /**
+   * Split page allocation into partitions, each handing out only the page ids partition_of maps to it. A parallel
+   * buffer pool uses one partition per instance so that every instance allocates pages it owns. All pools sharing a
+   * disk manager must agree on the partitioning; the last call wins.
+   * @param num_partitions number of partitions
+   * @param partition_of the partition of each page id, in [0, num_partitions)
+   */
+  void SetAllocationPartitions(uint32_t num_partitions, page_partition_fn partition_of);
+
+  /**
+   * Allocate a page: the most recently freed page of the partition if there is one, otherwise the partition's next
+   * page id that is not allocated yet. Amortized O(1) for a fixed number of partitions.
+   * @param partition the partition to allocate from
+   * @return the id of the allocated page
+   */
+  page_id_t AllocatePage(uint32_t partition = 0);
+
+  /**
+   * Allocate an extent: num_pages contiguous page ids, all past the last page allocated so far, regardless of
+   * partitions. Pages of an extent freed later go back to the free lists of their partitions one by one.
+   * @param num_pages number of pages
+   * @return the first page of the extent
+   */
+  page_id_t AllocateExtent(size_t num_pages);
+
+  /**
+   * Mark a page as free so that its partition can hand it out again. Freeing a page that is not allocated does
+   * nothing. The page's contents stay on disk until it is reused or Shrink punches it out.
+   * @param page_id id of the page
+   */
+  void DeallocatePage(page_id_t page_id);
+
+  /** @return true if page_id is allocated */
+  bool IsAllocated(page_id_t page_id);
+
+  /** @return the number of allocated pages */
+  size_t GetNumAllocatedPages();
+
+  /**
+   * Give free space back to the file system: truncate the db file after the last allocated page and punch holes
+   * (where the file system supports it) over runs of free pages before it. Pages that were written without ever
+   * being allocated are lost if they lie past the last allocated page. A compressed db file is compacted instead:
+   * the pages at its end move into free space before them, and the file is cut off after the last one.
+   * @return the number of pages the db file spans afterwards
+   */
+  page_id_t Shrink();
+
+  /**
+   * Append a log buffer to the log file and force it to the device. Calls must not overlap.
    * @param log_data raw log data
    * @param size size of log entry
    */
@@ -80,6 +341,9 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of page reads */
+  int GetNumReads() const;
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -90,19 +354,202 @@ class DiskManager {
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
  private:
+  /** One asynchronous request: a run of pages adjacent in one file, starting at page_id_. */
+  struct AsyncRequest {
+    bool write_;
+    page_id_t page_id_;
+    std::vector<iovec> iov_;
+    io_callback_fn callback_;
+    int result_;
+    /** With checksums, the stamped copies a write hands to the ring; kept with the slot for the next write. */
+    std::unique_ptr<char, decltype(&std::free)> copies_{nullptr, &std::free};
+    size_t num_copies_ = 0;
+  };
+
   int GetFileSize(const std::string &file_name);
-  // stream to write log file
-  std::fstream log_io_;
+
+  /** Open and map the db file for mmap_read_only_. */
+  void OpenReadOnly();
+
+  /**
+   * Open every data file with the same flags.
+   * @return false, with all of them closed and errno set, if one cannot be opened
+   */
+  bool OpenDataFiles(int flags);
+
+  /** @return the number of pages the data files span, in page ids */
+  page_id_t GetDataPages();
+
+  /**
+   * Check the layout of an existing db against its side file, or record the layout of a new one.
+   * @param file_pages number of pages the data files span; 0 for a new db
+   */
+  void CheckTablespace(page_id_t file_pages);
+
+  /**
+   * Load the allocation map from the side file, or, if there is none or it does not match, mark every page of the
+   * db file as allocated.
+   * @param file_pages number of pages the db file spans; 0 for a new file, whose stale map (if any) is ignored
+   */
+  void LoadAllocationMap(page_id_t file_pages);
+
+  /** Write the allocation map to the side file if it changed since the last write. */
+  void SaveAllocationMap();
+
+  /**
+   * Copy a page about to be written and stamp the copy's trailer with its checksum.
+   * @param[out] copy an aligned page-sized buffer
+   */
+  static void StampChecksum(const char *page_data, char *copy);
+
+  /**
+   * Check a page that was just read against the checksum in its trailer, and clear the trailer. A mismatch is counted,
+   * logged and remembered.
+   * @return false on a mismatch
+   */
+  bool CheckPage(page_id_t page_id, char *page_data);
+
+  /** Count, log and remember a page that failed its checksum. */
+  void ReportCorruptPage(page_id_t page_id);
+
+  /** Drop a page that was written again or freed from the corrupt pages. */
+  void ForgetCorruptPage(page_id_t page_id);
+
+  /**
+   * Load the page map of a compressed db file.
+   * @param file_bytes size of the db file; 0 for a new file, which gets an empty map
+   * @return number of pages the map knows of
+   */
+  page_id_t LoadPageMap(off_t file_bytes);
+
+  /**
+   * Force the db file to the device and then write the page map to its side file, if it changed since the last write.
+   * Frees the slots retired before the map was taken.
+   * @param min_retired do nothing unless at least this many slots are retired
+   */
+  void SavePageMap(size_t min_retired = 0);
+
+  /** Compress a page into a new slot and publish it. @return false on an I/O error */
+  bool WriteCompressedPage(page_id_t page_id, const char *page_data);
+
+  /**
+   * Move the pages at the end of a compressed db file into free space before them, save the page map and cut off the
+   * free space at the end.
+   */
+  void CompactPages();
+
+  /** Read and decompress a page; a page never written reads as zeros. @return false on an I/O error or bad data */
+  bool ReadCompressedPage(page_id_t page_id, char *page_data);
+
+  /** Rebuild the partitions' free lists from the bitmap. The caller holds alloc_latch_. */
+  void ResetAllocationPartitions();
+
+  bool IsSet(page_id_t page_id) const {
+    return page_id < map_pages_ && (allocated_[page_id / 8] & (1U << (page_id % 8))) != 0;
+  }
+
+  /** Set or clear a page's bit, growing the bitmap as needed. The caller holds alloc_latch_. */
+  void SetAllocated(page_id_t page_id, bool allocated);
+
+  uint32_t PartitionOf(page_id_t page_id) const { return partition_of_ ? partition_of_(page_id) : 0; }
+
+  /** @return true if buf can be handed to the db file as is */
+  bool CanTransfer(const char *buf) const {
+    return !direct_io_ || reinterpret_cast<uintptr_t>(buf) % DIRECT_IO_ALIGNMENT == 0;
+  }
+
+  /** @return the descriptor and offset of a page */
+  std::pair<int, off_t> Locate(page_id_t page_id) const {
+    Tablespace::Location location = tablespace_.Locate(page_id);
+    return {db_fds_[location.file_], location.offset_};
+  }
+
+  /** pread / pwrite one page without counting it, through the bounce buffer if needed. @return false on an I/O error */
+  bool ReadPageData(page_id_t page_id, char *page_data);
+  bool WritePageData(page_id_t page_id, const char *page_data);
+
+  /**
+   * Queue a request for a run of pages adjacent in one file.
+   * @param page_id the first page of the run
+   * @param page_data the buffers of the run, one per page
+   */
+  void Submit(bool write, page_id_t page_id, char *const *page_data, size_t num_pages, io_callback_fn callback);
+
+  /**
+   * Check a request the ring completed and redo, one page at a time, whatever a short transfer left out (e.g. a
+   * read past the end of the file).
+   * @return false if the request failed
+   */
+  bool FinishRequest(const AsyncRequest &request);
+  /** Descriptor of the log file and the number of bytes in it; WriteLog calls do not overlap. */
+  int log_fd_ = -1;
+  off_t log_bytes_ = 0;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  /** The data files, db file first, and their descriptors; pread/pwrite need no latch. */
+  std::vector<std::string> data_files_;
+  std::vector<int> db_fds_;
+  Tablespace tablespace_;
+  /** The tablespace layout's side file. */
+  std::string tablespace_name_;
+  bool direct_io_ = false;
+  /** The read-only mapping of the db file and the number of pages it covers. */
+  bool read_only_ = false;
+  char *mapping_ = nullptr;
+  page_id_t mapped_pages_ = 0;
   std::string file_name_;
   int num_flushes_;
-  int num_writes_;
+  std::atomic<int> num_writes_;
+  std::atomic<int> num_reads_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
+
+  /** The ring behind the asynchronous requests, nullptr if they are carried out synchronously. */
+  std::unique_ptr<IoUring> ring_;
+  /** Protects the ring and everything below. Never held while a callback runs. */
+  std::mutex async_latch_;
+  /** Request slots, indexed by the ring's user_data; free_requests_ lists the unused ones. */
+  std::vector<AsyncRequest> requests_;
+  std::vector<uint32_t> free_requests_;
+  /** Requests handed to the ring whose completions have not been reaped yet. */
+  size_t in_flight_ = 0;
+  /** Requests already carried out synchronously (no ring, or unaligned direct I/O), waiting for Poll. */
+  std::deque<std::pair<io_callback_fn, bool>> completed_;
+  /** Requests submitted but not completed by Poll yet. */
+  size_t pending_ = 0;
+
+  /** The allocation map's side file. */
+  std::string map_name_;
+  /** Protects the allocation state below. */
+  std::mutex alloc_latch_;
+  /** Serializes writers of the side files; taken before alloc_latch_ and page_map_latch_. */
+  std::mutex map_write_latch_;
+  /** One bit per page id below map_pages_, set if the page is allocated. Pages past map_pages_ are free. */
+  std::vector<uint8_t> allocated_;
+  page_id_t map_pages_ = 0;
+  size_t num_allocated_ = 0;
+  bool map_dirty_ = false;
+  uint32_t num_partitions_ = 1;
+  page_partition_fn partition_of_;
+  /**
+   * Per partition: a growth cursor, and a stack of the partition's free pages below the cursor. Pages at or
+   * past the cursor are not listed; the cursor finds the free ones as it moves on.
+   */
+  std::vector<page_id_t> next_unseen_;
+  std::vector<std::vector<page_id_t>> free_pages_;
+
+  bool checksums_ = false;
+  /** Protects corrupt_pages_. Only taken once a page has failed its checksum. */
+  std::mutex corrupt_latch_;
+  std::set<page_id_t> corrupt_pages_;
+  std::atomic<uint64_t> checksum_failures_{0};
+
+  bool compress_ = false;
+  /** The page map's side file. */
+  std::string page_map_name_;
+  /** Protects page_map_ and page_map_dirty_. */
+  std::mutex page_map_latch_;
+  CompressedPageMap page_map_;
+  bool page_map_dirty_ = false;
 };
 
 }  // namespace bustub
@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring.h
+//
+// Identification: src/include/storage/disk/io_uring.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "common/macros.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace bustub {
+
+/**
+ * IoUring is a minimal io_uring instance: one submission and one completion queue, set up with the raw system calls
+ * so that there is no liburing dependency. It only knows vectored reads and writes.
+ *
+ * It is not thread safe; the owner serializes all calls.
+ */
+class IoUring {
+ public:
+  /**
+   * Set up a ring.
+   * @param entries submission queue size; the kernel rounds it up to a power of two
+   * @return the ring, or nullptr if io_uring is not available (old kernel, non-Linux build, seccomp filter, ...)
+   */
+  static std::unique_ptr<IoUring> Create(unsigned entries);
+
+  ~IoUring();
+
+  DISALLOW_COPY_AND_MOVE(IoUring);
+
+  /**
+   * Queue a vectored read. It reaches the kernel with the next Enter.
+   * @param fd file to read
+   * @param iov buffers to fill; must stay valid until the request completes
+   * @param num_iov number of buffers
+   * @param offset file offset of the first buffer
+   * @param user_data returned with the completion
+   * @return false if the submission queue is full
+   */
+  bool PrepareReadv(int fd, const iovec *iov, unsigned num_iov, off_t offset, uint64_t user_data);
+
+  /** Queue a vectored write, see PrepareReadv. */
+  bool PrepareWritev(int fd, const iovec *iov, unsigned num_iov, off_t offset, uint64_t user_data);
+
+  /**
+   * Hand the queued requests to the kernel and, optionally, wait for completions.
+   * @param min_completions block until at least this many completions are ready; the caller must make sure that
+   * many requests are in flight
+   * @return false if the kernel refused the call
+   */
+  bool Enter(unsigned min_completions);
+
+  /**
+   * Take the oldest completion off the completion queue.
+   * @param[out] user_data the user_data of the request
+   * @param[out] result bytes transferred, or -errno
+   * @return false if no completion is ready
+   */
+  bool NextCompletion(uint64_t *user_data, int *result);
+
+  /** @return the number of submission queue entries */
+  unsigned GetEntries() const { return sq_entries_; }
+
+ private:
+  IoUring() = default;
+
+  bool Prepare(uint8_t opcode, int fd, const iovec *iov, unsigned num_iov, off_t offset, uint64_t user_data);
+
+  int ring_fd_ = -1;
+  /** The mapped queues. With IORING_FEAT_SINGLE_MMAP both rings share one mapping and cq_ring_ == sq_ring_. */
+  void *sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void *cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  io_uring_sqe *sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  unsigned *sq_head_ = nullptr;
+  unsigned *sq_tail_ = nullptr;
+  unsigned *sq_array_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned sq_entries_ = 0;
+  unsigned *cq_head_ = nullptr;
+  unsigned *cq_tail_ = nullptr;
+  io_uring_cqe *cqes_ = nullptr;
+  unsigned cq_mask_ = 0;
+  /** Entries queued since the last Enter. */
+  unsigned to_submit_ = 0;
+};
+
+}  // namespace bustub
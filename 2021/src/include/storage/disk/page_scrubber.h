@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_scrubber.h
+//
+// Identification: src/include/storage/disk/page_scrubber.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <thread>              // NOLINT
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * Knobs for the background scrubber, see PageScrubber::Start.
+ */
+struct PageScrubberConfig {
+  /** How often the scrubber wakes up. */
+  std::chrono::milliseconds interval_{100};
+  /** Rate limit: the most pages the scrubber reads per wake-up. */
+  size_t pages_per_round_ = 64;
+  /** Run the thread at the lowest CPU priority and in the idle I/O class, so it only takes what nobody else wants. */
+  bool low_priority_ = true;
+};
+
+/**
+ * PageScrubber walks the db file in the background and checks every allocated page against its checksum, so that
+ * bit rot in pages nobody reads is found before a backup or a crash makes it matter.
+ *
+ * Pages resident in the buffer pool are skipped: they are hot, so a foreground read checks them soon enough, and
+ * their on-disk copy is about to be overwritten anyway. Corrupt pages are reported through DiskManager, see
+ * DiskManager::GetCorruptPages. One pass over the file takes GetPageIdLimit() / pages_per_round_ wake-ups.
+ */
+class PageScrubber {
+ public:
+  /**
+   * Creates a new PageScrubber.
+   * @param disk_manager the disk manager whose pages are checked
+   * @param bpm the buffer pool in front of it, whose resident pages are skipped; nullptr to check every page
+   */
+  explicit PageScrubber(DiskManager *disk_manager, BufferPoolManager *bpm = nullptr);
+
+  /** Stops the scrubber. */
+  ~PageScrubber();
+
+  DISALLOW_COPY_AND_MOVE(PageScrubber);
+
+  /**
+   * Start the background thread. Does nothing if it is already running.
+   * @param config scrub interval, rate limit and priority
+   */
+  void Start(const PageScrubberConfig &config = PageScrubberConfig());
+
+  /** Stop and join the background thread, if it is running. */
+  void Stop();
+
+  /**
+   * Check the next pages after where the last round stopped, wrapping around at the end of the file.
+   * @param max_pages the most pages to read
+   * @return number of pages read
+   */
+  size_t ScrubRound(size_t max_pages);
+
+  /** @return number of pages read so far */
+  uint64_t GetNumScrubbed() const { return scrubbed_; }
+
+  /** @return number of completed passes over the whole file */
+  uint64_t GetNumPasses() const { return passes_; }
+
+ private:
+  /** Move the calling thread to the lowest CPU and I/O priority, where the platform has them. */
+  static void LowerPriority();
+
+  DiskManager *disk_manager_;
+  BufferPoolManager *bpm_;
+  /** Next page to look at. Only used by ScrubRound, which is serialized by round_latch_. */
+  page_id_t cursor_ = 0;
+  std::mutex round_latch_;
+  std::atomic<uint64_t> scrubbed_{0};
+  std::atomic<uint64_t> passes_{0};
+
+  std::thread *thread_ = nullptr;
+  /** Protects running_ and wakes the scrubber up early on shutdown. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  bool running_ = false;
+};
+
+}  // namespace bustub
@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tablespace.h
+//
+// Identification: src/include/storage/disk/tablespace.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** How a tablespace spreads page ids over its files. */
+enum class StripeLayout : uint32_t {
+  /** Runs of stripe_pages page ids go to the files in turn, like RAID 0. */
+  ROUND_ROBIN = 0,
+  /** The first stripe_pages page ids go to the first file, the next stripe_pages to the second, and so on; the last
+   * file also takes every page id past that. */
+  RANGE = 1,
+};
+
+/**
+ * Tablespace maps page ids onto the files of a database, e.g. one file per device so that a large table is read from
+ * all of them at once. Every page id lives in exactly one file, at a page-aligned offset, and the pages of a file are
+ * packed: a file holds no gaps for the page ids of the others. With one file, page id p is page p of that file.
+ *
+ * Only the arithmetic lives here; DiskManager owns the files.
+ */
+class Tablespace {
+ public:
+  /** Page ids per stripe unless configured otherwise: 256 KB, the size of a table heap extent. */
+  static constexpr page_id_t DEFAULT_STRIPE_PAGES = 64;
+
+  /** Where a page is stored. */
+  struct Location {
+    /** Index of the file. */
+    uint32_t file_;
+    /** Byte offset in the file. */
+    off_t offset_;
+  };
+
+  /** A tablespace of one file. */
+  Tablespace() = default;
+
+  /**
+   * @param num_files number of files, at least one
+   * @param layout how page ids are spread over the files
+   * @param stripe_pages page ids per stripe, at least one
+   */
+  Tablespace(uint32_t num_files, StripeLayout layout, page_id_t stripe_pages);
+
+  uint32_t GetNumFiles() const { return num_files_; }
+  StripeLayout GetLayout() const { return layout_; }
+  page_id_t GetStripePages() const { return stripe_pages_; }
+
+  /** @return where a page is stored */
+  Location Locate(page_id_t page_id) const {
+    if (num_files_ == 1) {
+      return {0, static_cast<off_t>(page_id) * PAGE_SIZE};
+    }
+    page_id_t stripe = page_id / stripe_pages_;
+    if (layout_ == StripeLayout::RANGE) {
+      auto file = static_cast<uint32_t>(std::min(stripe, static_cast<page_id_t>(num_files_) - 1));
+      return {file, static_cast<off_t>(page_id - static_cast<page_id_t>(file) * stripe_pages_) * PAGE_SIZE};
+    }
+    auto file = static_cast<uint32_t>(stripe % num_files_);
+    page_id_t file_page = stripe / static_cast<page_id_t>(num_files_) * stripe_pages_ + page_id % stripe_pages_;
+    return {file, static_cast<off_t>(file_page) * PAGE_SIZE};
+  }
+
+  /**
+   * @param file index of the file
+   * @param file_page page number within the file
+   * @return the page id stored there
+   */
+  page_id_t GetPageId(uint32_t file, page_id_t file_page) const;
+
+  /** @return the number of page ids from page_id on that are stored one after another in the same file */
+  page_id_t GetRunLength(page_id_t page_id) const {
+    // the last file of a range layout holds everything past the others
+    bool last_range =
+        layout_ == StripeLayout::RANGE && page_id / stripe_pages_ >= static_cast<page_id_t>(num_files_) - 1;
+    if (num_files_ == 1 || last_range) {
+      return INT_MAX - page_id;
+    }
+    return stripe_pages_ - page_id % stripe_pages_;
+  }
+
+  /**
+   * @param file_pages the number of pages each file spans
+   * @return one past the highest page id the files hold
+   */
+  page_id_t GetPageIdLimit(const std::vector<page_id_t> &file_pages) const;
+
+  /**
+   * @param file index of the file
+   * @param limit a page id limit
+   * @return the number of pages a file spans if it holds every page id below limit and none past it
+   */
+  page_id_t GetFilePages(uint32_t file, page_id_t limit) const;
+
+ private:
+  uint32_t num_files_ = 1;
+  StripeLayout layout_ = StripeLayout::ROUND_ROBIN;
+  page_id_t stripe_pages_ = DEFAULT_STRIPE_PAGES;
+};
+
+}  // namespace bustub
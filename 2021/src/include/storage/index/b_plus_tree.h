@@ -10,10 +10,12 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <fstream>
 #include <queue>
 #include <string>
 #include <vector>
 
+#include "buffer/page_segment.h"
 #include "concurrency/transaction.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
@@ -116,6 +118,8 @@ class BPlusTree {
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  // new nodes come from the tree's own extents: buffer_pool_manager_->NewPage(&page_id, segment_)
+  PageSegment segment_;
 };
 
 }  // namespace bustub
@@ -18,6 +18,7 @@
 #include "common/config.h"
 #include "storage/index/int_comparator.h"
 #include "storage/page/hash_table_page_defs.h"
+#include "storage/page/page.h"
 
 namespace bustub {
 /**
@@ -12,26 +12,42 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <thread>  // NOLINT
 
 #include "common/config.h"
 #include "common/rwlatch.h"
 
 namespace bustub {
 
+/**
+ * The last PAGE_CHECKSUM_SIZE bytes of a page belong to the DiskManager, which keeps the page's checksum there on
+ * disk (see DiskManagerOptions::checksums_). Page layouts only use the PAGE_USABLE_SIZE bytes in front of them.
+ */
+static constexpr int PAGE_CHECKSUM_SIZE = 4;
+static constexpr int PAGE_USABLE_SIZE = PAGE_SIZE - PAGE_CHECKSUM_SIZE;
+
 /**
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The data itself is not part of the object. Buffer pool frames point into their FrameArena, which keeps all page
+ * data contiguous; the book-keeping of neighbouring frames is cache line aligned so that it never shares a line.
+ * The pages of a ReadOnlyBufferPoolManager point straight into the read-only mapping of the db file.
  */
-class Page {
+class alignas(64) Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManagerInstance;
+  friend class FrameArena;
+  friend class ReadOnlyBufferPoolManager;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor for a page outside any buffer pool. Allocates its own zeroed data. */
+  Page() : owned_data_(new char[PAGE_SIZE]), data_(owned_data_.get()) { ResetMemory(); }
 
   /** Default destructor. */
   ~Page() = default;
@@ -48,11 +64,19 @@ class Page {
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. The version turns odd until WUnlatch. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    // keep the writes to data_ that follow from becoming visible before the odd version
+    std::atomic_thread_fence(std::memory_order_release);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -60,11 +84,38 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Start an optimistic read: wait until no writer holds the latch and return the page version. Read the page
+   * without latching it, then check the copy with ValidateVersion.
+   * @return an even version
+   */
+  inline uint64_t StableVersion() const {
+    uint64_t version;
+    while (((version = version_.load(std::memory_order_acquire)) & 1) != 0) {
+      std::this_thread::yield();
+    }
+    return version;
+  }
+
+  /**
+   * Finish an optimistic read.
+   * @param version the version StableVersion returned before the read
+   * @return true if no writer latched the page since, i.e. everything read in between is consistent
+   */
+  inline bool ValidateVersion(uint64_t version) const {
+    // order the optimistic reads of data_ before the second version load
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
   /** Sets the page LSN. */
-  inline void SetLSN(lsn_t lsn) { memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t)); }
+  inline void SetLSN(lsn_t lsn) {
+    memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t));
+    has_lsn_ = true;
+  }
 
  protected:
   static_assert(sizeof(page_id_t) == 4);
@@ -75,19 +126,39 @@ class Page {
   static constexpr size_t OFFSET_LSN = 4;
 
  private:
-  /** Zeroes out the data that is held within the page. */
-  inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
-
+  /**
+   * Constructor for a buffer pool frame.
+   * @param data the frame's PAGE_SIZE bytes in the arena, already zeroed
+   */
+  explicit Page(char *data) : data_(data) {}
+
+  /** Zeroes out the data that is held within the page, which then carries no LSN. */
+  inline void ResetMemory() {
+    memset(data_, OFFSET_PAGE_START, PAGE_SIZE);
+    has_lsn_ = false;
+  }
+
+  /** Backs data_ for a page that is not a buffer pool frame. */
+  std::unique_ptr<char[]> owned_data_;
   /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  char *data_;
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /** The pin count of this page. Atomic because buffer pool hits pin pages without the instance latch. */
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
+  /** True while the buffer pool is reading or writing this frame; fetchers of the page wait for it to clear. */
+  std::atomic<bool> io_in_progress_ = false;
+  /**
+   * True once SetLSN stamped the page since it came into this frame. Only page types whose changes are logged
+   * (TablePage) carry an LSN; for the others the bytes at OFFSET_LSN are data, and the log need not go first.
+   */
+  std::atomic<bool> has_lsn_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Bumped by WLatch and WUnlatch, so it is odd while a writer holds the latch. Lets readers skip the latch. */
+  std::atomic<uint64_t> version_ = 0;
 };
 
 }  // namespace bustub
@@ -0,0 +1,231 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard.h
+//
+// Identification: src/include/storage/page/page_guard.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+
+/**
+ * BasicPageGuard owns one pin on a buffer pool page and unpins it when it is dropped or goes out of scope, so a
+ * forgotten UnpinPage can no longer leak a frame. Guards are move-only; a moved-from guard is empty.
+ */
+class BasicPageGuard {
+ public:
+  BasicPageGuard() = default;
+
+  /**
+   * @param bpm the buffer pool the page was fetched from
+   * @param page the pinned page, or nullptr for an empty guard
+   */
+  BasicPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+  BasicPageGuard(const BasicPageGuard &) = delete;
+  BasicPageGuard &operator=(const BasicPageGuard &) = delete;
+  BasicPageGuard(BasicPageGuard &&that) noexcept;
+  BasicPageGuard &operator=(BasicPageGuard &&that) noexcept;
+
+  ~BasicPageGuard() { Drop(); }
+
+  /** Unpin the page now, marking it dirty if it was modified through the guard. The guard becomes empty. */
+  void Drop();
+
+  /** @return true if the guard holds a page, false if the fetch failed or the guard was dropped or moved from */
+  explicit operator bool() const { return page_ != nullptr; }
+
+  /** @return the id of the guarded page */
+  page_id_t PageId() const { return page_->GetPageId(); }
+
+  /** @return the guarded page */
+  Page *GetPage() const { return page_; }
+
+  /** @return the page contents, read-only */
+  const char *GetData() const { return page_->GetData(); }
+
+  /** @return the page contents; the page is unpinned dirty */
+  char *GetDataMut() {
+    is_dirty_ = true;
+    return page_->GetData();
+  }
+
+  /**
+   * @return the page viewed as a Page subclass such as TablePage, for reading. Not a const pointer only because the
+   * page classes' accessors are not const.
+   */
+  template <class T>
+  T *As() const {
+    return reinterpret_cast<T *>(page_);
+  }
+
+  /** @return the page viewed as a Page subclass such as TablePage; the page is unpinned dirty */
+  template <class T>
+  T *AsMut() {
+    is_dirty_ = true;
+    return reinterpret_cast<T *>(page_);
+  }
+
+ private:
+  friend class ReadPageGuard;
+  friend class WritePageGuard;
+  friend class OptimisticPageGuard;
+
+  BufferPoolManager *bpm_ = nullptr;
+  Page *page_ = nullptr;
+  bool is_dirty_ = false;
+};
+
+/**
+ * ReadPageGuard holds a pin and the read latch of a page, and releases both, latch first, when dropped.
+ */
+class ReadPageGuard {
+ public:
+  ReadPageGuard() = default;
+
+  /**
+   * Takes the read latch of an already pinned page.
+   * @param bpm the buffer pool the page was fetched from
+   * @param page the pinned page, or nullptr for an empty guard
+   */
+  ReadPageGuard(BufferPoolManager *bpm, Page *page);
+
+  ReadPageGuard(ReadPageGuard &&that) noexcept = default;
+  ReadPageGuard &operator=(ReadPageGuard &&that) noexcept;
+
+  ~ReadPageGuard() { Drop(); }
+
+  /** Release the read latch and the pin now. The guard becomes empty. */
+  void Drop();
+
+  explicit operator bool() const { return static_cast<bool>(guard_); }
+
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  const char *GetData() const { return guard_.GetData(); }
+
+  template <class T>
+  T *As() const {
+    return guard_.As<T>();
+  }
+
+ private:
+  BasicPageGuard guard_;
+};
+
+/**
+ * WritePageGuard holds a pin and the write latch of a page, and releases both, latch first, when dropped. The page
+ * is unpinned dirty.
+ */
+class WritePageGuard {
+ public:
+  WritePageGuard() = default;
+
+  /**
+   * Takes the write latch of an already pinned page.
+   * @param bpm the buffer pool the page was fetched from
+   * @param page the pinned page, or nullptr for an empty guard
+   */
+  WritePageGuard(BufferPoolManager *bpm, Page *page);
+
+  WritePageGuard(WritePageGuard &&that) noexcept = default;
+  WritePageGuard &operator=(WritePageGuard &&that) noexcept;
+
+  ~WritePageGuard() { Drop(); }
+
+  /** Release the write latch and the pin now. The guard becomes empty. */
+  void Drop();
+
+  explicit operator bool() const { return static_cast<bool>(guard_); }
+
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  const char *GetData() const { return guard_.GetData(); }
+
+  char *GetDataMut() { return guard_.GetDataMut(); }
+
+  template <class T>
+  T *As() const {
+    return guard_.As<T>();
+  }
+
+  template <class T>
+  T *AsMut() {
+    return guard_.AsMut<T>();
+  }
+
+ private:
+  BasicPageGuard guard_;
+};
+
+/**
+ * OptimisticPageGuard holds a pin but no latch. Readers copy what they need out of the page and then call Validate;
+ * if a writer latched the page in between, the copy may be torn and the read must be retried after Restart. Readers
+ * never write to the latch's cache line, so concurrent traversals of hot pages (e.g. inner B+ tree nodes) do not
+ * bounce it between cores.
+ *
+ *   auto guard = bpm->FetchPageOptimistic(page_id);
+ *   do {
+ *     child = ReadChild(guard.GetData());
+ *   } while (!guard.Validate() && guard.Restart());
+ */
+class OptimisticPageGuard {
+ public:
+  OptimisticPageGuard() = default;
+
+  /**
+   * Records the version of an already pinned page, waiting for a current writer to finish.
+   * @param bpm the buffer pool the page was fetched from
+   * @param page the pinned page, or nullptr for an empty guard
+   */
+  OptimisticPageGuard(BufferPoolManager *bpm, Page *page);
+
+  OptimisticPageGuard(OptimisticPageGuard &&that) noexcept = default;
+  OptimisticPageGuard &operator=(OptimisticPageGuard &&that) noexcept = default;
+
+  ~OptimisticPageGuard() = default;
+
+  /** Release the pin now. The guard becomes empty. */
+  void Drop() { guard_.Drop(); }
+
+  explicit operator bool() const { return static_cast<bool>(guard_); }
+
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  const char *GetData() const { return guard_.GetData(); }
+
+  template <class T>
+  T *As() const {
+    return guard_.As<T>();
+  }
+
+  /** @return true if the page has not been write-latched since the guard was taken or last restarted */
+  bool Validate() const { return guard_.page_->ValidateVersion(version_); }
+
+  /**
+   * Record the current version again, waiting for a current writer to finish.
+   * @return true, so that it can end a retry loop condition
+   */
+  bool Restart() {
+    version_ = guard_.page_->StableVersion();
+    return true;
+  }
+
+ private:
+  BasicPageGuard guard_;
+  uint64_t version_ = 0;
+};
+
+}  // namespace bustub
@@ -13,6 +13,7 @@
 #pragma once
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/page_segment.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
 #include "storage/table/table_iterator.h"
@@ -22,7 +23,8 @@ namespace bustub {
 
 /**
  * TableHeap represents a physical table on disk.
- * This is just a doubly-linked list of pages.
+ * This is just a doubly-linked list of pages. New pages come from the table's own PageSegment, so the list mostly
+ * runs through contiguous extents even when several tables grow at once.
  */
 class TableHeap {
   friend class TableIterator;
@@ -36,9 +38,10 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param first_page_id the id of the first page
+   * @param extent_pages number of pages the table reserves at once for growing
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            page_id_t first_page_id);
+            page_id_t first_page_id, size_t extent_pages = PageSegment::DEFAULT_EXTENT_PAGES);
 
   /**
    * Create a table heap with a transaction. (create table)
@@ -46,18 +49,20 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param txn the creating transaction
+   * @param extent_pages number of pages the table reserves at once for growing
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            Transaction *txn);
+            Transaction *txn, size_t extent_pages = PageSegment::DEFAULT_EXTENT_PAGES);
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
+   * @param strategy access strategy of a bulk insert, or nullptr
    * @return true iff the insert is successful
    */
-  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
@@ -95,24 +100,53 @@ class TableHeap {
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
+   * @param strategy access strategy of a scan, or nullptr
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
-  /** @return the begin iterator of this table */
-  TableIterator Begin(Transaction *txn);
+  /**
+   * @param txn transaction performing the scan
+   * @param strategy access strategy for a large scan, e.g. BULK_READ; it must outlive the iterator
+   * @return the begin iterator of this table
+   */
+  TableIterator Begin(Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /** @return the end iterator of this table */
   TableIterator End();
 
+  /**
+   * Walk the page list and measure how scattered it is on disk.
+   * @return the fragmentation of the table in scan order
+   */
+  PageFragmentation GetFragmentation();
+
   /** @return the id of the first page of this table */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /**
+   * Set how many pages a sequential scan keeps in flight ahead of itself. The pool's GetMaxPrefetchDepth() caps it.
+   * @param pages read-ahead distance in pages, 0 disables read-ahead
+   */
+  inline void SetReadAhead(size_t pages) { read_ahead_pages_ = pages; }
+
+  /** Default read-ahead distance of sequential scans, in pages. */
+  static constexpr size_t DEFAULT_READ_AHEAD_PAGES = 8;
+
  private:
+  /** Fetch a page, through the strategy if there is one. */
+  Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) {
+    return strategy == nullptr ? buffer_pool_manager_->FetchPage(page_id)
+                               : buffer_pool_manager_->FetchPage(page_id, *strategy);
+  }
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  /** Where the table's new pages come from. */
+  PageSegment segment_;
+  size_t read_ahead_pages_{DEFAULT_READ_AHEAD_PAGES};
 };
 
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <cassert>
 
+#include "buffer/buffer_access_strategy.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
@@ -21,6 +22,7 @@
 namespace bustub {
 
 class TableHeap;
+class TablePage;
 
 /**
  * TableIterator enables the sequential scan of a TableHeap.
@@ -29,10 +31,16 @@ class TableIterator {
   friend class Cursor;
 
  public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        strategy_(other.strategy_),
+        sequential_pages_(other.sequential_pages_),
+        next_read_ahead_(other.next_read_ahead_),
+        read_ahead_window_(other.read_ahead_window_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -52,13 +60,28 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    strategy_ = other.strategy_;
+    sequential_pages_ = other.sequential_pages_;
+    next_read_ahead_ = other.next_read_ahead_;
+    read_ahead_window_ = other.read_ahead_window_;
     return *this;
   }
 
  private:
+  /** Called on every move to the next page; once the scan looks sequential, prefetch the pages after it. */
+  void ReadAhead(TablePage *page);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** Access strategy of the scan, nullptr for a normal scan. */
+  BufferAccessStrategy *strategy_;
+  /** Number of page boundaries this iterator has crossed. */
+  size_t sequential_pages_{0};
+  /** Value of sequential_pages_ at which to send the next read-ahead request. */
+  size_t next_read_ahead_{0};
+  /** Pages requested by the last read-ahead request. */
+  size_t read_ahead_window_{0};
 };
 
 }  // namespace bustub
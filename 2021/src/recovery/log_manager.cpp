@@ -12,6 +12,10 @@
 
 #include "recovery/log_manager.h"
 
+#include <cstring>
+
+#include "common/macros.h"
+
 namespace bustub {
 /*
  * set enable_logging = true
@@ -22,33 +26,167 @@ namespace bustub {
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::scoped_lock lock(latch_);
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  stop_ = false;
+  enable_logging = true;
+  flush_thread_ = new std::thread([this] {
+    std::unique_lock lock(latch_);
+    while (true) {
+      cv_.wait_for(lock, log_timeout, [this] { return flush_requested_ || stop_; });
+      bool stop = stop_;
+      lock.unlock();
+      FlushLogBuffer();
+      if (stop) {
+        return;
+      }
+      lock.lock();
+    }
+  });
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  std::thread *flush_thread;
+  {
+    std::scoped_lock lock(latch_);
+    flush_thread = flush_thread_;
+    stop_ = true;
+  }
+  if (flush_thread == nullptr) {
+    return;
+  }
+  cv_.notify_one();
+  flush_thread->join();
+  delete flush_thread;
+  {
+    std::scoped_lock lock(latch_);
+    flush_thread_ = nullptr;
+  }
+  // records appended after the thread's last write
+  FlushLogBuffer();
+  enable_logging = false;
+}
 
 /*
  * append a log record into log buffer
  * you MUST set the log record's lsn within this method
  * @return: lsn that is assigned to this log record
- *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
  */
-lsn_t LogManager::AppendLogRecord(LogRecord *log_record) { return INVALID_LSN; }
+lsn_t LogManager::AppendLogRecord(LogRecord *log_record) {
+  int32_t size = log_record->size_;
+  BUSTUB_ASSERT(size >= LogRecord::HEADER_SIZE && size <= LOG_BUFFER_SIZE, "a log record has to fit the log buffer");
+  char *buffer;
+  int offset;
+  lsn_t lsn;
+  {
+    std::unique_lock lock(latch_);
+    while (log_buffer_bytes_ + size > LOG_BUFFER_SIZE) {
+      if (flush_thread_ == nullptr) {
+        lock.unlock();
+        FlushLogBuffer();
+        lock.lock();
+        continue;
+      }
+      flush_requested_ = true;
+      cv_.notify_one();
+      flushed_cv_.wait(lock);
+    }
+    lsn = next_lsn_++;
+    buffer = log_buffer_;
+    offset = log_buffer_bytes_;
+    log_buffer_bytes_ += size;
+    log_buffer_lsn_ = lsn;
+    // a swap after this point waits for the copy below
+    CopiesInto(buffer).fetch_add(1, std::memory_order_relaxed);
+  }
+  log_record->lsn_ = lsn;
+
+  // the header fields come first in LogRecord, in the order they are logged
+  char *pos = buffer + offset;
+  memcpy(pos, log_record, LogRecord::HEADER_SIZE);
+  pos += LogRecord::HEADER_SIZE;
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      memcpy(pos, &log_record->insert_rid_, sizeof(RID));
+      log_record->insert_tuple_.SerializeTo(pos + sizeof(RID));
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(pos, &log_record->delete_rid_, sizeof(RID));
+      log_record->delete_tuple_.SerializeTo(pos + sizeof(RID));
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(pos, &log_record->update_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->old_tuple_.SerializeTo(pos);
+      pos += sizeof(int32_t) + log_record->old_tuple_.GetLength();
+      log_record->new_tuple_.SerializeTo(pos);
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(pos, &log_record->prev_page_id_, sizeof(page_id_t));
+      memcpy(pos + sizeof(page_id_t), &log_record->page_id_, sizeof(page_id_t));
+      break;
+    default:
+      break;
+  }
+  CopiesInto(buffer).fetch_sub(1, std::memory_order_release);
+  return lsn;
+}
+
+void LogManager::Flush(lsn_t lsn) {
+  std::unique_lock lock(latch_);
+  lsn = std::min(lsn, next_lsn_ - 1);
+  while (persistent_lsn_ < lsn) {
+    if (flush_thread_ == nullptr) {
+      lock.unlock();
+      FlushLogBuffer();
+      lock.lock();
+      continue;
+    }
+    // the flush thread takes every record appended by the time it gets to it, ours and other commits' alike
+    flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(lock);
+  }
+}
+
+void LogManager::FlushLogBuffer() {
+  std::scoped_lock flush_lock(flush_latch_);
+  char *buffer;
+  int bytes;
+  lsn_t last_lsn;
+  {
+    std::scoped_lock lock(latch_);
+    flush_requested_ = false;
+    if (log_buffer_bytes_ == 0) {
+      return;
+    }
+    std::swap(log_buffer_, flush_buffer_);
+    buffer = flush_buffer_;
+    bytes = log_buffer_bytes_;
+    last_lsn = log_buffer_lsn_;
+    log_buffer_bytes_ = 0;
+  }
+  // appends waiting for room can go on in the other buffer
+  flushed_cv_.notify_all();
+  // records reserved before the swap may still be copying into ours
+  std::atomic<int> &copies = CopiesInto(buffer);
+  while (copies.load(std::memory_order_acquire) > 0) {
+    std::this_thread::yield();
+  }
+  disk_manager_->WriteLog(buffer, bytes);
+  {
+    std::scoped_lock lock(latch_);
+    persistent_lsn_ = last_lsn;
+  }
+  flushed_cv_.notify_all();
+}
 
 }  // namespace bustub
@@ -0,0 +1,177 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_map.cpp
+//
+// Identification: src/storage/disk/compressed_page_map.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/compressed_page_map.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+namespace {
+
+constexpr int LENGTH_BITS = 16;
+
+uint64_t EncodeEntry(uint64_t sector, uint32_t length) { return sector << LENGTH_BITS | length; }
+
+uint64_t EntrySector(uint64_t entry) { return entry >> LENGTH_BITS; }
+
+uint32_t EntryLength(uint64_t entry) { return static_cast<uint32_t>(entry & ((1U << LENGTH_BITS) - 1)); }
+
+}  // namespace
+
+CompressedPageMap::Location CompressedPageMap::Find(page_id_t page_id) const {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= entries_.size()) {
+    return {0, 0};
+  }
+  uint64_t entry = entries_[page_id];
+  return {EntrySector(entry) * SECTOR_SIZE, EntryLength(entry)};
+}
+
+uint64_t CompressedPageMap::Reserve(uint32_t length) {
+  uint64_t num_sectors = SectorsFor(length);
+  auto fit = free_by_size_.lower_bound({num_sectors, 0});
+  if (fit == free_by_size_.end()) {
+    uint64_t sector = end_sector_;
+    end_sector_ += num_sectors;
+    return sector * SECTOR_SIZE;
+  }
+  auto [size, sector] = *fit;
+  TakeFree(free_by_sector_.find(sector));
+  if (size > num_sectors) {
+    Free(sector + num_sectors, size - num_sectors);
+  }
+  return sector * SECTOR_SIZE;
+}
+
+bool CompressedPageMap::ReserveBefore(uint32_t length, uint64_t limit, uint64_t *offset) {
+  uint64_t num_sectors = SectorsFor(length);
+  // first fit from the start of the file, which packs pages towards it
+  for (auto it = free_by_sector_.begin(); it != free_by_sector_.end() && it->first + num_sectors <= limit / SECTOR_SIZE;
+       ++it) {
+    auto [sector, size] = *it;
+    if (size >= num_sectors) {
+      TakeFree(it);
+      if (size > num_sectors) {
+        Free(sector + num_sectors, size - num_sectors);
+      }
+      *offset = sector * SECTOR_SIZE;
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<std::pair<page_id_t, CompressedPageMap::Location>> CompressedPageMap::GetPagesFromEnd() const {
+  std::vector<std::pair<page_id_t, Location>> pages;
+  for (page_id_t page_id = 0; page_id < GetNumPages(); page_id++) {
+    if (entries_[page_id] != 0) {
+      pages.emplace_back(page_id, Find(page_id));
+    }
+  }
+  std::sort(pages.begin(), pages.end(),
+            [](const auto &a, const auto &b) { return a.second.offset_ > b.second.offset_; });
+  return pages;
+}
+
+void CompressedPageMap::Unreserve(uint64_t offset, uint32_t length) { Free(offset / SECTOR_SIZE, SectorsFor(length)); }
+
+void CompressedPageMap::Publish(page_id_t page_id, uint64_t offset, uint32_t length) {
+  if (static_cast<size_t>(page_id) >= entries_.size()) {
+    entries_.resize(page_id + 1, 0);
+  }
+  Remove(page_id);
+  entries_[page_id] = EncodeEntry(offset / SECTOR_SIZE, length);
+  stored_bytes_ += length;
+}
+
+void CompressedPageMap::Remove(page_id_t page_id) {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= entries_.size() || entries_[page_id] == 0) {
+    return;
+  }
+  uint64_t entry = entries_[page_id];
+  retired_.emplace_back(EntrySector(entry), SectorsFor(EntryLength(entry)));
+  stored_bytes_ -= EntryLength(entry);
+  entries_[page_id] = 0;
+}
+
+std::vector<uint64_t> CompressedPageMap::Encode(size_t *num_retired) const {
+  *num_retired = retired_.size();
+  return entries_;
+}
+
+void CompressedPageMap::ReleaseRetired(size_t num_retired) {
+  for (size_t i = 0; i < num_retired; i++) {
+    Free(retired_[i].first, retired_[i].second);
+  }
+  retired_.erase(retired_.begin(), retired_.begin() + num_retired);
+}
+
+void CompressedPageMap::Decode(std::vector<uint64_t> entries) {
+  entries_ = std::move(entries);
+  retired_.clear();
+  free_by_sector_.clear();
+  free_by_size_.clear();
+  stored_bytes_ = 0;
+  std::vector<std::pair<uint64_t, uint64_t>> used;
+  for (uint64_t entry : entries_) {
+    if (entry != 0) {
+      used.emplace_back(EntrySector(entry), SectorsFor(EntryLength(entry)));
+      stored_bytes_ += EntryLength(entry);
+    }
+  }
+  // whatever lies between the slots in use is free
+  std::sort(used.begin(), used.end());
+  end_sector_ = 0;
+  for (auto [sector, num_sectors] : used) {
+    if (sector > end_sector_) {
+      Free(end_sector_, sector - end_sector_);
+    }
+    end_sector_ = std::max(end_sector_, sector + num_sectors);
+  }
+}
+
+uint64_t CompressedPageMap::Truncate() {
+  if (!free_by_sector_.empty()) {
+    auto last = std::prev(free_by_sector_.end());
+    if (last->first + last->second == end_sector_) {
+      end_sector_ = last->first;
+      TakeFree(last);
+    }
+  }
+  return GetFileBytes();
+}
+
+void CompressedPageMap::Free(uint64_t sector, uint64_t num_sectors) {
+  auto next = free_by_sector_.lower_bound(sector);
+  if (next != free_by_sector_.end() && sector + num_sectors == next->first) {
+    num_sectors += next->second;
+    TakeFree(next);
+  }
+  auto prev = free_by_sector_.lower_bound(sector);
+  if (prev != free_by_sector_.begin()) {
+    prev--;
+    if (prev->first + prev->second == sector) {
+      sector = prev->first;
+      num_sectors += prev->second;
+      TakeFree(prev);
+    }
+  }
+  free_by_sector_.emplace(sector, num_sectors);
+  free_by_size_.emplace(num_sectors, sector);
+}
+
+void CompressedPageMap::TakeFree(std::map<uint64_t, uint64_t>::iterator it) {
+  free_by_size_.erase({it->second, it->first});
+  free_by_sector_.erase(it);
+}
+
+}  // namespace bustub
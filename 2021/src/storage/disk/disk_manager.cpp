@@ -10,123 +10,1131 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <iterator>
 #include <iostream>
-#include <mutex>  // NOLINT
+#include <memory>
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
+#include "common/crc32c.h"
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/lz4.h"
+#include "common/macros.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+namespace {
+
+/** pread until count bytes are in or the file ends. @return bytes read, -1 on error */
+ssize_t ReadFully(int fd, char *buf, size_t count, off_t offset) {
+  size_t done = 0;
+  while (done < count) {
+    ssize_t n = pread(fd, buf + done, count - done, offset + static_cast<off_t>(done));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      return -1;
+    }
+    if (n == 0) {
+      break;
+    }
+    done += n;
+  }
+  return static_cast<ssize_t>(done);
+}
+
+/** pwrite until all count bytes are out. @return false on error */
+bool WriteFully(int fd, const char *buf, size_t count, off_t offset) {
+  size_t done = 0;
+  while (done < count) {
+    ssize_t n = pwrite(fd, buf + done, count - done, offset + static_cast<off_t>(done));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    done += n;
+  }
+  return true;
+}
+
+/** First bytes of an allocation map side file; followed by the number of pages and the bitmap. */
+constexpr char MAP_MAGIC[8] = {'B', 'T', 'F', 'S', 'M', 'A', 'P', '1'};
+
+/** First bytes of a page map side file; followed by the number of pages and their CompressedPageMap entries. */
+constexpr char PAGE_MAP_MAGIC[8] = {'B', 'T', 'P', 'G', 'M', 'A', 'P', '1'};
+
+/** First bytes of a tablespace side file; followed by the number of files, the StripeLayout and the stripe size. */
+constexpr char TABLESPACE_MAGIC[8] = {'B', 'T', 'T', 'B', 'S', 'P', 'C', '1'};
+
+/**
+ * Write a side file: magic, count, payload. A new copy is written and renamed over the old one, so a crash leaves one
+ * of the two intact.
+ * @return false on an I/O error
+ */
+bool WriteSideFile(const std::string &name, const char (&magic)[8], uint32_t count, const char *payload,
+                   size_t payload_bytes) {
+  std::string tmp_name = name + ".tmp";
+  int fd = open(tmp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  bool ok = fd >= 0 && WriteFully(fd, magic, sizeof(magic), 0) &&
+            WriteFully(fd, reinterpret_cast<const char *>(&count), sizeof(count), sizeof(magic)) &&
+            WriteFully(fd, payload, payload_bytes, sizeof(magic) + sizeof(count)) && fdatasync(fd) == 0;
+  if (fd >= 0) {
+    close(fd);
+  }
+  return ok && rename(tmp_name.c_str(), name.c_str()) == 0;
+}
+
+/** Bounce buffers per thread: a compressed write may need one for its page and one for the compressed output. */
+constexpr size_t NUM_BOUNCE_BUFFERS = 2;
+
+/** @return a page-sized buffer aligned for direct I/O, private to the calling thread */
+char *BounceBuffer(size_t index = 0) {
+  struct FreeDeleter {
+    void operator()(char *buf) const { free(buf); }
+  };
+  thread_local std::unique_ptr<char, FreeDeleter> buffers[NUM_BOUNCE_BUFFERS];
+  std::unique_ptr<char, FreeDeleter> &buffer = buffers[index];
+  if (buffer == nullptr) {
+    buffer.reset(static_cast<char *>(aligned_alloc(DiskManager::DIRECT_IO_ALIGNMENT, PAGE_SIZE)));
+  }
+  return buffer.get();
+}
+
+/** @return the checksum in a page's trailer, 0 if it has none */
+uint32_t StoredChecksum(const char *page_data) {
+  uint32_t checksum;
+  memcpy(&checksum, page_data + PAGE_USABLE_SIZE, sizeof(checksum));
+  return checksum;
+}
+
+/** @return the checksum of a page's contents; never 0, which marks a page without one */
+uint32_t PageChecksum(const char *page_data) {
+  uint32_t checksum = Crc32c(page_data, PAGE_USABLE_SIZE);
+  return checksum == 0 ? 1 : checksum;
+}
+
+}  // namespace
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, const DiskManagerOptions &options)
+    : file_name_(db_file),
+      num_flushes_(0),
+      num_writes_(0),
+      num_reads_(0),
+      flush_log_(false),
+      flush_log_f_(nullptr) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
+    db_fds_.push_back(-1);
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  map_name_ = file_name_.substr(0, n) + ".fsm";
+  page_map_name_ = file_name_.substr(0, n) + ".cpm";
+  tablespace_name_ = file_name_.substr(0, n) + ".tbs";
+  checksums_ = options.checksums_;
+  compress_ = options.compress_pages_;
+  data_files_.push_back(db_file);
+  data_files_.insert(data_files_.end(), options.stripe_files_.begin(), options.stripe_files_.end());
+  if (data_files_.size() > 1) {
+    if (compress_ || options.mmap_read_only_) {
+      throw Exception("a striped db cannot be compressed or mapped");
+    }
+    if (options.stripe_pages_ <= 0) {
+      throw Exception("a stripe needs at least one page");
+    }
+    tablespace_ = Tablespace(static_cast<uint32_t>(data_files_.size()), options.stripe_layout_, options.stripe_pages_);
+  }
+
+  if (options.mmap_read_only_) {
+    if (compress_) {
+      throw Exception("a compressed db file cannot be mapped");
+    }
+    OpenReadOnly();
+    return;
+  }
 
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::app | std::ios::out);
-    log_io_.close();
-    // reopen with original mode
-    log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
-    }
-  }
-
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  log_fd_ = open(log_name_.c_str(), O_RDWR | O_CREAT, 0644);
+  if (log_fd_ < 0) {
+    throw Exception("can't open dblog file");
+  }
+  struct stat log_stat;
+  log_bytes_ = fstat(log_fd_, &log_stat) == 0 ? log_stat.st_size : 0;
+
+  // create the files if they do not exist
+#ifdef O_DIRECT
+  // compressed pages are neither page sized nor page aligned
+  if (options.direct_io_ && !compress_) {
+    if (OpenDataFiles(O_RDWR | O_CREAT | O_DIRECT)) {
+      direct_io_ = true;
+    } else if (errno == EINVAL) {
+      LOG_DEBUG("the file system does not support O_DIRECT, falling back to buffered I/O");
+    }
+  }
+#endif
+  if (db_fds_.empty() && !OpenDataFiles(O_RDWR | O_CREAT)) {
+    throw Exception("can't open db file");
+  }
+  page_id_t file_pages = GetDataPages();
+  CheckTablespace(file_pages);
+  if (compress_) {
+    struct stat stat_buf;
+    file_pages = LoadPageMap(fstat(db_fds_[0], &stat_buf) == 0 ? stat_buf.st_size : 0);
+  }
+  LoadAllocationMap(file_pages);
+
+  if (options.use_io_uring_) {
+    ring_ = IoUring::Create(ASYNC_QUEUE_DEPTH);
+    if (ring_ == nullptr) {
+      LOG_DEBUG("io_uring is not available, asynchronous I/O falls back to pread/pwrite");
+    }
+  }
+  if (ring_ != nullptr) {
+    // one slot per submission queue entry, so a free slot always finds room in the queue
+    requests_.resize(ring_->GetEntries());
+    for (uint32_t slot = ring_->GetEntries(); slot > 0; slot--) {
+      free_requests_.push_back(slot - 1);
     }
   }
   buffer_used = nullptr;
 }
 
+void DiskManager::OpenReadOnly() {
+  read_only_ = true;
+  if (!OpenDataFiles(O_RDONLY)) {
+    throw Exception("can't open db file");
+  }
+  page_id_t file_pages = GetDataPages();
+  CheckTablespace(file_pages);
+  LoadAllocationMap(file_pages);
+  if (file_pages == 0) {
+    // nothing to map; mmap refuses empty mappings
+    return;
+  }
+  // a partial last page reads as zeros past the end of the file, like ReadPage
+  size_t map_bytes = static_cast<size_t>(file_pages) * PAGE_SIZE;
+  void *mapping = mmap(nullptr, map_bytes, PROT_READ, MAP_SHARED, db_fds_[0], 0);
+  if (mapping == MAP_FAILED) {
+    throw Exception("can't map db file");
+  }
+  madvise(mapping, map_bytes, MADV_SEQUENTIAL);
+  mapping_ = static_cast<char *>(mapping);
+  mapped_pages_ = file_pages;
+}
+
+bool DiskManager::OpenDataFiles(int flags) {
+  for (const std::string &name : data_files_) {
+    int fd = open(name.c_str(), flags, 0644);
+    if (fd < 0) {
+      int error = errno;
+      for (int open_fd : db_fds_) {
+        close(open_fd);
+      }
+      db_fds_.clear();
+      errno = error;
+      return false;
+    }
+    db_fds_.push_back(fd);
+  }
+  return true;
+}
+
+page_id_t DiskManager::GetDataPages() {
+  std::vector<page_id_t> file_pages;
+  for (int fd : db_fds_) {
+    struct stat stat_buf;
+    off_t file_bytes = fstat(fd, &stat_buf) == 0 ? stat_buf.st_size : 0;
+    file_pages.push_back(static_cast<page_id_t>((file_bytes + PAGE_SIZE - 1) / PAGE_SIZE));
+  }
+  return tablespace_.GetPageIdLimit(file_pages);
+}
+
+void DiskManager::CheckTablespace(page_id_t file_pages) {
+  // a db of one file needs no side file, so an older db without one is a db of one file
+  uint32_t layout[3] = {1, static_cast<uint32_t>(StripeLayout::ROUND_ROBIN),
+                        static_cast<uint32_t>(Tablespace::DEFAULT_STRIPE_PAGES)};
+  uint32_t expected[3] = {tablespace_.GetNumFiles(), static_cast<uint32_t>(tablespace_.GetLayout()),
+                          static_cast<uint32_t>(tablespace_.GetStripePages())};
+  if (file_pages == 0) {
+    if (read_only_) {
+      return;
+    }
+    if (tablespace_.GetNumFiles() == 1) {
+      remove(tablespace_name_.c_str());
+    } else if (!WriteSideFile(tablespace_name_, TABLESPACE_MAGIC, expected[0],
+                              reinterpret_cast<const char *>(expected + 1), 2 * sizeof(uint32_t))) {
+      throw Exception("can't write the tablespace layout");
+    }
+    return;
+  }
+  int fd = open(tablespace_name_.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    char magic[sizeof(TABLESPACE_MAGIC)];
+    bool loaded = ReadFully(fd, magic, sizeof(magic), 0) == sizeof(magic) &&
+                  memcmp(magic, TABLESPACE_MAGIC, sizeof(magic)) == 0 &&
+                  ReadFully(fd, reinterpret_cast<char *>(layout), sizeof(layout), sizeof(magic)) == sizeof(layout);
+    close(fd);
+    if (!loaded) {
+      throw Exception("can't read the tablespace layout");
+    }
+  }
+  // a single file has no stripes to mismatch
+  if (layout[0] != expected[0] || (expected[0] > 1 && (layout[1] != expected[1] || layout[2] != expected[2]))) {
+    throw Exception("the db files were striped differently");
+  }
+}
+
+void DiskManager::AdviseWillNeed(page_id_t page_id, size_t num_pages) {
+  if (page_id < 0 || page_id >= mapped_pages_ || num_pages == 0) {
+    return;
+  }
+  num_pages = std::min(num_pages, static_cast<size_t>(mapped_pages_ - page_id));
+  madvise(mapping_ + static_cast<size_t>(page_id) * PAGE_SIZE, num_pages * PAGE_SIZE, MADV_WILLNEED);
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+  // requests in flight still need the file
+  while (GetNumPending() > 0) {
+    Poll(1);
+  }
+  SavePageMap();
+  SaveAllocationMap();
+  if (mapping_ != nullptr) {
+    munmap(mapping_, static_cast<size_t>(mapped_pages_) * PAGE_SIZE);
+    mapping_ = nullptr;
+    mapped_pages_ = 0;
+  }
+  for (int fd : db_fds_) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+  db_fds_.assign(db_fds_.size(), -1);
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+    log_fd_ = -1;
   }
-  log_io_.close();
 }
 
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
+  // the page goes to the OS page cache; Sync makes it durable
+  if (!WritePageData(page_id, page_data)) {
     LOG_DEBUG("I/O error while writing");
-    return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+}
+
+bool DiskManager::WritePageData(page_id_t page_id, const char *page_data) {
+  if (checksums_) {
+    // the caller may go on changing the page, e.g. a frame flushed under a pin, so only the copy is stable
+    char *copy = BounceBuffer();
+    StampChecksum(page_data, copy);
+    page_data = copy;
+  } else if (!CanTransfer(page_data)) {
+    char *bounce = BounceBuffer();
+    memcpy(bounce, page_data, PAGE_SIZE);
+    page_data = bounce;
+  }
+  if (compress_) {
+    if (!WriteCompressedPage(page_id, page_data)) {
+      return false;
+    }
+  } else if (auto [fd, offset] = Locate(page_id); !WriteFully(fd, page_data, PAGE_SIZE, offset)) {
+    return false;
+  }
+  ForgetCorruptPage(page_id);
+  return true;
+}
+
+void DiskManager::StampChecksum(const char *page_data, char *copy) {
+  memcpy(copy, page_data, PAGE_USABLE_SIZE);
+  uint32_t checksum = PageChecksum(copy);
+  memcpy(copy + PAGE_USABLE_SIZE, &checksum, sizeof(checksum));
+}
+
+bool DiskManager::WriteCompressedPage(page_id_t page_id, const char *page_data) {
+  // a page has to save at least a sector to be worth decompressing; the page itself may be in the first bounce buffer
+  char *compressed = BounceBuffer(1);
+  uint32_t length = Lz4Compress(page_data, PAGE_SIZE, compressed, PAGE_SIZE - CompressedPageMap::SECTOR_SIZE);
+  const char *stored = compressed;
+  if (length == 0) {
+    stored = page_data;
+    length = PAGE_SIZE;
+  }
+  uint64_t offset;
+  {
+    std::scoped_lock lock(page_map_latch_);
+    offset = page_map_.Reserve(length);
+  }
+  if (!WriteFully(db_fds_[0], stored, length, static_cast<off_t>(offset))) {
+    std::scoped_lock lock(page_map_latch_);
+    page_map_.Unreserve(offset, length);
+    return false;
+  }
+  bool save;
+  {
+    std::scoped_lock lock(page_map_latch_);
+    page_map_.Publish(page_id, offset, length);
+    page_map_dirty_ = true;
+    save = page_map_.GetNumRetired() >= PAGE_MAP_SAVE_INTERVAL;
+  }
+  if (save) {
+    SavePageMap(PAGE_MAP_SAVE_INTERVAL);
+  }
+  return true;
+}
+
+/**
+ * Force written pages to disk
+ */
+void DiskManager::Sync() {
+  for (int fd : db_fds_) {
+    if (fdatasync(fd) != 0) {
+      LOG_DEBUG("I/O error while syncing");
+    }
+  }
+  SavePageMap();
+  SaveAllocationMap();
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
+  num_reads_ += 1;
+  if (const char *mapped = GetMappedPage(page_id); mapped != nullptr) {
+    memcpy(page_data, mapped, PAGE_SIZE);
+    CheckPage(page_id, page_data);
+    return;
+  }
+  ReadPageData(page_id, page_data);
+}
+
+bool DiskManager::ReadPageData(page_id_t page_id, char *page_data) {
+  if (compress_) {
+    return ReadCompressedPage(page_id, page_data) && CheckPage(page_id, page_data);
+  }
+  char *target = CanTransfer(page_data) ? page_data : BounceBuffer();
+  auto [fd, offset] = Locate(page_id);
+  ssize_t read_count = ReadFully(fd, target, PAGE_SIZE, offset);
+  if (read_count < 0) {
+    LOG_DEBUG("I/O error while reading");
+    return false;
+  }
+  // if file ends before reading PAGE_SIZE, e.g. a page that was allocated but never written
+  if (read_count < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(target + read_count, 0, PAGE_SIZE - read_count);
+  }
+  if (target != page_data) {
+    memcpy(page_data, target, PAGE_SIZE);
+  }
+  return CheckPage(page_id, page_data);
+}
+
+bool DiskManager::ReadCompressedPage(page_id_t page_id, char *page_data) {
+  char *compressed = BounceBuffer();
+  CompressedPageMap::Location location;
+  while (true) {
+    {
+      std::scoped_lock lock(page_map_latch_);
+      location = page_map_.Find(page_id);
+    }
+    if (location.length_ == 0) {
+      // allocated but never written
+      memset(page_data, 0, PAGE_SIZE);
+      return true;
+    }
+    if (ReadFully(db_fds_[0], compressed, location.length_, static_cast<off_t>(location.offset_)) !=
+        static_cast<ssize_t>(location.length_)) {
       LOG_DEBUG("I/O error while reading");
+      return false;
+    }
+    // A slot is only reused after the page moved away from it and the map was saved. If the page is still where it
+    // was, what we read is its.
+    std::scoped_lock lock(page_map_latch_);
+    if (page_map_.Find(page_id) == location) {
+      break;
+    }
+  }
+  if (location.length_ == PAGE_SIZE) {
+    memcpy(page_data, compressed, PAGE_SIZE);
+    return true;
+  }
+  size_t decompressed_size;
+  if (!Lz4Decompress(compressed, location.length_, page_data, PAGE_SIZE, &decompressed_size) ||
+      decompressed_size != PAGE_SIZE) {
+    ReportCorruptPage(page_id);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Read a batch of pages, one preadv (or, with several runs and a ring, one queued request) per run of pages adjacent
+ * in one file
+ */
+void DiskManager::ReadPages(const page_id_t *page_ids, char *const *page_data, size_t num_pages) {
+  if (compress_) {
+    num_reads_ += static_cast<int>(num_pages);
+    for (size_t i = 0; i < num_pages; i++) {
+      ReadPageData(page_ids[i], page_data[i]);
+    }
+    return;
+  }
+  // split into runs of adjacent pages, and those where they cross into another file
+  std::vector<size_t> run_begins;
+  page_id_t run_length = 0;
+  for (size_t i = 0; i < num_pages; i++) {
+    if (i == 0 || page_ids[i] != page_ids[i - 1] + 1 || i - run_begins.back() == IOV_MAX ||
+        static_cast<page_id_t>(i - run_begins.back()) == run_length) {
+      run_begins.push_back(i);
+      run_length = tablespace_.GetRunLength(page_ids[i]);
+    }
+  }
+  run_begins.push_back(num_pages);
+  size_t num_runs = run_begins.size() - 1;
+
+  if (ring_ != nullptr && num_runs > 1) {
+    // the runs are independent, so keep all of them in flight at once
+    std::atomic<size_t> remaining(num_runs);
+    for (size_t r = 0; r < num_runs; r++) {
+      size_t begin = run_begins[r];
+      Submit(false, page_ids[begin], page_data + begin, run_begins[r + 1] - begin,
+             [&remaining](bool ok) { remaining--; });
+    }
+    while (remaining > 0) {
+      // another thread's Poll may be running our callbacks right now
+      if (Poll(1) == 0) {
+        std::this_thread::yield();
+      }
+    }
+    return;
+  }
+
+  std::vector<iovec> iov;
+  for (size_t r = 0; r < num_runs; r++) {
+    size_t begin = run_begins[r];
+    size_t end = run_begins[r + 1];
+    iov.clear();
+    for (size_t i = begin; i < end && CanTransfer(page_data[i]); i++) {
+      iov.push_back({page_data[i], PAGE_SIZE});
+    }
+    ssize_t n = 0;
+    // a run with an unaligned buffer under direct I/O is read page by page instead
+    if (iov.size() == end - begin) {
+      auto [fd, offset] = Locate(page_ids[begin]);
+      do {
+        n = preadv(fd, iov.data(), static_cast<int>(iov.size()), offset);
+      } while (n < 0 && errno == EINTR);
+    }
+    num_reads_ += static_cast<int>(end - begin);
+    // pages the vectored read did not fully cover (end of file, short read, error) take the single page path
+    size_t whole_pages = n < 0 ? 0 : static_cast<size_t>(n) / PAGE_SIZE;
+    for (size_t i = begin; i < begin + whole_pages; i++) {
+      CheckPage(page_ids[i], page_data[i]);
+    }
+    for (size_t i = begin + whole_pages; i < end; i++) {
+      ReadPageData(page_ids[i], page_data[i]);
+    }
+  }
+}
+
+void DiskManager::SubmitRead(page_id_t page_id, char *page_data, io_callback_fn callback) {
+  Submit(false, page_id, &page_data, 1, std::move(callback));
+}
+
+void DiskManager::SubmitWrite(page_id_t page_id, const char *page_data, io_callback_fn callback) {
+  // the buffer is only read from; iovec just has no const flavour
+  char *data = const_cast<char *>(page_data);
+  Submit(true, page_id, &data, 1, std::move(callback));
+}
+
+void DiskManager::Submit(bool write, page_id_t page_id, char *const *page_data, size_t num_pages,
+                         io_callback_fn callback) {
+  (write ? num_writes_ : num_reads_) += static_cast<int>(num_pages);
+  bool can_queue = ring_ != nullptr && !compress_;
+  // a checksummed write hands the ring aligned copies instead
+  for (size_t i = 0; i < num_pages && can_queue && !(write && checksums_); i++) {
+    can_queue = CanTransfer(page_data[i]);
+  }
+  std::unique_lock lock(async_latch_);
+  pending_++;
+  if (!can_queue) {
+    lock.unlock();
+    bool ok = true;
+    for (size_t i = 0; i < num_pages; i++) {
+      page_id_t target = page_id + static_cast<page_id_t>(i);
+      ok = (write ? WritePageData(target, page_data[i]) : ReadPageData(target, page_data[i])) && ok;
+    }
+    lock.lock();
+    completed_.emplace_back(std::move(callback), ok);
+    return;
+  }
+
+  while (free_requests_.empty()) {
+    // every slot is in flight: make room by completing requests, whose callbacks then run on this thread
+    lock.unlock();
+    Poll(1);
+    lock.lock();
+  }
+  uint32_t slot = free_requests_.back();
+  free_requests_.pop_back();
+  AsyncRequest &request = requests_[slot];
+  request.write_ = write;
+  request.page_id_ = page_id;
+  request.iov_.clear();
+  request.callback_ = std::move(callback);
+  request.result_ = 0;
+  if (write && checksums_) {
+    // the slot is ours until it is handed to the ring, so the copies are stamped without the latch
+    lock.unlock();
+    if (request.num_copies_ < num_pages) {
+      request.copies_.reset(static_cast<char *>(aligned_alloc(DIRECT_IO_ALIGNMENT, num_pages * PAGE_SIZE)));
+      request.num_copies_ = num_pages;
+    }
+    for (size_t i = 0; i < num_pages; i++) {
+      char *copy = request.copies_.get() + i * PAGE_SIZE;
+      StampChecksum(page_data[i], copy);
+      request.iov_.push_back({copy, PAGE_SIZE});
+    }
+    lock.lock();
+  } else {
+    for (size_t i = 0; i < num_pages; i++) {
+      request.iov_.push_back({page_data[i], PAGE_SIZE});
+    }
+  }
+  auto [fd, offset] = Locate(page_id);
+  auto num_iov = static_cast<unsigned>(request.iov_.size());
+  [[maybe_unused]] bool queued = write ? ring_->PrepareWritev(fd, request.iov_.data(), num_iov, offset, slot)
+                                       : ring_->PrepareReadv(fd, request.iov_.data(), num_iov, offset, slot);
+  BUSTUB_ASSERT(queued, "a free request slot always has a submission queue entry");
+  in_flight_++;
+}
+
+size_t DiskManager::Poll(size_t min_completions) {
+  std::vector<std::pair<io_callback_fn, bool>> done;
+  std::vector<uint32_t> reaped;
+  {
+    std::scoped_lock lock(async_latch_);
+    done.assign(std::make_move_iterator(completed_.begin()), std::make_move_iterator(completed_.end()));
+    completed_.clear();
+    pending_ -= done.size();
+    if (ring_ != nullptr) {
+      // submits whatever is queued; never waits for more than is in flight, nor at all with callbacks ready to run
+      size_t wait_for = done.empty() ? std::min(min_completions, in_flight_) : 0;
+      if (!ring_->Enter(static_cast<unsigned>(wait_for))) {
+        LOG_DEBUG("io_uring_enter failed");
+      }
+      uint64_t slot;
+      int result;
+      while (ring_->NextCompletion(&slot, &result)) {
+        requests_[slot].result_ = result;
+        reaped.push_back(static_cast<uint32_t>(slot));
+        in_flight_--;
+      }
+    }
+  }
+  if (reaped.empty()) {
+    for (auto &[callback, ok] : done) {
+      if (callback) {
+        callback(ok);
+      }
+    }
+    return done.size();
+  }
+
+  // The reaped slots are ours until they go back on the free list, so finish them without the latch. Free them
+  // before running any callback: a callback may submit, and must not find the queue full of finished requests.
+  for (uint32_t slot : reaped) {
+    AsyncRequest &request = requests_[slot];
+    done.emplace_back(std::move(request.callback_), FinishRequest(request));
+  }
+  {
+    std::scoped_lock lock(async_latch_);
+    free_requests_.insert(free_requests_.end(), reaped.begin(), reaped.end());
+    pending_ -= reaped.size();
+  }
+  for (auto &[callback, ok] : done) {
+    if (callback) {
+      callback(ok);
+    }
+  }
+  return done.size();
+}
+
+bool DiskManager::FinishRequest(const AsyncRequest &request) {
+  if (request.result_ < 0) {
+    LOG_DEBUG("I/O error in an asynchronous request: %s", strerror(-request.result_));
+    return false;
+  }
+  bool ok = true;
+  size_t whole_pages = static_cast<size_t>(request.result_) / PAGE_SIZE;
+  for (size_t i = 0; i < whole_pages && i < request.iov_.size(); i++) {
+    page_id_t page_id = request.page_id_ + static_cast<page_id_t>(i);
+    auto *data = static_cast<char *>(request.iov_[i].iov_base);
+    if (request.write_) {
+      ForgetCorruptPage(page_id);
+    } else {
+      ok = CheckPage(page_id, data) && ok;
+    }
+  }
+  for (size_t i = whole_pages; i < request.iov_.size(); i++) {
+    page_id_t page_id = request.page_id_ + static_cast<page_id_t>(i);
+    auto *data = static_cast<char *>(request.iov_[i].iov_base);
+    ok = (request.write_ ? WritePageData(page_id, data) : ReadPageData(page_id, data)) && ok;
+  }
+  return ok;
+}
+
+size_t DiskManager::GetNumPending() {
+  std::scoped_lock lock(async_latch_);
+  return pending_;
+}
+
+/**
+ * Page allocation
+ */
+void DiskManager::SetAllocationPartitions(uint32_t num_partitions, page_partition_fn partition_of) {
+  BUSTUB_ASSERT(num_partitions > 0, "there is at least one allocation partition");
+  std::scoped_lock lock(alloc_latch_);
+  num_partitions_ = num_partitions;
+  partition_of_ = std::move(partition_of);
+  ResetAllocationPartitions();
+}
+
+void DiskManager::ResetAllocationPartitions() {
+  next_unseen_.assign(num_partitions_, map_pages_);
+  free_pages_.assign(num_partitions_, {});
+  // highest first, so that every stack hands out its lowest page first
+  for (page_id_t page_id = map_pages_ - 1; page_id >= 0; page_id--) {
+    if (!IsSet(page_id)) {
+      free_pages_[PartitionOf(page_id)].push_back(page_id);
+    }
+  }
+}
+
+page_id_t DiskManager::AllocatePage(uint32_t partition) {
+  std::scoped_lock lock(alloc_latch_);
+  BUSTUB_ASSERT(partition < num_partitions_, "no such allocation partition");
+  page_id_t page_id;
+  std::vector<page_id_t> &free_pages = free_pages_[partition];
+  if (!free_pages.empty()) {
+    page_id = free_pages.back();
+    free_pages.pop_back();
+  } else {
+    // every partition's cursor passes each page id once, so this is O(num_partitions) amortized
+    page_id_t &next = next_unseen_[partition];
+    while (IsSet(next) || PartitionOf(next) != partition) {
+      next++;
+    }
+    page_id = next++;
+  }
+  SetAllocated(page_id, true);
+  num_allocated_++;
+  map_dirty_ = true;
+  return page_id;
+}
+
+page_id_t DiskManager::AllocateExtent(size_t num_pages) {
+  std::scoped_lock lock(alloc_latch_);
+  // Past the end of the map nothing is allocated, and every partition's cursor and free list lies before it. A
+  // partition cursor that reaches the extent later skips over its pages as allocated.
+  page_id_t first = map_pages_;
+  for (size_t i = 0; i < num_pages; i++) {
+    SetAllocated(first + static_cast<page_id_t>(i), true);
+  }
+  num_allocated_ += num_pages;
+  map_dirty_ = true;
+  return first;
+}
+
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  std::scoped_lock lock(alloc_latch_);
+  if (!IsSet(page_id)) {
+    return;
+  }
+  SetAllocated(page_id, false);
+  num_allocated_--;
+  map_dirty_ = true;
+  uint32_t partition = PartitionOf(page_id);
+  BUSTUB_ASSERT(partition < num_partitions_, "page id maps to no allocation partition");
+  // past the cursor the page is found again without being listed
+  if (page_id < next_unseen_[partition]) {
+    free_pages_[partition].push_back(page_id);
+  }
+  // whatever is left of the page is garbage now, and Shrink may punch it out
+  ForgetCorruptPage(page_id);
+  if (compress_) {
+    std::scoped_lock map_lock(page_map_latch_);
+    page_map_.Remove(page_id);
+    page_map_dirty_ = true;
+  }
+}
+
+bool DiskManager::IsAllocated(page_id_t page_id) {
+  std::scoped_lock lock(alloc_latch_);
+  return IsSet(page_id);
+}
+
+size_t DiskManager::GetNumAllocatedPages() {
+  std::scoped_lock lock(alloc_latch_);
+  return num_allocated_;
+}
+
+page_id_t DiskManager::GetPageIdLimit() {
+  std::scoped_lock lock(alloc_latch_);
+  return map_pages_;
+}
+
+void DiskManager::SetAllocated(page_id_t page_id, bool allocated) {
+  if (page_id >= map_pages_) {
+    if (!allocated) {
       return;
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    map_pages_ = page_id + 1;
+    allocated_.resize((map_pages_ + 7) / 8, 0);
+  }
+  if (allocated) {
+    allocated_[page_id / 8] |= static_cast<uint8_t>(1U << (page_id % 8));
+  } else {
+    allocated_[page_id / 8] &= static_cast<uint8_t>(~(1U << (page_id % 8)));
+  }
+}
+
+page_id_t DiskManager::Shrink() {
+  std::unique_lock lock(alloc_latch_);
+  page_id_t end = map_pages_;
+  while (end > 0 && !IsSet(end - 1)) {
+    end--;
+  }
+  if (end < map_pages_) {
+    // the bits past end are all clear already
+    map_pages_ = end;
+    allocated_.resize((end + 7) / 8);
+    for (uint32_t partition = 0; partition < num_partitions_; partition++) {
+      next_unseen_[partition] = std::min(next_unseen_[partition], end);
+      std::vector<page_id_t> &free_pages = free_pages_[partition];
+      free_pages.erase(std::remove_if(free_pages.begin(), free_pages.end(),
+                                      [end](page_id_t page_id) { return page_id >= end; }),
+                       free_pages.end());
     }
+    map_dirty_ = true;
   }
+
+  if (compress_) {
+    // the free pages gave up their slots already; saving the page map takes latches that come before ours
+    lock.unlock();
+    CompactPages();
+    return end;
+  }
+  for (uint32_t file = 0; file < db_fds_.size(); file++) {
+    struct stat stat_buf;
+    auto end_bytes = static_cast<off_t>(tablespace_.GetFilePages(file, end)) * PAGE_SIZE;
+    if (fstat(db_fds_[file], &stat_buf) == 0 && stat_buf.st_size > end_bytes &&
+        ftruncate(db_fds_[file], end_bytes) != 0) {
+      LOG_DEBUG("I/O error while truncating the db file");
+    }
+  }
+#ifdef FALLOC_FL_PUNCH_HOLE
+  // the files keep their size, free runs just stop taking up blocks; they read back as zeros
+  page_id_t run_begin = 0;
+  bool punched = true;
+  for (page_id_t page_id = 0; page_id <= end && punched; page_id++) {
+    if (page_id < end && !IsSet(page_id)) {
+      continue;
+    }
+    // a free run is punched out of each file it crosses
+    while (run_begin < page_id && punched) {
+      page_id_t num_pages = std::min(page_id - run_begin, tablespace_.GetRunLength(run_begin));
+      auto [fd, offset] = Locate(run_begin);
+      // e.g. EOPNOTSUPP; truncating was all we could do
+      punched = fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset,
+                          static_cast<off_t>(num_pages) * PAGE_SIZE) == 0;
+      run_begin += num_pages;
+    }
+    run_begin = page_id + 1;
+  }
+#endif
+  return end;
+}
+
+void DiskManager::LoadAllocationMap(page_id_t file_pages) {
+  bool loaded = false;
+  // a new db file may sit next to the map of a deleted one
+  int fd = file_pages > 0 ? open(map_name_.c_str(), O_RDONLY) : -1;
+  if (fd >= 0) {
+    char magic[sizeof(MAP_MAGIC)];
+    uint32_t num_pages;
+    if (ReadFully(fd, magic, sizeof(magic), 0) == sizeof(magic) && memcmp(magic, MAP_MAGIC, sizeof(magic)) == 0 &&
+        ReadFully(fd, reinterpret_cast<char *>(&num_pages), sizeof(num_pages), sizeof(magic)) == sizeof(num_pages) &&
+        num_pages <= static_cast<uint32_t>(INT32_MAX)) {
+      allocated_.assign((num_pages + 7) / 8, 0);
+      auto map_bytes = static_cast<ssize_t>(allocated_.size());
+      if (ReadFully(fd, reinterpret_cast<char *>(allocated_.data()), allocated_.size(),
+                    sizeof(magic) + sizeof(num_pages)) == map_bytes) {
+        map_pages_ = static_cast<page_id_t>(num_pages);
+        loaded = true;
+      }
+    }
+    close(fd);
+  }
+  if (!loaded) {
+    allocated_.clear();
+    map_pages_ = 0;
+  }
+  // pages the map does not know about, written after it was saved or by a version without one, are in use
+  for (page_id_t page_id = map_pages_; page_id < file_pages; page_id++) {
+    SetAllocated(page_id, true);
+    map_dirty_ = true;
+  }
+  num_allocated_ = 0;
+  for (uint8_t bits : allocated_) {
+    num_allocated_ += __builtin_popcount(bits);
+  }
+  ResetAllocationPartitions();
+}
+
+void DiskManager::SaveAllocationMap() {
+  std::scoped_lock write_lock(map_write_latch_);
+  std::vector<uint8_t> bitmap;
+  uint32_t num_pages;
+  {
+    std::scoped_lock lock(alloc_latch_);
+    if (!map_dirty_ || map_name_.empty() || read_only_) {
+      return;
+    }
+    bitmap = allocated_;
+    num_pages = static_cast<uint32_t>(map_pages_);
+    map_dirty_ = false;
+  }
+  if (!WriteSideFile(map_name_, MAP_MAGIC, num_pages, reinterpret_cast<const char *>(bitmap.data()), bitmap.size())) {
+    LOG_DEBUG("I/O error while writing the allocation map");
+    std::scoped_lock lock(alloc_latch_);
+    map_dirty_ = true;
+  }
+}
+
+bool DiskManager::CheckPage(page_id_t page_id, char *page_data) {
+  if (!checksums_) {
+    return true;
+  }
+  uint32_t stored = StoredChecksum(page_data);
+  if (stored == 0) {
+    return true;
+  }
+  // the trailer is not part of the page's contents, and frames never carry it
+  memset(page_data + PAGE_USABLE_SIZE, 0, PAGE_CHECKSUM_SIZE);
+  if (PageChecksum(page_data) == stored) {
+    return true;
+  }
+  ReportCorruptPage(page_id);
+  return false;
+}
+
+void DiskManager::ReportCorruptPage(page_id_t page_id) {
+  LOG_WARN("page %d does not match its checksum", page_id);
+  checksum_failures_++;
+  std::scoped_lock lock(corrupt_latch_);
+  corrupt_pages_.insert(page_id);
+}
+
+void DiskManager::ForgetCorruptPage(page_id_t page_id) {
+  // no page has failed yet, by far the common case, so there is nothing to forget and no latch to take
+  if (checksum_failures_ == 0) {
+    return;
+  }
+  std::scoped_lock lock(corrupt_latch_);
+  corrupt_pages_.erase(page_id);
+}
+
+bool DiskManager::VerifyPage(page_id_t page_id) {
+  if (!checksums_ || !IsAllocated(page_id)) {
+    return true;
+  }
+  uint32_t mismatch[2] = {0, 0};
+  for (int attempt = 0; attempt < 2; attempt++) {
+    const char *page_data = GetMappedPage(page_id);
+    char decompressed[PAGE_SIZE];
+    if (compress_) {
+      if (!ReadCompressedPage(page_id, decompressed)) {
+        // bad data is reported already
+        return false;
+      }
+      page_data = decompressed;
+    } else if (page_data == nullptr) {
+      char *buf = BounceBuffer();
+      auto [fd, offset] = Locate(page_id);
+      ssize_t read_count = ReadFully(fd, buf, PAGE_SIZE, offset);
+      if (read_count < 0) {
+        LOG_DEBUG("I/O error while verifying");
+        return false;
+      }
+      // a page cut off by a truncated file reads as zeros, and has no checksum left to fail
+      memset(buf + read_count, 0, PAGE_SIZE - read_count);
+      page_data = buf;
+    }
+    uint32_t stored = StoredChecksum(page_data);
+    uint32_t computed = PageChecksum(page_data);
+    if (stored == 0 || stored == computed) {
+      return true;
+    }
+    // A write racing with the read can leave us half of each version, which the write itself repairs; a page that
+    // reads back the same mismatch twice is corrupt on disk.
+    if (attempt > 0 && stored == mismatch[0] && computed == mismatch[1]) {
+      ReportCorruptPage(page_id);
+      return false;
+    }
+    mismatch[0] = stored;
+    mismatch[1] = computed;
+  }
+  // the page changed between the two reads, so it is being written
+  return true;
+}
+
+void DiskManager::CompactPages() {
+  // slots retired since the last save become free space to move into
+  SavePageMap();
+  std::vector<std::pair<page_id_t, CompressedPageMap::Location>> pages;
+  {
+    std::scoped_lock lock(page_map_latch_);
+    pages = page_map_.GetPagesFromEnd();
+  }
+  char *slot = BounceBuffer();
+  for (auto &[page_id, location] : pages) {
+    uint64_t offset;
+    {
+      std::scoped_lock lock(page_map_latch_);
+      if (page_map_.Find(page_id) != location) {
+        // written meanwhile, so it went to the best free slot anyway
+        continue;
+      }
+      if (!page_map_.ReserveBefore(location.length_, location.offset_, &offset)) {
+        continue;
+      }
+    }
+    // the slot is copied as is, compressed
+    bool ok =
+        ReadFully(db_fds_[0], slot, location.length_, static_cast<off_t>(location.offset_)) ==
+            static_cast<ssize_t>(location.length_) &&
+        WriteFully(db_fds_[0], slot, location.length_, static_cast<off_t>(offset));
+    std::scoped_lock lock(page_map_latch_);
+    if (ok && page_map_.Find(page_id) == location) {
+      page_map_.Publish(page_id, offset, location.length_);
+      page_map_dirty_ = true;
+    } else {
+      page_map_.Unreserve(offset, location.length_);
+    }
+  }
+  // the old slots are free once the map no longer points to them
+  SavePageMap();
+  std::scoped_lock lock(page_map_latch_);
+  if (ftruncate(db_fds_[0], static_cast<off_t>(page_map_.Truncate())) != 0) {
+    LOG_DEBUG("I/O error while truncating the db file");
+  }
+}
+
+page_id_t DiskManager::LoadPageMap(off_t file_bytes) {
+  if (file_bytes == 0) {
+    // written right away, so that a compressed db file always has a map next to it
+    page_map_dirty_ = true;
+    SavePageMap();
+    return 0;
+  }
+  int fd = open(page_map_name_.c_str(), O_RDONLY);
+  char magic[sizeof(PAGE_MAP_MAGIC)];
+  uint32_t num_pages;
+  std::vector<uint64_t> entries;
+  bool loaded =
+      fd >= 0 && ReadFully(fd, magic, sizeof(magic), 0) == sizeof(magic) &&
+      memcmp(magic, PAGE_MAP_MAGIC, sizeof(magic)) == 0 &&
+      ReadFully(fd, reinterpret_cast<char *>(&num_pages), sizeof(num_pages), sizeof(magic)) == sizeof(num_pages) &&
+      num_pages <= static_cast<uint32_t>(INT32_MAX);
+  if (loaded) {
+    entries.resize(num_pages);
+    auto bytes = static_cast<ssize_t>(num_pages * sizeof(uint64_t));
+    loaded = ReadFully(fd, reinterpret_cast<char *>(entries.data()), bytes, sizeof(magic) + sizeof(num_pages)) == bytes;
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+  if (!loaded) {
+    // without its map the file is unreadable, and it may not be compressed at all; writing to it would only make
+    // things worse
+    throw Exception("can't read the page map of the compressed db file");
+  }
+  page_map_.Decode(std::move(entries));
+  return page_map_.GetNumPages();
+}
+
+void DiskManager::SavePageMap(size_t min_retired) {
+  if (!compress_) {
+    return;
+  }
+  std::scoped_lock write_lock(map_write_latch_);
+  std::vector<uint64_t> entries;
+  size_t num_retired;
+  {
+    std::scoped_lock lock(page_map_latch_);
+    if (!page_map_dirty_ || page_map_.GetNumRetired() < min_retired) {
+      return;
+    }
+    entries = page_map_.Encode(&num_retired);
+    page_map_dirty_ = false;
+  }
+  // the map must not point to slots whose contents could still be lost
+  bool ok = fdatasync(db_fds_[0]) == 0 &&
+            WriteSideFile(page_map_name_, PAGE_MAP_MAGIC, static_cast<uint32_t>(entries.size()),
+                          reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(uint64_t));
+  std::scoped_lock lock(page_map_latch_);
+  if (!ok) {
+    LOG_DEBUG("I/O error while writing the page map");
+    page_map_dirty_ = true;
+    return;
+  }
+  page_map_.ReleaseRetired(num_retired);
+}
+
+uint64_t DiskManager::GetNumStoredBytes() {
+  std::scoped_lock lock(page_map_latch_);
+  return page_map_.GetStoredBytes();
+}
+
+std::vector<page_id_t> DiskManager::GetCorruptPages() {
+  std::scoped_lock lock(corrupt_latch_);
+  return std::vector<page_id_t>(corrupt_pages_.begin(), corrupt_pages_.end());
 }
 
 /**
@@ -150,16 +1158,12 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
 
   num_flushes_ += 1;
-  // sequence write
-  log_io_.write(log_data, size);
-
-  // check for I/O error
-  if (log_io_.bad()) {
+  // sequence write, then force it to the device: a commit is only as durable as its log record
+  if (!WriteFully(log_fd_, log_data, size, log_bytes_) || fdatasync(log_fd_) != 0) {
     LOG_DEBUG("I/O error while writing log");
     return;
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
+  log_bytes_ += size;
   flush_log_ = false;
 }
 
@@ -174,17 +1178,13 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
     // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
-
-  if (log_io_.bad()) {
+  ssize_t read_count = ReadFully(log_fd_, log_data, size, offset);
+  if (read_count < 0) {
     LOG_DEBUG("I/O error while reading log");
     return false;
   }
   // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
   if (read_count < size) {
-    log_io_.clear();
     memset(log_data + read_count, 0, size - read_count);
   }
 
@@ -201,6 +1201,11 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+/**
+ * Returns number of page reads made so far
+ */
+int DiskManager::GetNumReads() const { return num_reads_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
@@ -0,0 +1,184 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring.cpp
+//
+// Identification: src/storage/disk/io_uring.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/io_uring.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define BUSTUB_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace bustub {
+
+#ifdef BUSTUB_HAVE_IO_URING
+
+std::unique_ptr<IoUring> IoUring::Create(unsigned entries) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+  if (fd < 0) {
+    return nullptr;
+  }
+  std::unique_ptr<IoUring> ring(new IoUring());
+  ring->ring_fd_ = fd;
+
+  ring->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    ring->sq_ring_size_ = ring->cq_ring_size_ = std::max(ring->sq_ring_size_, ring->cq_ring_size_);
+  }
+  void *sq_ring = mmap(nullptr, ring->sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                       IORING_OFF_SQ_RING);
+  if (sq_ring == MAP_FAILED) {
+    return nullptr;
+  }
+  ring->sq_ring_ = sq_ring;
+  if (single_mmap) {
+    ring->cq_ring_ = sq_ring;
+  } else {
+    void *cq_ring = mmap(nullptr, ring->cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                         IORING_OFF_CQ_RING);
+    if (cq_ring == MAP_FAILED) {
+      return nullptr;
+    }
+    ring->cq_ring_ = cq_ring;
+  }
+  ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(nullptr, ring->sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                    IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    return nullptr;
+  }
+  ring->sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+  auto *sq = static_cast<char *>(ring->sq_ring_);
+  ring->sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  ring->sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  ring->sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  ring->sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  ring->sq_entries_ = params.sq_entries;
+  auto *cq = static_cast<char *>(ring->cq_ring_);
+  ring->cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  ring->cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  ring->cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  ring->cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  return ring;
+}
+
+IoUring::~IoUring() {
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+}
+
+bool IoUring::PrepareReadv(int fd, const iovec *iov, unsigned num_iov, off_t offset, uint64_t user_data) {
+  return Prepare(IORING_OP_READV, fd, iov, num_iov, offset, user_data);
+}
+
+bool IoUring::PrepareWritev(int fd, const iovec *iov, unsigned num_iov, off_t offset, uint64_t user_data) {
+  return Prepare(IORING_OP_WRITEV, fd, iov, num_iov, offset, user_data);
+}
+
+bool IoUring::Prepare(uint8_t opcode, int fd, const iovec *iov, unsigned num_iov, off_t offset,
+                      uint64_t user_data) {
+  // only we move the tail; the kernel moves the head as it consumes entries
+  unsigned tail = *sq_tail_;
+  if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) == sq_entries_) {
+    return false;
+  }
+  unsigned index = tail & sq_mask_;
+  io_uring_sqe *sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(iov);
+  sqe->len = num_iov;
+  sqe->off = static_cast<uint64_t>(offset);
+  sqe->user_data = user_data;
+  sq_array_[index] = index;
+  // publish the entry before the new tail
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  to_submit_++;
+  return true;
+}
+
+bool IoUring::Enter(unsigned min_completions) {
+  unsigned flags = min_completions > 0 ? IORING_ENTER_GETEVENTS : 0;
+  while (true) {
+    long ret = syscall(__NR_io_uring_enter, ring_fd_, to_submit_, min_completions, flags, nullptr, 0);  // NOLINT
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret < 0) {
+      return false;
+    }
+    to_submit_ -= static_cast<unsigned>(ret);
+    return true;
+  }
+}
+
+bool IoUring::NextCompletion(uint64_t *user_data, int *result) {
+  unsigned head = *cq_head_;
+  if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+    return false;
+  }
+  const io_uring_cqe &cqe = cqes_[head & cq_mask_];
+  *user_data = cqe.user_data;
+  *result = cqe.res;
+  // hand the slot back to the kernel only after reading it
+  __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+#else
+
+std::unique_ptr<IoUring> IoUring::Create(unsigned entries) { return nullptr; }
+
+IoUring::~IoUring() = default;
+
+bool IoUring::PrepareReadv(int fd, const iovec *iov, unsigned num_iov, off_t offset, uint64_t user_data) {
+  return false;
+}
+
+bool IoUring::PrepareWritev(int fd, const iovec *iov, unsigned num_iov, off_t offset, uint64_t user_data) {
+  return false;
+}
+
+bool IoUring::Prepare(uint8_t opcode, int fd, const iovec *iov, unsigned num_iov, off_t offset,
+                      uint64_t user_data) {
+  return false;
+}
+
+bool IoUring::Enter(unsigned min_completions) { return false; }
+
+bool IoUring::NextCompletion(uint64_t *user_data, int *result) { return false; }
+
+#endif
+
+}  // namespace bustub
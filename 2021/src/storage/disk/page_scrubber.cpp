@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_scrubber.cpp
+//
+// Identification: src/storage/disk/page_scrubber.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_scrubber.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <unordered_set>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+namespace bustub {
+
+PageScrubber::PageScrubber(DiskManager *disk_manager, BufferPoolManager *bpm)
+    : disk_manager_(disk_manager), bpm_(bpm) {}
+
+PageScrubber::~PageScrubber() { Stop(); }
+
+void PageScrubber::Start(const PageScrubberConfig &config) {
+  std::scoped_lock lock(latch_);
+  if (running_) {
+    return;
+  }
+  running_ = true;
+  thread_ = new std::thread([this, config] {
+    if (config.low_priority_) {
+      LowerPriority();
+    }
+    std::unique_lock scrubber_lock(latch_);
+    while (running_) {
+      scrubber_lock.unlock();
+      ScrubRound(config.pages_per_round_);
+      scrubber_lock.lock();
+      cv_.wait_for(scrubber_lock, config.interval_, [this] { return !running_; });
+    }
+  });
+}
+
+void PageScrubber::Stop() {
+  {
+    std::scoped_lock lock(latch_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+  }
+  cv_.notify_all();
+  thread_->join();
+  delete thread_;
+  thread_ = nullptr;
+}
+
+size_t PageScrubber::ScrubRound(size_t max_pages) {
+  std::scoped_lock lock(round_latch_);
+  page_id_t limit = disk_manager_->GetPageIdLimit();
+  if (limit == 0 || !disk_manager_->UsesChecksums()) {
+    return 0;
+  }
+  std::unordered_set<page_id_t> resident;
+  if (bpm_ != nullptr) {
+    std::vector<page_id_t> resident_pages = bpm_->GetResidentPages();
+    resident.insert(resident_pages.begin(), resident_pages.end());
+  }
+  // look at no more than one pass worth of page ids, so that a file of free or resident pages ends the round
+  size_t scrubbed = 0;
+  for (page_id_t looked_at = 0; looked_at < limit && scrubbed < max_pages; looked_at++) {
+    if (cursor_ >= limit) {
+      cursor_ = 0;
+      passes_++;
+    }
+    page_id_t page_id = cursor_++;
+    if (!disk_manager_->IsAllocated(page_id) || resident.count(page_id) > 0) {
+      continue;
+    }
+    disk_manager_->VerifyPage(page_id);
+    scrubbed++;
+  }
+  scrubbed_ += scrubbed;
+  return scrubbed;
+}
+
+void PageScrubber::LowerPriority() {
+#ifdef __linux__
+  // both are per thread on Linux, even though the API speaks of processes
+  auto tid = static_cast<id_t>(syscall(SYS_gettid));
+  setpriority(PRIO_PROCESS, tid, 19);
+  // ioprio_set(IOPRIO_WHO_PROCESS, tid, IOPRIO_PRIO_VALUE(IOPRIO_CLASS_IDLE, 0)); glibc has no wrapper
+  const int ioprio_who_process = 1;
+  const int ioprio_class_idle = 3;
+  const int ioprio_class_shift = 13;
+  syscall(SYS_ioprio_set, ioprio_who_process, tid, ioprio_class_idle << ioprio_class_shift);
+#endif
+}
+
+}  // namespace bustub
@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tablespace.cpp
+//
+// Identification: src/storage/disk/tablespace.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/tablespace.h"
+
+#include <algorithm>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+Tablespace::Tablespace(uint32_t num_files, StripeLayout layout, page_id_t stripe_pages)
+    : num_files_(num_files), layout_(layout), stripe_pages_(stripe_pages) {
+  BUSTUB_ASSERT(num_files > 0, "a tablespace has at least one file");
+  BUSTUB_ASSERT(stripe_pages > 0, "a stripe has at least one page");
+}
+
+page_id_t Tablespace::GetPageId(uint32_t file, page_id_t file_page) const {
+  if (num_files_ == 1) {
+    return file_page;
+  }
+  if (layout_ == StripeLayout::RANGE) {
+    return static_cast<page_id_t>(file) * stripe_pages_ + file_page;
+  }
+  page_id_t stripe = file_page / stripe_pages_ * static_cast<page_id_t>(num_files_) + static_cast<page_id_t>(file);
+  return stripe * stripe_pages_ + file_page % stripe_pages_;
+}
+
+page_id_t Tablespace::GetPageIdLimit(const std::vector<page_id_t> &file_pages) const {
+  page_id_t limit = 0;
+  for (uint32_t file = 0; file < num_files_ && file < file_pages.size(); file++) {
+    if (file_pages[file] > 0) {
+      limit = std::max(limit, GetPageId(file, file_pages[file] - 1) + 1);
+    }
+  }
+  return limit;
+}
+
+page_id_t Tablespace::GetFilePages(uint32_t file, page_id_t limit) const {
+  if (num_files_ == 1) {
+    return limit;
+  }
+  if (layout_ == StripeLayout::RANGE) {
+    page_id_t pages = std::max(0, limit - static_cast<page_id_t>(file) * stripe_pages_);
+    return file + 1 < num_files_ ? std::min(pages, stripe_pages_) : pages;
+  }
+  // whole stripes below limit, dealt out in turn, and then the partial stripe limit falls into
+  page_id_t whole_stripes = limit / stripe_pages_;
+  auto files = static_cast<page_id_t>(num_files_);
+  page_id_t pages = (whole_stripes / files + (static_cast<page_id_t>(file) < whole_stripes % files ? 1 : 0)) *
+                    stripe_pages_;
+  if (whole_stripes % files == static_cast<page_id_t>(file)) {
+    pages += limit % stripe_pages_;
+  }
+  return pages;
+}
+
+}  // namespace bustub
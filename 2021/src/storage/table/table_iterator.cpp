@@ -10,16 +10,17 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
 
 #include "storage/table/table_heap.h"
 
 namespace bustub {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy)
+    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn), strategy_(strategy) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
-    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
+    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, strategy_);
   }
 }
 
@@ -35,7 +36,7 @@ Tuple *TableIterator::operator->() {
 
 TableIterator &TableIterator::operator++() {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
+  auto cur_page = static_cast<TablePage *>(table_heap_->FetchPage(tuple_->rid_.GetPageId(), strategy_));
   cur_page->RLatch();
   assert(cur_page != nullptr);  // all pages are pinned
 
@@ -43,11 +44,12 @@ TableIterator &TableIterator::operator++() {
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+      auto next_page = static_cast<TablePage *>(table_heap_->FetchPage(cur_page->GetNextPageId(), strategy_));
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
       cur_page = next_page;
       cur_page->RLatch();
+      ReadAhead(cur_page);
       if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
@@ -56,7 +58,7 @@ TableIterator &TableIterator::operator++() {
   tuple_->rid_ = next_tuple_rid;
 
   if (*this != table_heap_->End()) {
-    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
+    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, strategy_);
   }
   // release until copy the tuple
   cur_page->RUnlatch();
@@ -64,6 +66,24 @@ TableIterator &TableIterator::operator++() {
   return *this;
 }
 
+void TableIterator::ReadAhead(TablePage *page) {
+  // no further than the pool can hold pages ahead of the scan without recycling them first
+  size_t read_ahead =
+      std::min(table_heap_->read_ahead_pages_, table_heap_->buffer_pool_manager_->GetMaxPrefetchDepth());
+  // A scan that just spills over into a second page may well stop there, so start on the third page. The window
+  // doubles with every request until it reaches the configured distance, and the next request is only sent once
+  // the scan has used up half of the current window: the prefetcher walks the already resident part of a chain
+  // again, and this keeps that to about one extra look per page.
+  if (read_ahead == 0 || ++sequential_pages_ < 2 || sequential_pages_ < next_read_ahead_) {
+    return;
+  }
+  read_ahead_window_ = std::min(read_ahead, std::max<size_t>(2, 2 * read_ahead_window_));
+  next_read_ahead_ = sequential_pages_ + std::max<size_t>(1, read_ahead_window_ / 2);
+  table_heap_->buffer_pool_manager_->PrefetchChain(page->GetNextPageId(), read_ahead_window_, [](Page *next) {
+    return reinterpret_cast<TablePage *>(next)->GetNextPageId();
+  });
+}
+
 TableIterator TableIterator::operator++(int) {
   TableIterator clone(*this);
   ++(*this);
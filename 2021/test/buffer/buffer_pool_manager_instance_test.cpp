@@ -11,10 +11,23 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <cstring>
+#include <iostream>
 #include <random>
+#include <set>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
@@ -141,4 +154,924 @@ TEST(BufferPoolManagerInstanceTest, DISABLED_SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FullyPinnedTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: Fill the pool with pinned pages.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(static_cast<page_id_t>(i), page_id_temp);
+  }
+
+  // Scenario: Every frame is pinned, so neither a new page nor a miss can be served. Failed allocations must not
+  // consume page ids.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(nullptr, bpm->FetchPage(static_cast<page_id_t>(buffer_pool_size + i)));
+  }
+
+  // Scenario: Pinned pages are still hits, and pinning them again does not free anything up.
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(2, page->GetPinCount());
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: Dropping the last pin on one page frees exactly one frame.
+  EXPECT_TRUE(bpm->UnpinPage(4, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(static_cast<page_id_t>(buffer_pool_size), page_id_temp);
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(nullptr, bpm->FetchPage(4));
+
+  // Scenario: Deleting an unpinned page hands its frame back to the free list.
+  EXPECT_TRUE(bpm->UnpinPage(static_cast<page_id_t>(buffer_pool_size), false));
+  EXPECT_TRUE(bpm->DeletePage(static_cast<page_id_t>(buffer_pool_size)));
+  EXPECT_NE(nullptr, bpm->FetchPage(4));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// Many threads missing on a small pool: every fetch must see the latest contents of the page, even while its
+// previous frame is still being written back or another thread is reading it in.
+static void RunConcurrentMiss(ReplacerPolicy replacer_policy) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 32;
+  const int num_threads = 8;
+  const int ops_per_thread = 2000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, replacer_policy);
+
+  // Each page holds its own id followed by a counter.
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    reinterpret_cast<int *>(page->GetData())[0] = page_id_temp;
+    bpm->UnpinPage(page_id_temp, true);
+  }
+
+  std::atomic<int> increments = 0;
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid, &increments] {
+      std::mt19937 rng(tid);
+      std::uniform_int_distribution<page_id_t> page_dist(0, num_pages - 1);
+      for (int i = 0; i < ops_per_thread; ++i) {
+        page_id_t page_id = page_dist(rng);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          // all frames momentarily pinned by the other threads
+          continue;
+        }
+        page->WLatch();
+        auto *data = reinterpret_cast<int *>(page->GetData());
+        EXPECT_EQ(page_id, data[0]);
+        data[1]++;
+        page->WUnlatch();
+        increments++;
+        bpm->UnpinPage(page_id, true);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Cycle every page through the pool once more; no increment may have been lost to a stale read.
+  int total = 0;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, reinterpret_cast<int *>(page->GetData())[0]);
+    total += reinterpret_cast<int *>(page->GetData())[1];
+    bpm->UnpinPage(i, false);
+  }
+  EXPECT_EQ(increments, total);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentMissTest) { RunConcurrentMiss(ReplacerPolicy::LRU); }
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ClockConcurrentMissTest) { RunConcurrentMiss(ReplacerPolicy::CLOCK); }
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, LRUKConcurrentMissTest) { RunConcurrentMiss(ReplacerPolicy::LRU_K); }
+
+// NOLINTNEXTLINE
+// A bulk scan and a bulk load through access strategies must leave the rest of the pool alone.
+TEST(BufferPoolManagerInstanceTest, AccessStrategyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const page_id_t num_hot_pages = 16;
+  const page_id_t num_pages = 256;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    snprintf(bpm->FetchPage(page_id_temp)->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    bpm->UnpinPage(page_id_temp, true);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+  auto touch_hot_pages = [bpm] {
+    for (page_id_t i = 0; i < num_hot_pages; ++i) {
+      ASSERT_NE(nullptr, bpm->FetchPage(i));
+      bpm->UnpinPage(i, false);
+    }
+  };
+  touch_hot_pages();
+
+  // Scenario: A scan through a BULK_READ strategy cycles through its small ring only.
+  BufferAccessStrategy scan(BufferAccessType::BULK_READ, bpm->GetPoolSize());
+  EXPECT_EQ(buffer_pool_size / 8, scan.GetRingSize());
+  for (page_id_t i = num_hot_pages; i < num_pages; ++i) {
+    auto *page = bpm->FetchPage(i, scan);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(i)).c_str()));
+    bpm->UnpinPage(i, false);
+  }
+  int reads = disk_manager->GetNumReads();
+  touch_hot_pages();
+  EXPECT_EQ(reads, disk_manager->GetNumReads());
+
+  // Scenario: So does a bulk load through a BULK_WRITE strategy, and every new page makes it to disk.
+  BufferAccessStrategy load(BufferAccessType::BULK_WRITE, bpm->GetPoolSize());
+  std::vector<page_id_t> loaded;
+  for (int i = 0; i < 4 * static_cast<int>(buffer_pool_size); ++i) {
+    auto *page = bpm->NewPage(&page_id_temp, load);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    bpm->UnpinPage(page_id_temp, true);
+    loaded.push_back(page_id_temp);
+  }
+  reads = disk_manager->GetNumReads();
+  touch_hot_pages();
+  EXPECT_EQ(reads, disk_manager->GetNumReads());
+  for (page_id_t page_id : loaded) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_id)).c_str()));
+    bpm->UnpinPage(page_id, false);
+  }
+
+  // Scenario: Without a strategy the same scan pushes the hot pages out.
+  for (page_id_t i = num_hot_pages; i < num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    bpm->UnpinPage(i, false);
+  }
+  reads = disk_manager->GetNumReads();
+  touch_hot_pages();
+  EXPECT_EQ(reads + num_hot_pages, disk_manager->GetNumReads());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Under LRU-K a ring frame that is reused must not pile up the references of the pages that passed through it.
+TEST(BufferPoolManagerInstanceTest, LRUKAccessStrategyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const page_id_t num_pinned_pages = 13;
+  const page_id_t hot_page = num_pinned_pages;
+  const page_id_t num_pages = 64;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerPolicy::LRU_K);
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    bpm->UnpinPage(page_id_temp, true);
+  }
+  // each hit on a pinned page is one more tick of the replacer's clock, and pulls no other frame in
+  std::vector<page_id_t> pinned;
+  for (page_id_t i = 0; i < num_pinned_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    pinned.push_back(i);
+  }
+  auto tick = [bpm, &pinned](int ticks) {
+    for (int i = 0; i < ticks; ++i) {
+      ASSERT_NE(nullptr, bpm->FetchPage(pinned[i % pinned.size()]));
+      bpm->UnpinPage(pinned[i % pinned.size()], false);
+    }
+  };
+
+  // Scenario: The hot page is referenced twice, far enough apart that the references are not correlated.
+  ASSERT_NE(nullptr, bpm->FetchPage(hot_page));
+  bpm->UnpinPage(hot_page, false);
+  tick(32);
+  ASSERT_NE(nullptr, bpm->FetchPage(hot_page));
+  bpm->UnpinPage(hot_page, false);
+
+  // Scenario: A scan cycles through the two frames left, with plenty of other references between two reuses of the
+  // same ring frame. Every page of the scan is referenced once, so each one stays behind the hot page.
+  BufferAccessStrategy scan(BufferAccessType::BULK_READ, bpm->GetPoolSize());
+  ASSERT_EQ(2, scan.GetRingSize());
+  for (page_id_t i = hot_page + 1; i < num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i, scan));
+    bpm->UnpinPage(i, false);
+    tick(16);
+  }
+
+  // Scenario: Misses outside the ring evict the pages the scan left behind, never the hot page.
+  for (page_id_t i = hot_page + 1; i < hot_page + 3; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    bpm->UnpinPage(i, false);
+  }
+  int reads = disk_manager->GetNumReads();
+  ASSERT_NE(nullptr, bpm->FetchPage(hot_page));
+  bpm->UnpinPage(hot_page, false);
+  EXPECT_EQ(reads, disk_manager->GetNumReads());
+
+  for (page_id_t page_id : pinned) {
+    bpm->UnpinPage(page_id, false);
+  }
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const page_id_t num_pages = 32;
+
+  // Every page stores the id of the page after it, like a table heap.
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    reinterpret_cast<page_id_t *>(page->GetData())[0] = i + 1 < num_pages ? i + 1 : INVALID_PAGE_ID;
+    bpm->UnpinPage(page_id_temp, true);
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+
+  // Start from a cold pool.
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  auto wait_for_prefetches = [&bpm](uint64_t count) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (bpm->GetPrefetchCount() < count && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(count, bpm->GetPrefetchCount());
+  };
+  auto expect_resident = [&bpm, disk_manager](page_id_t page_id, bool resident) {
+    int reads = disk_manager->GetNumReads();
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(resident ? reads : reads + 1, disk_manager->GetNumReads()) << "page " << page_id;
+    bpm->UnpinPage(page_id, false);
+  };
+
+  // Scenario: Explicit prefetches are read in the background and later fetches hit.
+  int reads = disk_manager->GetNumReads();
+  bpm->PrefetchPages({0, 1, 2, 3});
+  wait_for_prefetches(4);
+  EXPECT_EQ(reads + 4, disk_manager->GetNumReads());
+  for (page_id_t i = 0; i < 4; ++i) {
+    expect_resident(i, true);
+  }
+
+  // Scenario: A chain follows the next pointers for exactly depth pages.
+  bpm->PrefetchChain(10, 5, [](Page *page) { return reinterpret_cast<page_id_t *>(page->GetData())[0]; });
+  wait_for_prefetches(9);
+  for (page_id_t i = 10; i < 15; ++i) {
+    expect_resident(i, true);
+  }
+  expect_resident(15, false);
+
+  // Scenario: A chain stops at its end.
+  bpm->PrefetchChain(num_pages - 2, 8, [](Page *page) { return reinterpret_cast<page_id_t *>(page->GetData())[0]; });
+  wait_for_prefetches(11);
+
+  // Scenario: A chain is cut to a quarter of the pool, so its pages are still resident when the scan gets there.
+  EXPECT_EQ(buffer_pool_size / 4, bpm->GetMaxPrefetchDepth());
+  delete bpm;
+  bpm = new BufferPoolManagerInstance(10, disk_manager);
+  EXPECT_EQ(2, bpm->GetMaxPrefetchDepth());
+  bpm->PrefetchChain(0, 8, [](Page *page) { return reinterpret_cast<page_id_t *>(page->GetData())[0]; });
+  wait_for_prefetches(2);
+  expect_resident(0, true);
+  expect_resident(1, true);
+  expect_resident(2, false);
+
+  // Scenario: A pool that cannot spare two frames does not read ahead at all.
+  delete bpm;
+  bpm = new BufferPoolManagerInstance(4, disk_manager);
+  EXPECT_EQ(0, bpm->GetMaxPrefetchDepth());
+  bpm->PrefetchPages({0, 1});
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(0, bpm->GetPrefetchCount());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PageCleanerTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: Fill the pool with dirty, unpinned pages.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: The cleaner writes them out in the background, a few pages per round.
+  PageCleanerConfig config;
+  config.interval_ = std::chrono::milliseconds(1);
+  config.max_writes_per_round_ = 3;
+  config.clean_watermark_ = buffer_pool_size;
+  bpm->RunPageCleaner(config);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (bpm->GetBackgroundWriteCount() < buffer_pool_size && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  bpm->StopPageCleaner();
+  EXPECT_EQ(buffer_pool_size, bpm->GetBackgroundWriteCount());
+
+  // Scenario: Evicting the cleaned pages costs the foreground no writes, and their contents survived.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(0, bpm->GetForegroundWriteCount());
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, WarmUpTest) {
+  const std::string db_name = "test.db";
+  const std::string warm_up_name = "test.warmup";
+  const size_t buffer_pool_size = 10;
+  const page_id_t num_pages = 30;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+  // Scenario: Touch ten pages in a known order (most recent last) and keep the hottest one pinned.
+  std::vector<page_id_t> touched = {25, 3, 17, 8, 29, 0, 12, 21, 6, 14};
+  for (page_id_t page_id : touched) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    bpm->UnpinPage(page_id, false);
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(14));
+  std::vector<page_id_t> hot_first(touched.rbegin(), touched.rend());
+  EXPECT_EQ(hot_first, bpm->GetResidentPages());
+  ASSERT_TRUE(bpm->DumpResidentPages(warm_up_name));
+  bpm->UnpinPage(14, false);
+  bpm->FlushAllPages();
+  delete bpm;
+
+  // Scenario: A restarted pool reads the whole set back up front; afterwards fetching it costs no reads.
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  int reads = disk_manager->GetNumReads();
+  EXPECT_EQ(buffer_pool_size, bpm->WarmUp(warm_up_name));
+  EXPECT_EQ(reads + static_cast<int>(buffer_pool_size), disk_manager->GetNumReads());
+  for (page_id_t page_id : touched) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    bpm->UnpinPage(page_id, false);
+  }
+  EXPECT_EQ(reads + static_cast<int>(buffer_pool_size), disk_manager->GetNumReads());
+  delete bpm;
+
+  // Scenario: A smaller pool gets the hottest pages, and the replacer ranks them as before: the coldest goes first.
+  bpm = new BufferPoolManagerInstance(buffer_pool_size / 2, disk_manager);
+  EXPECT_EQ(buffer_pool_size / 2, bpm->WarmUp(warm_up_name));
+  EXPECT_EQ(std::vector<page_id_t>(hot_first.begin(), hot_first.begin() + buffer_pool_size / 2),
+            bpm->GetResidentPages());
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  bpm->UnpinPage(1, false);
+  std::vector<page_id_t> resident = bpm->GetResidentPages();
+  EXPECT_EQ(resident.end(), std::find(resident.begin(), resident.end(), hot_first[buffer_pool_size / 2 - 1]));
+  delete bpm;
+
+  // Scenario: Missing or foreign files load nothing.
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  EXPECT_EQ(0, bpm->WarmUp("no_such_file.warmup"));
+  EXPECT_EQ(0, bpm->WarmUp(db_name));
+  EXPECT_TRUE(bpm->GetResidentPages().empty());
+  delete bpm;
+
+  // Scenario: A parallel pool dumps every instance's pages and warms up through its instances.
+  auto *pbpm = new ParallelBufferPoolManager(2, buffer_pool_size / 2, disk_manager);
+  for (page_id_t page_id : touched) {
+    ASSERT_NE(nullptr, pbpm->FetchPage(page_id));
+    pbpm->UnpinPage(page_id, false);
+  }
+  ASSERT_TRUE(pbpm->DumpResidentPages(warm_up_name));
+  delete pbpm;
+  pbpm = new ParallelBufferPoolManager(2, buffer_pool_size / 2, disk_manager);
+  EXPECT_EQ(buffer_pool_size, pbpm->WarmUp(warm_up_name));
+  std::vector<page_id_t> warm = pbpm->GetResidentPages();
+  std::sort(warm.begin(), warm.end());
+  std::vector<page_id_t> expected = touched;
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(expected, warm);
+  delete pbpm;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove(warm_up_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BatchFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const page_id_t num_pages = 30;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+
+  // Scenario: A batch mixes hits, misses and a repeated id. Each distinct miss is read once, and every occurrence
+  // holds its own pin.
+  std::vector<page_id_t> batch = {25, 7, 3, 29, 3, 11};
+  std::vector<Page *> pages(batch.size());
+  int reads = disk_manager->GetNumReads();
+  EXPECT_EQ(batch.size(), bpm->FetchPages(batch.data(), batch.size(), pages.data()));
+  EXPECT_EQ(reads + 3, disk_manager->GetNumReads());
+  for (size_t i = 0; i < batch.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(batch[i], pages[i]->GetPageId());
+    EXPECT_EQ("page " + std::to_string(batch[i]), std::string(pages[i]->GetData()));
+  }
+  EXPECT_EQ(pages[2], pages[4]);
+  EXPECT_EQ(2, pages[2]->GetPinCount());
+  BufferPoolStats stats = bpm->GetStats();
+  EXPECT_EQ(3, stats.misses_);
+  EXPECT_EQ(3, stats.hits_);
+
+  // Scenario: Unpinning the batch makes every frame evictable again; one more unpin of page 3 is one too many.
+  EXPECT_TRUE(bpm->UnpinPages(batch.data(), batch.size(), false));
+  EXPECT_EQ(0, pages[2]->GetPinCount());
+  EXPECT_EQ(0, bpm->GetStats().pinned_frames_);
+  std::vector<page_id_t> again = {3, 25};
+  EXPECT_FALSE(bpm->UnpinPages(again.data(), again.size(), false));
+
+  // Scenario: With only two frames left unpinned, the first two misses of the batch get them and the rest fail.
+  std::vector<page_id_t> pinned = {20, 21, 22, 23, 24, 26, 27, 28};
+  pages.resize(pinned.size());
+  EXPECT_EQ(pinned.size(), bpm->FetchPages(pinned.data(), pinned.size(), pages.data()));
+  std::vector<page_id_t> misses = {0, 1, 2, 4};
+  pages.resize(misses.size());
+  EXPECT_EQ(2, bpm->FetchPages(misses.data(), misses.size(), pages.data()));
+  EXPECT_NE(nullptr, pages[0]);
+  EXPECT_NE(nullptr, pages[1]);
+  EXPECT_EQ(nullptr, pages[2]);
+  EXPECT_EQ(nullptr, pages[3]);
+  EXPECT_EQ(2, bpm->GetStats().fetch_failures_);
+  EXPECT_TRUE(bpm->UnpinPages(misses.data(), 2, true));
+  EXPECT_TRUE(bpm->UnpinPages(pinned.data(), pinned.size(), false));
+
+  // Scenario: Dirty pages unpinned through a batch are written back when evicted.
+  pages.resize(1);
+  ASSERT_EQ(1, bpm->FetchPages(misses.data(), 1, pages.data()));
+  snprintf(pages[0]->GetData(), PAGE_SIZE, "changed");
+  EXPECT_TRUE(bpm->UnpinPages(misses.data(), 1, true));
+  std::vector<page_id_t> others = {10, 12, 13, 14, 15, 16, 17, 18, 19, 5};
+  pages.resize(others.size());
+  EXPECT_EQ(others.size(), bpm->FetchPages(others.data(), others.size(), pages.data()));
+  EXPECT_TRUE(bpm->UnpinPages(others.data(), others.size(), false));
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("changed", std::string(page->GetData()));
+  bpm->UnpinPage(0, false);
+
+  // Scenario: Concurrent batches over a pool much smaller than the page set; every page comes back intact.
+  const int num_threads = 4;
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid] {
+      std::mt19937 rng(tid);
+      std::uniform_int_distribution<page_id_t> dist(1, num_pages - 1);
+      for (int round = 0; round < 200; ++round) {
+        std::vector<page_id_t> ids(1 + rng() % 3);
+        for (auto &id : ids) {
+          id = dist(rng);
+        }
+        std::vector<Page *> fetched(ids.size());
+        bpm->FetchPages(ids.data(), ids.size(), fetched.data());
+        for (size_t i = 0; i < ids.size(); ++i) {
+          if (fetched[i] != nullptr) {
+            EXPECT_EQ("page " + std::to_string(ids[i]), std::string(fetched[i]->GetData()));
+            bpm->UnpinPage(ids[i], false);
+          }
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, bpm->GetStats().pinned_frames_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BatchUnpinDeleteTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const page_id_t num_pages = 8;
+  remove("test.fsm");
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: Batches are unpinned while another thread deletes the very pages they drop. A deleted page's frame
+  // goes to the free list and must not also reach the replacer, or it is handed out twice and two pages share it.
+  // Deleting only frees the ids on disk, so every page fetched again still reads back what was flushed.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 2; ++tid) {
+    threads.emplace_back([bpm, tid] {
+      std::mt19937 rng(tid);
+      for (int round = 0; round < 1000; ++round) {
+        std::vector<page_id_t> ids = {static_cast<page_id_t>(rng() % num_pages),
+                                      static_cast<page_id_t>(rng() % num_pages)};
+        std::vector<Page *> fetched(ids.size());
+        bpm->FetchPages(ids.data(), ids.size(), fetched.data());
+        std::vector<page_id_t> unpin;
+        for (size_t i = 0; i < ids.size(); ++i) {
+          if (fetched[i] != nullptr) {
+            EXPECT_EQ(ids[i], fetched[i]->GetPageId());
+            EXPECT_EQ("page " + std::to_string(ids[i]), std::string(fetched[i]->GetData()));
+            unpin.push_back(ids[i]);
+          }
+        }
+        EXPECT_TRUE(bpm->UnpinPages(unpin.data(), unpin.size(), false));
+      }
+    });
+  }
+  threads.emplace_back([bpm] {
+    for (int round = 0; round < 2000; ++round) {
+      bpm->DeletePage(round % num_pages);
+    }
+  });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, bpm->GetStats().pinned_frames_);
+
+  // Scenario: Every frame is still handed out exactly once. Once all pages are gone, so that no new page reuses the
+  // id of one still resident, the pool fills up with distinct frames and then is full.
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    EXPECT_TRUE(bpm->DeletePage(i));
+  }
+  std::set<Page *> frames;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_TRUE(frames.insert(page).second);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DeletePageReuseTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  remove("test.fsm");
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  for (page_id_t i = 0; i < 10; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+
+  // Scenario: Deleting frees the page on disk, whether it is resident (8) or not (1); a pinned page stays.
+  ASSERT_NE(nullptr, bpm->FetchPage(3));
+  EXPECT_FALSE(bpm->DeletePage(3));
+  EXPECT_TRUE(bpm->DeletePage(8));
+  EXPECT_TRUE(bpm->DeletePage(1));
+  EXPECT_TRUE(bpm->UnpinPage(3, false));
+  EXPECT_EQ(8, disk_manager->GetNumAllocatedPages());
+
+  // Scenario: New pages reuse the freed ids, zeroed, before growing the file.
+  for (page_id_t expected : {1, 8, 10}) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(expected, page_id);
+    EXPECT_EQ(0, page->GetData()[0]);
+    bpm->UnpinPage(page_id, false);
+  }
+
+  // Scenario: The allocation state outlives the pool and the disk manager.
+  EXPECT_TRUE(bpm->DeletePage(4));
+  bpm->FlushAllPages();
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+  disk_manager = new DiskManager(db_name);
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (page_id_t expected : {4, 11}) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(expected, page_id);
+    bpm->UnpinPage(page_id, false);
+  }
+  auto *page = bpm->FetchPage(9);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("page 9", std::string(page->GetData()));
+  bpm->UnpinPage(9, false);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Measures the cost of a buffer pool miss (evict + read) as the pool grows. The miss path should not depend on the
+// pool size, so the per-fetch latency is expected to stay flat across the rows.
+TEST(BufferPoolManagerInstanceTest, DISABLED_MissPathBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t num_fetches = 20000;
+
+  for (size_t buffer_pool_size : {1024, 4096, 16384}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+    // Twice as many pages as frames, so a sequential sweep over them misses on every fetch.
+    const auto num_pages = static_cast<page_id_t>(buffer_pool_size * 2);
+    page_id_t page_id_temp;
+    for (page_id_t i = 0; i < num_pages; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      bpm->UnpinPage(page_id_temp, false);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_fetches; ++i) {
+      auto page_id = static_cast<page_id_t>(i % num_pages);
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      bpm->UnpinPage(page_id, false);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "pool_size=" << buffer_pool_size << " miss_ns_per_fetch=" << elapsed.count() / num_fetches
+              << std::endl;
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// Every thread fetches and unpins random resident pages for a fixed number of operations; returns hits per second.
+static double RunHitBenchmark(BufferPoolManager *bpm, page_id_t num_pages, size_t num_threads, size_t ops_per_thread) {
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, num_pages, ops_per_thread, tid] {
+      std::mt19937 rng(tid);
+      std::uniform_int_distribution<page_id_t> page_dist(0, num_pages - 1);
+      for (size_t i = 0; i < ops_per_thread; ++i) {
+        page_id_t page_id = page_dist(rng);
+        EXPECT_NE(nullptr, bpm->FetchPage(page_id));
+        bpm->UnpinPage(page_id, false);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(num_threads * ops_per_thread) / elapsed.count();
+}
+
+// NOLINTNEXTLINE
+// Multi-threaded buffer hits: a single instance with the striped page table against a parallel BPM of equal size.
+TEST(BufferPoolManagerInstanceTest, DISABLED_ConcurrentHitBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4096;
+  const size_t num_instances = 8;
+  const size_t ops_per_thread = 200000;
+
+  for (size_t num_threads : {1, 2, 4, 8, 16}) {
+    // one file per pool: a disk manager allocates page ids for a single partitioning
+    auto *disk_manager = new DiskManager(db_name);
+    auto *parallel_disk_manager = new DiskManager("test_parallel.db");
+    auto *bpi = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    auto *pbpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size / num_instances, parallel_disk_manager);
+
+    // Both pools hold the same page ids and are fully resident, so every fetch is a hit.
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      ASSERT_NE(nullptr, bpi->NewPage(&page_id_temp));
+      bpi->UnpinPage(page_id_temp, false);
+      ASSERT_NE(nullptr, pbpm->NewPage(&page_id_temp));
+      pbpm->UnpinPage(page_id_temp, false);
+    }
+
+    auto num_pages = static_cast<page_id_t>(buffer_pool_size);
+    double bpi_rate = RunHitBenchmark(bpi, num_pages, num_threads, ops_per_thread);
+    double pbpm_rate = RunHitBenchmark(pbpm, num_pages, num_threads, ops_per_thread);
+    std::cout << "threads=" << num_threads << " instance_hits_per_sec=" << static_cast<uint64_t>(bpi_rate)
+              << " parallel_hits_per_sec=" << static_cast<uint64_t>(pbpm_rate) << std::endl;
+
+    disk_manager->ShutDown();
+    parallel_disk_manager->ShutDown();
+    remove("test.db");
+    remove("test_parallel.db");
+    delete pbpm;
+    delete bpi;
+    delete parallel_disk_manager;
+    delete disk_manager;
+  }
+}
+
+// Resident set size of this process, in bytes.
+static size_t ResidentBytes() {
+  size_t total_pages = 0;
+  size_t resident_pages = 0;
+  FILE *statm = fopen("/proc/self/statm", "r");
+  if (statm != nullptr) {
+    if (fscanf(statm, "%zu %zu", &total_pages, &resident_pages) != 2) {
+      resident_pages = 0;
+    }
+    fclose(statm);
+  }
+  return resident_pages * sysconf(_SC_PAGESIZE);
+}
+
+// Bytes of a file held in the OS page cache.
+static size_t PageCacheBytes(const std::string &file_name) {
+  struct stat stat_buf;
+  if (stat(file_name.c_str(), &stat_buf) != 0 || stat_buf.st_size == 0) {
+    return 0;
+  }
+  auto file_bytes = static_cast<size_t>(stat_buf.st_size);
+  int fd = open(file_name.c_str(), O_RDONLY);
+  void *mapping = mmap(nullptr, file_bytes, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return 0;
+  }
+  size_t os_page = sysconf(_SC_PAGESIZE);
+  std::vector<unsigned char> in_core((file_bytes + os_page - 1) / os_page);
+  size_t cached = 0;
+  if (mincore(mapping, file_bytes, in_core.data()) == 0) {
+    for (unsigned char flags : in_core) {
+      cached += flags & 1;
+    }
+  }
+  munmap(mapping, file_bytes);
+  return cached * os_page;
+}
+
+// NOLINTNEXTLINE
+// Buffered against direct I/O at (roughly) equal memory. The database is four times the memory budget and 90% of the
+// fetches go to a hot set that is three quarters of the budget. Buffered I/O gets a pool of half the budget, leaving
+// the other half to the page cache (which the kernel does not actually cap, so its real footprint is printed too);
+// direct I/O gets the whole budget as pool. Each row prints fetch throughput, the growth of the process RSS, and how
+// much of the file ended up in the page cache.
+TEST(BufferPoolManagerInstanceTest, DISABLED_DirectIoBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t budget_frames = 4096;
+  const auto num_pages = static_cast<page_id_t>(budget_frames * 4);
+  const auto hot_pages = static_cast<page_id_t>(budget_frames * 3 / 4);
+  const size_t warm_up_fetches = 100000;
+  const size_t num_fetches = 400000;
+
+  {
+    DiskManager disk_manager(db_name);
+    std::vector<char> data(PAGE_SIZE, 0);
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      disk_manager.WritePage(page_id, data.data());
+    }
+    disk_manager.Sync();
+    disk_manager.ShutDown();
+  }
+
+  for (bool direct_io : {false, true}) {
+    // every run starts with nothing of the file cached
+    int fd = open(db_name.c_str(), O_RDONLY);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+
+    size_t rss_before = ResidentBytes();
+    DiskManagerOptions options;
+    options.direct_io_ = direct_io;
+    auto *disk_manager = new DiskManager(db_name, options);
+    size_t pool_size = direct_io ? budget_frames : budget_frames / 2;
+    auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager);
+
+    std::mt19937 rng(15445);
+    std::uniform_int_distribution<page_id_t> hot_dist(0, hot_pages - 1);
+    std::uniform_int_distribution<page_id_t> any_dist(0, num_pages - 1);
+    std::chrono::steady_clock::time_point start;
+    for (size_t i = 0; i < warm_up_fetches + num_fetches; ++i) {
+      if (i == warm_up_fetches) {
+        start = std::chrono::steady_clock::now();
+      }
+      page_id_t page_id = rng() % 10 == 0 ? any_dist(rng) : hot_dist(rng);
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      bpm->UnpinPage(page_id, false);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << (disk_manager->UsesDirectIo() ? "direct  " : "buffered")
+              << " pool_mb=" << pool_size * PAGE_SIZE / 1024 / 1024
+              << " fetches_per_sec=" << static_cast<uint64_t>(num_fetches / elapsed.count())
+              << " rss_growth_mb=" << (ResidentBytes() - rss_before) / 1024 / 1024
+              << " page_cache_mb=" << PageCacheBytes(db_name) / 1024 / 1024 << std::endl;
+
+    disk_manager->ShutDown();
+    delete bpm;
+    delete disk_manager;
+  }
+  remove("test.db");
+}
+
 }  // namespace bustub
@@ -0,0 +1,223 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats_test.cpp
+//
+// Identification: test/buffer/buffer_pool_stats_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BufferPoolStatsTest, HistogramTest) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(0, histogram.Snapshot().count_);
+  EXPECT_EQ(0, histogram.Snapshot().PercentileNanos(0.99));
+
+  // 98 fast samples in [64, 128), one in [1024, 2048) and one in [2^20, 2^21)
+  for (int i = 0; i < 98; ++i) {
+    histogram.Record(100);
+  }
+  histogram.Record(1500);
+  histogram.Record(1 << 20);
+
+  HistogramSnapshot snapshot = histogram.Snapshot();
+  EXPECT_EQ(100, snapshot.count_);
+  EXPECT_EQ(98 * 100 + 1500 + (1 << 20), snapshot.total_nanos_);
+  EXPECT_EQ(98, snapshot.buckets_[6]);
+  EXPECT_EQ(1, snapshot.buckets_[10]);
+  EXPECT_EQ(1, snapshot.buckets_[20]);
+  EXPECT_EQ(127, snapshot.PercentileNanos(0.5));
+  EXPECT_EQ(127, snapshot.PercentileNanos(0.98));
+  EXPECT_EQ(2047, snapshot.PercentileNanos(0.99));
+  EXPECT_EQ((1 << 21) - 1, snapshot.PercentileNanos(1.0));
+  EXPECT_DOUBLE_EQ((98 * 100 + 1500 + (1 << 20)) / 100.0, snapshot.MeanNanos());
+
+  // 0 and anything past the last bucket are kept, not dropped
+  histogram.Record(0);
+  histogram.Record(uint64_t{1} << 50);
+  snapshot = histogram.Snapshot();
+  EXPECT_EQ(102, snapshot.count_);
+  EXPECT_EQ(1, snapshot.buckets_[0]);
+  EXPECT_EQ(1, snapshot.buckets_[HistogramSnapshot::NUM_BUCKETS - 1]);
+
+  HistogramSnapshot merged = snapshot;
+  merged += snapshot;
+  EXPECT_EQ(204, merged.count_);
+  EXPECT_EQ(196, merged.buckets_[6]);
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolStatsTest, ConcurrentCounterTest) {
+  const int num_threads = 8;
+  const int num_adds = 100000;
+  ShardedCounter counter;
+  LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&counter, &histogram] {
+      for (int i = 0; i < num_adds; ++i) {
+        counter.Add();
+        histogram.Record(i);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * num_adds, counter.Get());
+  EXPECT_EQ(num_threads * num_adds, histogram.Snapshot().count_);
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolStatsTest, BufferPoolTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // fill the pool with dirty pages, then overflow it: the extra page evicts a dirty one
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size + 1; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, true);
+  }
+  // page 0 is gone: a miss that evicts dirty page 1; page 4 is still resident: a hit
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  bpm->UnpinPage(0, false);
+  ASSERT_NE(nullptr, bpm->FetchPage(4));
+  bpm->UnpinPage(4, false);
+  // flushing page 2 makes the next eviction clean
+  EXPECT_TRUE(bpm->FlushPage(2));
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+
+  // with everything pinned, fetches and new pages fail
+  for (page_id_t id : {0, 3, 4}) {
+    ASSERT_NE(nullptr, bpm->FetchPage(id));
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPage(2));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+  BufferPoolStats stats = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size, stats.pool_size_);
+  EXPECT_EQ(buffer_pool_size, stats.resident_pages_);
+  EXPECT_EQ(buffer_pool_size, stats.pinned_frames_);
+  EXPECT_EQ(7, stats.fetches_);
+  EXPECT_EQ(4, stats.hits_);
+  EXPECT_EQ(2, stats.misses_);
+  EXPECT_EQ(1, stats.fetch_failures_);
+  EXPECT_EQ(5, stats.new_pages_);
+  EXPECT_EQ(1, stats.new_page_failures_);
+  EXPECT_EQ(2, stats.dirty_evictions_);
+  EXPECT_EQ(1, stats.clean_evictions_);
+  EXPECT_GE(stats.latch_acquisitions_, stats.misses_ + stats.new_pages_);
+  EXPECT_EQ(0, stats.latch_contended_);
+  EXPECT_EQ(0, stats.latch_wait_.count_);
+  // every miss is one read; NewPage writes the zeroed page out, plus two dirty evictions and one flush
+  EXPECT_EQ(2, stats.read_latency_.count_);
+  EXPECT_EQ(5 + 2 + 1, stats.write_latency_.count_);
+  EXPECT_GT(stats.write_latency_.total_nanos_, 0);
+
+  std::string dump = stats.ToString();
+  EXPECT_NE(std::string::npos, dump.find("hits=4"));
+  EXPECT_NE(std::string::npos, dump.find("dirty=2 clean=1"));
+  EXPECT_NE(std::string::npos, dump.find("read_latency: count=2"));
+  EXPECT_NE(std::string::npos, dump.find("write_latency: count=8"));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolStatsTest, ParallelTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, false);
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    bpm->UnpinPage(page_id, false);
+  }
+
+  std::vector<BufferPoolStats> per_instance = bpm->GetInstanceStats();
+  ASSERT_EQ(num_instances, per_instance.size());
+  BufferPoolStats total = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size * num_instances, total.pool_size_);
+  EXPECT_EQ(buffer_pool_size * num_instances, total.resident_pages_);
+  EXPECT_EQ(0, total.pinned_frames_);
+  EXPECT_EQ(buffer_pool_size * num_instances, total.new_pages_);
+  EXPECT_EQ(buffer_pool_size * num_instances, total.hits_);
+  uint64_t hits = 0;
+  for (const auto &stats : per_instance) {
+    hits += stats.hits_;
+  }
+  EXPECT_EQ(total.hits_, hits);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolStatsTest, DISABLED_CounterBenchmark) {
+  // Every thread bumps one counter in a tight loop: a single shared atomic against the sharded counter.
+  const int num_adds = 10000000;
+  for (int num_threads : {1, 2, 4, 8}) {
+    std::atomic<uint64_t> shared{0};
+    ShardedCounter sharded;
+    for (bool use_sharded : {false, true}) {
+      std::vector<std::thread> threads;
+      auto start = std::chrono::steady_clock::now();
+      for (int tid = 0; tid < num_threads; ++tid) {
+        threads.emplace_back([&shared, &sharded, use_sharded] {
+          for (int i = 0; i < num_adds; ++i) {
+            if (use_sharded) {
+              sharded.Add();
+            } else {
+              shared.fetch_add(1, std::memory_order_relaxed);
+            }
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+      std::cout << "  " << num_threads << " threads, " << (use_sharded ? "sharded" : "single atomic") << ": "
+                << static_cast<double>(elapsed.count()) / num_adds << " ns/add/thread" << std::endl;
+    }
+    EXPECT_EQ(shared.load(), sharded.Get());
+  }
+}
+
+}  // namespace bustub
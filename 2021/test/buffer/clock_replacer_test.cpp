@@ -11,15 +11,20 @@
 //===----------------------------------------------------------------------===//
 
 #include <cstdio>
+#include <iostream>
+#include <set>
 #include <thread>  // NOLINT
 #include <vector>
 
 #include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "../test/buffer/replacer_trace.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
@@ -59,4 +64,103 @@ TEST(ClockReplacerTest, DISABLED_SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+TEST(ClockReplacerTest, PeekVictimsTest) {
+  ClockReplacer clock_replacer(4);
+  clock_replacer.Unpin(0);
+  clock_replacer.Unpin(1);
+  clock_replacer.Unpin(2);
+
+  // One sweep clears every reference bit and evicts frame 0; the hand now rests on frame 1.
+  int value;
+  ASSERT_TRUE(clock_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+
+  // Frame 3 comes in referenced, so it is handed out after the unreferenced 1 and 2.
+  clock_replacer.Unpin(3);
+  EXPECT_EQ((std::vector<frame_id_t>{1, 2, 3}), clock_replacer.PeekVictims(8));
+  EXPECT_EQ((std::vector<frame_id_t>{1}), clock_replacer.PeekVictims(1));
+
+  // Peeking and re-unpinning must not disturb the order Victim follows.
+  clock_replacer.Unpin(1);
+  EXPECT_EQ(3, clock_replacer.Size());
+  ASSERT_TRUE(clock_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(clock_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(clock_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  EXPECT_FALSE(clock_replacer.Victim(&value));
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+TEST(ClockReplacerTest, ConcurrentTest) {
+  const int num_threads = 4;
+  const int frames_per_thread = 64;
+  ClockReplacer clock_replacer(num_threads * frames_per_thread);
+
+  // Threads pin and unpin disjoint frames while one of them keeps evicting.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&clock_replacer, tid] {
+      for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < frames_per_thread; ++i) {
+          clock_replacer.Unpin(tid * frames_per_thread + i);
+        }
+        for (int i = 0; i < frames_per_thread; i += 2) {
+          clock_replacer.Pin(tid * frames_per_thread + i);
+        }
+        int value;
+        if (tid == 0) {
+          clock_replacer.Victim(&value);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  // the evictions above may have taken any odd frame; put them all back
+  for (int i = 1; i < num_threads * frames_per_thread; i += 2) {
+    clock_replacer.Unpin(i);
+  }
+  EXPECT_EQ(num_threads * frames_per_thread / 2, clock_replacer.Size());
+
+  // Even frames ended pinned; every odd frame is handed out exactly once.
+  std::set<int> victims;
+  int value;
+  while (clock_replacer.Victim(&value)) {
+    EXPECT_EQ(1, value % 2);
+    EXPECT_TRUE(victims.insert(value).second);
+  }
+  EXPECT_EQ(num_threads * frames_per_thread / 2, victims.size());
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+// Hit ratio and Pin/Unpin cost of CLOCK against LRU and LRU-K on a zipfian and on a scan-heavy trace.
+// Run with --gtest_also_run_disabled_tests.
+TEST(ClockReplacerTest, DISABLED_TraceBenchmark) {
+  const size_t num_frames = 1024;
+  const size_t trace_length = 2000000;
+  const std::vector<std::pair<const char *, std::vector<page_id_t>>> traces = {
+      {"zipfian", MakeZipfianTrace(16 * num_frames, trace_length)},
+      {"scan-heavy", MakeScanTrace(num_frames, 8 * num_frames, trace_length, 0.8)},
+  };
+
+  for (const auto &[name, trace] : traces) {
+    LRUReplacer lru_hits(num_frames);
+    ClockReplacer clock_hits(num_frames);
+    LRUReplacer lru_ops(num_frames);
+    ClockReplacer clock_ops(num_frames);
+    std::cout << name << " trace, " << num_frames << " frames" << std::endl;
+    std::cout << "  lru:   hit ratio " << ReplayHitRatio(&lru_hits, num_frames, trace) << ", "
+              << PinUnpinNanos(&lru_ops, num_frames, trace) << " ns/op" << std::endl;
+    std::cout << "  clock: hit ratio " << ReplayHitRatio(&clock_hits, num_frames, trace) << ", "
+              << PinUnpinNanos(&clock_ops, num_frames, trace) << " ns/op" << std::endl;
+    LRUKReplacer lru_k_hits(num_frames);
+    LRUKReplacer lru_k_ops(num_frames);
+    std::cout << "  lru-k: hit ratio " << ReplayHitRatio(&lru_k_hits, num_frames, trace) << ", "
+              << PinUnpinNanos(&lru_k_ops, num_frames, trace) << " ns/op" << std::endl;
+  }
+}
+
 }  // namespace bustub
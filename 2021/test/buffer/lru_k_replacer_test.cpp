@@ -0,0 +1,226 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../test/buffer/replacer_trace.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/lru_k_replacer.h"
+#include "catalog/schema.h"
+#include "gtest/gtest.h"
+#include "concurrency/transaction.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2, 0);
+
+  // Frames 1..4 are loaded and unpinned; 2 and 3 are referenced a second time.
+  for (int i = 1; i <= 4; ++i) {
+    lru_k_replacer.Unpin(i);
+  }
+  lru_k_replacer.Pin(3);
+  lru_k_replacer.Unpin(3);
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Unpin(2);
+  EXPECT_EQ(4, lru_k_replacer.Size());
+
+  // Unpinning a tracked frame again changes nothing.
+  lru_k_replacer.Unpin(1);
+  EXPECT_EQ((std::vector<frame_id_t>{1, 4, 2, 3}), lru_k_replacer.PeekVictims(8));
+
+  // Frames seen once go first, least recently used first; then by the age of the second-to-last reference.
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+
+  // Pinned frames are not victims; an evicted frame comes back without its history.
+  lru_k_replacer.Pin(3);
+  lru_k_replacer.Unpin(4);
+  EXPECT_EQ(2, lru_k_replacer.Size());
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+
+  lru_k_replacer.Unpin(3);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+  LRUKReplacer lru_k_replacer(4, 2, 4);
+
+  // Frame 0 is hit many times in a row, like a page under a scan; frame 1 is referenced twice, far apart.
+  lru_k_replacer.Unpin(1);
+  for (int i = 0; i < 8; ++i) {
+    lru_k_replacer.Pin(0);
+    lru_k_replacer.Unpin(0);
+  }
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+
+  // The burst counts as one reference, so frame 0 is still the cheaper victim.
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+}
+
+TEST(LRUKReplacerTest, RemoveTest) {
+  LRUKReplacer lru_k_replacer(4, 2, 0);
+
+  // Frame 0 is referenced twice, frame 1 once.
+  lru_k_replacer.Unpin(0);
+  lru_k_replacer.Pin(0);
+  lru_k_replacer.Unpin(0);
+  lru_k_replacer.Unpin(1);
+
+  // Removing a frame takes it out of the replacer, evictable or pinned.
+  lru_k_replacer.Remove(0);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Remove(1);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+
+  // A page loaded into a removed frame starts without the old page's references: frame 0 is now seen once and goes
+  // before frame 2, which was referenced twice after it.
+  lru_k_replacer.Unpin(0);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Unpin(2);
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+}
+
+/**
+ * Runs full TableIterator scans over a table while issuing zipfian point lookups against its first num_hot_pages
+ * pages, one lookup per lookup_interval scanned tuples. With bulk_read the scans go through a BULK_READ strategy.
+ * @return the hit ratio of the point lookups
+ */
+static double ScanWithLookups(DiskManager *disk_manager, page_id_t first_page_id,
+                              const std::vector<std::vector<RID>> &rids_by_page, ReplacerPolicy replacer_policy,
+                              bool bulk_read = false) {
+  const size_t buffer_pool_size = 64;
+  const page_id_t num_hot_pages = 48;
+  const int num_scans = 2;
+  const int lookup_interval = 16;
+
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, replacer_policy);
+  auto *transaction = new Transaction(0);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, first_page_id);
+  // keep every read on this thread, so the read counter attributes misses exactly
+  table->SetReadAhead(0);
+
+  ZipfianGenerator zipf(num_hot_pages, 0.99, 15445);
+  std::mt19937 rng(15445);
+  size_t lookups = 0;
+  size_t lookup_misses = 0;
+  auto lookup = [&] {
+    const auto &page_rids = rids_by_page[zipf.Next()];
+    Tuple tuple;
+    int reads = disk_manager->GetNumReads();
+    EXPECT_TRUE(table->GetTuple(page_rids[rng() % page_rids.size()], &tuple, transaction));
+    lookup_misses += disk_manager->GetNumReads() - reads;
+    lookups++;
+  };
+
+  // warm the hot set up before the reporting queries start
+  for (size_t i = 0; i < 20 * buffer_pool_size; ++i) {
+    lookup();
+  }
+  lookups = 0;
+  lookup_misses = 0;
+
+  int scanned = 0;
+  int total_reads = disk_manager->GetNumReads();
+  for (int scan = 0; scan < num_scans; ++scan) {
+    BufferAccessStrategy strategy(BufferAccessType::BULK_READ, bpm->GetPoolSize());
+    for (auto it = table->Begin(transaction, bulk_read ? &strategy : nullptr); it != table->End(); ++it) {
+      if (++scanned % lookup_interval == 0) {
+        lookup();
+      }
+    }
+  }
+  total_reads = disk_manager->GetNumReads() - total_reads;
+
+  double hit_ratio = 1.0 - static_cast<double>(lookup_misses) / lookups;
+  std::cout << "  " << scanned << " tuples scanned, " << lookups << " lookups, lookup hit ratio " << hit_ratio
+            << ", page reads " << total_reads << std::endl;
+
+  delete table;
+  delete transaction;
+  delete bpm;
+  return hit_ratio;
+}
+
+// A reporting scan must not flush the OLTP working set out of the pool.
+TEST(LRUKReplacerTest, TableScanTraceTest) {
+  const int num_tuples = 8000;
+
+  // Build the table once, through a pool large enough to hold all of it.
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(1024, disk_manager);
+  auto *transaction = new Transaction(0);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, transaction);
+  page_id_t first_page_id = table->GetFirstPageId();
+
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"payload", TypeId::VARCHAR, 100}});
+  std::string payload(100, 'x');
+  std::vector<std::vector<RID>> rids_by_page;
+  for (int i = 0; i < num_tuples; ++i) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(payload)}, &schema);
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    if (rids_by_page.empty() || rids_by_page.back().front().GetPageId() != rid.GetPageId()) {
+      rids_by_page.emplace_back();
+    }
+    rids_by_page.back().push_back(rid);
+  }
+  bpm->FlushAllPages();
+  delete table;
+  delete transaction;
+  delete bpm;
+
+  std::cout << "lru" << std::endl;
+  double lru = ScanWithLookups(disk_manager, first_page_id, rids_by_page, ReplacerPolicy::LRU);
+  std::cout << "clock" << std::endl;
+  double clock = ScanWithLookups(disk_manager, first_page_id, rids_by_page, ReplacerPolicy::CLOCK);
+  std::cout << "lru-k" << std::endl;
+  double lru_k = ScanWithLookups(disk_manager, first_page_id, rids_by_page, ReplacerPolicy::LRU_K);
+  std::cout << "lru, scan through a BULK_READ ring" << std::endl;
+  double lru_ring = ScanWithLookups(disk_manager, first_page_id, rids_by_page, ReplacerPolicy::LRU, true);
+
+  EXPECT_GT(lru_k, lru);
+  EXPECT_GT(lru_k, clock);
+  EXPECT_GT(lru_ring, lru);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+}  // namespace bustub
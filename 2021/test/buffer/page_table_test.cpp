@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <random>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(16);
+  frame_id_t frame_id;
+
+  EXPECT_FALSE(page_table.Find(0, &frame_id));
+  for (page_id_t i = 0; i < 16; ++i) {
+    page_table.Insert(i, i + 100);
+  }
+  for (page_id_t i = 0; i < 16; ++i) {
+    ASSERT_TRUE(page_table.Find(i, &frame_id));
+    EXPECT_EQ(i + 100, frame_id);
+  }
+
+  // Overwriting keeps a single entry.
+  page_table.Insert(3, 7);
+  ASSERT_TRUE(page_table.Find(3, &frame_id));
+  EXPECT_EQ(7, frame_id);
+
+  // RemoveIf only removes when the predicate holds.
+  EXPECT_FALSE(page_table.RemoveIf(3, [](frame_id_t fid) { return fid != 7; }));
+  EXPECT_TRUE(page_table.RemoveIf(3, [](frame_id_t fid) { return fid == 7; }));
+  EXPECT_FALSE(page_table.Find(3, &frame_id));
+  EXPECT_FALSE(page_table.Remove(3));
+
+  // Everything else is still reachable after the hole was closed.
+  for (page_id_t i = 0; i < 16; ++i) {
+    EXPECT_EQ(i != 3, page_table.Find(i, &frame_id));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, InvalidPageIdTest) {
+  PageTable page_table(16);
+  frame_id_t frame_id = -2;
+
+  // INVALID_PAGE_ID marks empty slots, yet is never found, in an empty table or in a full one.
+  EXPECT_FALSE(page_table.Find(INVALID_PAGE_ID, &frame_id));
+  for (page_id_t i = 0; i < 16; ++i) {
+    page_table.Insert(i, i);
+  }
+  bool applied = false;
+  EXPECT_FALSE(page_table.FindAndApply(INVALID_PAGE_ID, [&applied](frame_id_t fid) { applied = true; }));
+  EXPECT_FALSE(applied);
+  EXPECT_FALSE(page_table.RemoveIf(INVALID_PAGE_ID, [](frame_id_t fid) { return true; }));
+  EXPECT_FALSE(page_table.Remove(INVALID_PAGE_ID));
+  EXPECT_EQ(-2, frame_id);
+  for (page_id_t i = 0; i < 16; ++i) {
+    ASSERT_TRUE(page_table.Find(i, &frame_id));
+    EXPECT_EQ(i, frame_id);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, ChurnTest) {
+  // Far more distinct keys than frames, with a bounded number resident at any time, like a buffer pool under load.
+  const size_t num_frames = 64;
+  PageTable page_table(num_frames);
+  std::unordered_map<page_id_t, frame_id_t> reference;
+
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<page_id_t> page_dist(0, 10000);
+  for (int i = 0; i < 100000; ++i) {
+    page_id_t page_id = page_dist(rng);
+    if (reference.count(page_id) != 0) {
+      EXPECT_TRUE(page_table.Remove(page_id));
+      reference.erase(page_id);
+    } else if (reference.size() < num_frames) {
+      page_table.Insert(page_id, i);
+      reference[page_id] = i;
+    }
+  }
+
+  frame_id_t frame_id;
+  for (const auto &[page_id, expected] : reference) {
+    ASSERT_TRUE(page_table.Find(page_id, &frame_id));
+    EXPECT_EQ(expected, frame_id);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, ConcurrentTest) {
+  const int num_threads = 4;
+  const page_id_t pages_per_thread = 256;
+  PageTable page_table(num_threads * pages_per_thread);
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&page_table, tid] {
+      for (int round = 0; round < 10; ++round) {
+        for (page_id_t i = 0; i < pages_per_thread; ++i) {
+          page_table.Insert(tid * pages_per_thread + i, tid);
+        }
+        for (page_id_t i = 0; i < pages_per_thread; i += 2) {
+          EXPECT_TRUE(page_table.Remove(tid * pages_per_thread + i));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  frame_id_t frame_id;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    for (page_id_t i = 0; i < pages_per_thread; ++i) {
+      bool found = page_table.Find(tid * pages_per_thread + i, &frame_id);
+      EXPECT_EQ(i % 2 == 1, found);
+      if (found) {
+        EXPECT_EQ(tid, frame_id);
+      }
+    }
+  }
+}
+
+}  // namespace bustub
@@ -11,9 +11,16 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/parallel_buffer_pool_manager.h"
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <iostream>
 #include <random>
+#include <set>
 #include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
@@ -151,4 +158,386 @@ TEST(ParallelBufferPoolManagerTest, DISABLED_SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, HashRoutingTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const size_t num_instances = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, nullptr,
+                                            ReplacerPolicy::LRU, PageRouting::HASH);
+
+  // Fill the whole pool; every instance hands out ids that route back to it, and no id is handed out twice.
+  std::vector<page_id_t> page_ids;
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    page_ids.push_back(page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  std::sort(page_ids.begin(), page_ids.end());
+  EXPECT_EQ(page_ids.end(), std::adjacent_find(page_ids.begin(), page_ids.end()));
+
+  for (const auto &stats : bpm->GetInstanceStats()) {
+    EXPECT_EQ(buffer_pool_size, stats.resident_pages_);
+    EXPECT_EQ(buffer_pool_size, stats.pinned_frames_);
+    EXPECT_EQ(buffer_pool_size, stats.new_pages_);
+  }
+
+  // Round trip every page through disk.
+  for (page_id_t page_id : page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  for (page_id_t page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(page_id), page->GetData());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // A stride of num_instances sends every page to one instance under modulo routing; the hash spreads it out.
+  std::vector<size_t> per_instance(num_instances);
+  for (page_id_t page_id = 0; page_id < 4096; page_id += num_instances) {
+    per_instance[InstanceForPage(page_id, num_instances, PageRouting::HASH)]++;
+    EXPECT_EQ(0, InstanceForPage(page_id, num_instances, PageRouting::MODULO));
+  }
+  for (size_t count : per_instance) {
+    EXPECT_GT(count, 1024 / num_instances / 2);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrentNewPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t num_instances = 4;
+  const int num_threads = 4;
+  const int rounds = 500;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm] {
+      page_id_t page_id;
+      for (int i = 0; i < rounds; ++i) {
+        auto *page = bpm->NewPage(&page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // The starting index rotates per call, so allocations spread evenly over the instances.
+  uint64_t total = 0;
+  for (const auto &stats : bpm->GetInstanceStats()) {
+    EXPECT_EQ(static_cast<uint64_t>(num_threads * rounds / num_instances), stats.new_pages_);
+    EXPECT_EQ(0, stats.pinned_frames_);
+    EXPECT_EQ(buffer_pool_size, stats.resident_pages_);
+    EXPECT_LE(stats.latch_contended_, stats.latch_acquisitions_);
+    total += stats.new_pages_;
+  }
+  EXPECT_EQ(static_cast<uint64_t>(num_threads * rounds), total);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, BatchFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 4;
+  const page_id_t num_pages = 40;
+
+  for (PageRouting routing : {PageRouting::MODULO, PageRouting::HASH}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, nullptr,
+                                              ReplacerPolicy::LRU, routing);
+    std::vector<page_id_t> page_ids;
+    page_id_t page_id;
+    for (page_id_t i = 0; i < num_pages; ++i) {
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+      bpm->UnpinPage(page_id, true);
+      page_ids.push_back(page_id);
+    }
+
+    // Scenario: A batch spanning all instances comes back in the caller's order, each instance only reading its own
+    // share of the misses.
+    std::vector<page_id_t> batch(page_ids.begin(), page_ids.begin() + 12);
+    std::reverse(batch.begin(), batch.end());
+    std::vector<Page *> pages(batch.size());
+    EXPECT_EQ(batch.size(), bpm->FetchPages(batch.data(), batch.size(), pages.data()));
+    for (size_t i = 0; i < batch.size(); ++i) {
+      ASSERT_NE(nullptr, pages[i]);
+      EXPECT_EQ(batch[i], pages[i]->GetPageId());
+      EXPECT_EQ("page " + std::to_string(batch[i]), std::string(pages[i]->GetData()));
+    }
+    std::vector<BufferPoolStats> per_instance = bpm->GetInstanceStats();
+    for (size_t instance = 0; instance < num_instances; ++instance) {
+      auto owned = static_cast<uint64_t>(std::count_if(batch.begin(), batch.end(), [&](page_id_t id) {
+        return InstanceForPage(id, num_instances, routing) == instance;
+      }));
+      EXPECT_EQ(owned, per_instance[instance].hits_ + per_instance[instance].misses_);
+    }
+    EXPECT_TRUE(bpm->UnpinPages(batch.data(), batch.size(), false));
+    EXPECT_EQ(0, bpm->GetStats().pinned_frames_);
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, DeletePageReuseTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 3;
+  const page_id_t num_pages = 30;
+
+  for (PageRouting routing : {PageRouting::MODULO, PageRouting::HASH}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, nullptr,
+                                              ReplacerPolicy::LRU, routing);
+    std::set<page_id_t> live;
+    page_id_t page_id;
+    for (page_id_t i = 0; i < num_pages; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      bpm->UnpinPage(page_id, false);
+      live.insert(page_id);
+    }
+    std::set<page_id_t> deleted;
+    for (page_id_t i = 0; i < num_pages; i += 3) {
+      EXPECT_TRUE(bpm->DeletePage(i));
+      live.erase(i);
+      deleted.insert(i);
+    }
+
+    // Scenario: Every instance reuses the freed pages it owns (the instance asserts that ids route back to it) and
+    // never hands out a live page; once all instances had their turns, every freed page is back in use.
+    for (size_t i = 0; i < num_instances * deleted.size(); ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      bpm->UnpinPage(page_id, false);
+      EXPECT_TRUE(live.insert(page_id).second);
+    }
+    for (page_id_t id : deleted) {
+      EXPECT_EQ(1, live.count(id));
+    }
+    EXPECT_EQ(live.size(), disk_manager->GetNumAllocatedPages());
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete bpm;
+    delete disk_manager;
+  }
+  remove("test.fsm");
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SegmentTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 3;
+  const size_t extent_pages = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  PageSegment segment_a(extent_pages);
+  PageSegment segment_b(extent_pages);
+
+  // Scenario: Two segments grow in turns, yet each one's pages are contiguous within its extents. The pages of an
+  // extent spread over the instances that own them.
+  std::vector<page_id_t> pages_a;
+  std::vector<page_id_t> pages_b;
+  page_id_t page_id;
+  for (size_t i = 0; i < 3 * extent_pages; ++i) {
+    for (auto [segment, pages] : {std::make_pair(&segment_a, &pages_a), std::make_pair(&segment_b, &pages_b)}) {
+      Page *page = bpm->NewPage(&page_id, *segment);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(page_id, page->GetPageId());
+      pages->push_back(page_id);
+      bpm->UnpinPage(page_id, false);
+    }
+  }
+  EXPECT_EQ(std::vector<page_id_t>({0, 1, 2, 3, 8, 9, 10, 11, 16, 17, 18, 19}), pages_a);
+  EXPECT_EQ(3, segment_a.GetNumExtents());
+  EXPECT_EQ(3, segment_b.GetNumExtents());
+  PageFragmentation fragmentation = PageFragmentation::Of(pages_b);
+  EXPECT_EQ(3 * extent_pages, fragmentation.num_pages_);
+  EXPECT_EQ(3, fragmentation.num_runs_);
+  EXPECT_DOUBLE_EQ(extent_pages, fragmentation.MeanRunPages());
+  EXPECT_EQ(6 * extent_pages, disk_manager->GetNumAllocatedPages());
+
+  // Scenario: When the instance owning the next page id is full of pinned pages, the page id is not used up.
+  std::vector<page_id_t> pinned;
+  for (page_id_t id = 0; pinned.size() < buffer_pool_size; id += num_instances) {
+    ASSERT_NE(nullptr, bpm->FetchPage(id));
+    pinned.push_back(id);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id, segment_a));
+  EXPECT_EQ(4, segment_a.GetNumExtents());
+  bpm->UnpinPage(pinned.back(), false);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id, segment_a));
+  EXPECT_EQ(static_cast<page_id_t>(6 * extent_pages), page_id);
+  bpm->UnpinPage(page_id, false);
+  for (size_t i = 0; i + 1 < pinned.size(); ++i) {
+    bpm->UnpinPage(pinned[i], false);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, DISABLED_InstanceScalingBenchmark) {
+  // Random fetches from a fixed total pool split into more and more instances; prints the share of latch
+  // acquisitions that had to wait, to help size num_instances for a given core count.
+  const std::string db_name = "test.db";
+  const size_t total_pool_size = 256;
+  const page_id_t num_pages = 1024;
+  const int num_threads = std::max(4U, std::thread::hardware_concurrency());
+  const int ops_per_thread = 20000;
+
+  for (size_t num_instances : {1, 2, 4, 8, 16}) {
+    for (PageRouting routing : {PageRouting::MODULO, PageRouting::HASH}) {
+      auto *disk_manager = new DiskManager(db_name);
+      auto *bpm = new ParallelBufferPoolManager(num_instances, total_pool_size / num_instances, disk_manager,
+                                                nullptr, ReplacerPolicy::LRU, routing);
+      page_id_t page_id;
+      for (page_id_t i = 0; i < num_pages; ++i) {
+        bpm->NewPage(&page_id);
+        bpm->UnpinPage(page_id, true);
+      }
+
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> threads;
+      for (int tid = 0; tid < num_threads; ++tid) {
+        threads.emplace_back([bpm, tid] {
+          std::mt19937 rng(tid);
+          std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+          for (int i = 0; i < ops_per_thread; ++i) {
+            page_id_t target = dist(rng);
+            if (bpm->FetchPage(target) != nullptr) {
+              bpm->UnpinPage(target, false);
+            }
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+      uint64_t acquisitions = 0;
+      uint64_t contended = 0;
+      for (const auto &stats : bpm->GetInstanceStats()) {
+        acquisitions += stats.latch_acquisitions_;
+        contended += stats.latch_contended_;
+      }
+      std::cout << "  " << num_instances << " instances, " << (routing == PageRouting::HASH ? "hash" : "modulo")
+                << " routing: " << elapsed.count() << " ms, latch contended "
+                << (acquisitions == 0 ? 0.0 : static_cast<double>(contended) / acquisitions) << std::endl;
+
+      disk_manager->ShutDown();
+      remove("test.db");
+      delete bpm;
+      delete disk_manager;
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, DISABLED_BatchFetchBenchmark) {
+  // Fetch and unpin 64 random resident pages, one call per page against one FetchPages / UnpinPages per batch.
+  const std::string db_name = "test.db";
+  const size_t num_instances = 4;
+  const size_t buffer_pool_size = 1024;
+  const page_id_t num_pages = 4096;
+  const size_t batch_size = 64;
+  const int num_batches = 20000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    bpm->NewPage(&page_id);
+    bpm->UnpinPage(page_id, false);
+  }
+  // make the last pool-size pages resident
+  std::vector<page_id_t> resident;
+  for (page_id_t i = num_pages - static_cast<page_id_t>(num_instances * buffer_pool_size); i < num_pages; ++i) {
+    resident.push_back(i);
+  }
+
+  for (int num_threads : {1, 4}) {
+    for (bool batched : {false, true}) {
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> threads;
+      for (int tid = 0; tid < num_threads; ++tid) {
+        threads.emplace_back([bpm, &resident, batched, tid] {
+          std::mt19937 rng(tid);
+          std::vector<page_id_t> ids(batch_size);
+          std::vector<Page *> pages(batch_size);
+          for (int b = 0; b < num_batches; ++b) {
+            for (auto &id : ids) {
+              id = resident[rng() % resident.size()];
+            }
+            if (batched) {
+              bpm->FetchPages(ids.data(), ids.size(), pages.data());
+              bpm->UnpinPages(ids.data(), ids.size(), false);
+            } else {
+              for (size_t i = 0; i < ids.size(); ++i) {
+                pages[i] = bpm->FetchPage(ids[i]);
+              }
+              for (page_id_t id : ids) {
+                bpm->UnpinPage(id, false);
+              }
+            }
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+      std::cout << "  " << num_threads << " threads, " << (batched ? "batched" : "per page") << ": "
+                << static_cast<double>(elapsed.count()) / (static_cast<double>(num_batches) * num_threads)
+                << " ns/batch of " << batch_size << std::endl;
+    }
+  }
+  EXPECT_EQ(0, bpm->GetStats().pinned_frames_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -0,0 +1,235 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_only_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/read_only_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/read_only_buffer_pool_manager.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** Writes num_pages pages, each filled with its page id, and shuts the disk manager down. */
+static void WritePages(const std::string &db_name, page_id_t num_pages) {
+  DiskManager disk_manager(db_name);
+  BufferPoolManagerInstance bpm(16, &disk_manager);
+  page_id_t page_id;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    Page *page = bpm.NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    memset(page->GetData(), 'a' + page_id % 26, PAGE_SIZE);
+    bpm.UnpinPage(page_id, true);
+  }
+  bpm.FlushAllPages();
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(ReadOnlyBufferPoolManagerTest, ZeroCopyTest) {
+  const std::string db_name = "test.db";
+  const page_id_t num_pages = 20;
+  WritePages(db_name, num_pages);
+
+  DiskManagerOptions options;
+  options.mmap_read_only_ = true;
+  auto *disk_manager = new DiskManager(db_name, options);
+  ASSERT_TRUE(disk_manager->IsReadOnly());
+  ASSERT_EQ(num_pages, disk_manager->GetNumMappedPages());
+  auto *bpm = new ReadOnlyBufferPoolManager(disk_manager);
+  EXPECT_EQ(num_pages, bpm->GetPoolSize());
+
+  // Scenario: Fetched pages are views into the mapping, one per page id, with the contents that were written.
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, page->GetPageId());
+    EXPECT_EQ(disk_manager->GetMappedPage(page_id), page->GetData());
+    EXPECT_EQ('a' + page_id % 26, page->GetData()[PAGE_SIZE - 1]);
+    EXPECT_EQ(page, bpm->FetchPage(page_id));
+    EXPECT_EQ(2, page->GetPinCount());
+  }
+  char buffer[PAGE_SIZE];
+  disk_manager->ReadPage(7, buffer);
+  EXPECT_EQ(0, memcmp(buffer, disk_manager->GetMappedPage(7), PAGE_SIZE));
+
+  // Scenario: Pins are counted as in any buffer pool.
+  EXPECT_TRUE(bpm->UnpinPage(3, false));
+  EXPECT_TRUE(bpm->UnpinPage(3, false));
+  EXPECT_FALSE(bpm->UnpinPage(3, false));
+  {
+    ReadPageGuard guard = bpm->FetchPageRead(3);
+    ASSERT_TRUE(guard);
+    EXPECT_EQ('a' + 3, guard.GetData()[0]);
+  }
+  EXPECT_FALSE(bpm->UnpinPage(3, false));
+
+  // Scenario: Nothing can be created, deleted or fetched past the end of the file.
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  EXPECT_FALSE(bpm->DeletePage(0));
+  EXPECT_EQ(nullptr, bpm->FetchPage(num_pages));
+  EXPECT_EQ(nullptr, bpm->FetchPage(-1));
+  EXPECT_TRUE(bpm->FlushPage(0));
+  bpm->PrefetchPages({0, 1, 2, 10, 11, num_pages - 1});
+
+  // Scenario: Concurrent first fetches of a page agree on one view.
+  std::vector<std::thread> threads;
+  std::vector<Page *> seen(4);
+  for (size_t tid = 0; tid < seen.size(); ++tid) {
+    threads.emplace_back([bpm, &seen, tid] {
+      for (page_id_t id = 0; id < num_pages; ++id) {
+        Page *page = bpm->FetchPage(id);
+        if (id == num_pages - 1) {
+          seen[tid] = page;
+        }
+        bpm->UnpinPage(id, false);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (Page *page : seen) {
+    EXPECT_EQ(seen[0], page);
+  }
+
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+
+  // Scenario: Read-only mode never creates a db file.
+  remove(db_name.c_str());
+  remove("test.fsm");
+  EXPECT_THROW(DiskManager(db_name, options), Exception);
+  EXPECT_NE(0, access(db_name.c_str(), F_OK));
+  remove("test.log");
+}
+
+/** Fills a table through a regular pool and writes it out. @return its first page id */
+static page_id_t BuildTable(const std::string &db_name, int num_tuples) {
+  DiskManager disk_manager(db_name);
+  auto *transaction = new Transaction(0);
+  auto *bpm = new BufferPoolManagerInstance(4096, &disk_manager);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, transaction);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"payload", TypeId::VARCHAR, 100}});
+  std::string payload(100, 'x');
+  for (int i = 0; i < num_tuples; ++i) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(payload)}, &schema);
+    RID rid;
+    EXPECT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  }
+  page_id_t first_page_id = table->GetFirstPageId();
+  bpm->FlushAllPages();
+  delete table;
+  delete bpm;
+  delete transaction;
+  disk_manager.Sync();
+  disk_manager.ShutDown();
+  return first_page_id;
+}
+
+/** Scans a whole table. @return the number of tuples seen, all in insertion order */
+static int Scan(BufferPoolManager *bpm, page_id_t first_page_id) {
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"payload", TypeId::VARCHAR, 100}});
+  Transaction transaction(0);
+  TableHeap table(bpm, nullptr, nullptr, first_page_id);
+  int scanned = 0;
+  for (auto it = table.Begin(&transaction); it != table.End(); ++it) {
+    EXPECT_EQ(scanned, it->GetValue(&schema, 0).GetAs<int32_t>());
+    scanned++;
+  }
+  return scanned;
+}
+
+// NOLINTNEXTLINE
+TEST(ReadOnlyBufferPoolManagerTest, TableScanTest) {
+  const std::string db_name = "test.db";
+  const int num_tuples = 5000;
+  page_id_t first_page_id = BuildTable(db_name, num_tuples);
+
+  DiskManagerOptions options;
+  options.mmap_read_only_ = true;
+  auto *disk_manager = new DiskManager(db_name, options);
+  auto *bpm = new ReadOnlyBufferPoolManager(disk_manager);
+  EXPECT_EQ(num_tuples, Scan(bpm, first_page_id));
+  // every page is unpinned again after the scan
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(bpm->GetPoolSize()); ++page_id) {
+    Page *page = bpm->FetchPage(page_id);
+    EXPECT_EQ(1, page->GetPinCount());
+    bpm->UnpinPage(page_id, false);
+  }
+
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+  remove("test.fsm");
+  remove("test.log");
+}
+
+// Full-table scans through a regular pool (with read-ahead) and through the read-only mapping, cold (the table is
+// pushed out of the OS page cache first) and warm. Times include opening the disk manager and creating the pool.
+// Run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(ReadOnlyBufferPoolManagerTest, DISABLED_ScanBenchmark) {
+  const std::string db_name = "test.db";
+  const int num_tuples = 40000;
+  const size_t buffer_pool_size = 1024;
+  page_id_t first_page_id = BuildTable(db_name, num_tuples);
+
+  for (bool cold : {true, false}) {
+    for (bool read_only : {false, true}) {
+      if (cold) {
+        int fd = open(db_name.c_str(), O_RDONLY);
+        ASSERT_GE(fd, 0);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+      }
+      auto start = std::chrono::steady_clock::now();
+      DiskManagerOptions options;
+      options.mmap_read_only_ = read_only;
+      auto *disk_manager = new DiskManager(db_name, options);
+      BufferPoolManager *bpm;
+      if (read_only) {
+        bpm = new ReadOnlyBufferPoolManager(disk_manager);
+      } else {
+        bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+      }
+      EXPECT_EQ(num_tuples, Scan(bpm, first_page_id));
+      std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << (cold ? "cold " : "warm ") << (read_only ? "read-only mmap pool" : "regular pool       ") << ": "
+                << elapsed.count() << " ms, " << disk_manager->GetNumReads() << " page copies" << std::endl;
+      disk_manager->ShutDown();
+      delete bpm;
+      delete disk_manager;
+    }
+  }
+
+  remove(db_name.c_str());
+  remove("test.fsm");
+  remove("test.log");
+}
+
+}  // namespace bustub
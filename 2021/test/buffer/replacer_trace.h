@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer_trace.h
+//
+// Identification: test/buffer/replacer_trace.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/** Draws page ids 0..num_pages-1 with P(i) proportional to 1 / (i + 1)^theta. */
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(page_id_t num_pages, double theta, uint32_t seed) : rng_(seed), cdf_(num_pages) {
+    double sum = 0;
+    for (page_id_t i = 0; i < num_pages; i++) {
+      sum += 1.0 / std::pow(i + 1, theta);
+      cdf_[i] = sum;
+    }
+    for (auto &p : cdf_) {
+      p /= sum;
+    }
+  }
+
+  page_id_t Next() {
+    auto it = std::lower_bound(cdf_.begin(), cdf_.end(), dist_(rng_));
+    return static_cast<page_id_t>(std::min<size_t>(it - cdf_.begin(), cdf_.size() - 1));
+  }
+
+ private:
+  std::mt19937 rng_;
+  std::uniform_real_distribution<double> dist_{0.0, 1.0};
+  std::vector<double> cdf_;
+};
+
+/** Point lookups only: a zipfian draw over num_pages pages. */
+inline std::vector<page_id_t> MakeZipfianTrace(page_id_t num_pages, size_t length, uint32_t seed = 15445) {
+  ZipfianGenerator zipf(num_pages, 0.99, seed);
+  std::vector<page_id_t> trace(length);
+  for (auto &page_id : trace) {
+    page_id = zipf.Next();
+  }
+  return trace;
+}
+
+/**
+ * Zipfian lookups over pages [0, num_hot_pages) interleaved with a sequential scan that cycles through pages
+ * [num_hot_pages, num_hot_pages + num_scan_pages). scan_fraction of the accesses belong to the scan.
+ */
+inline std::vector<page_id_t> MakeScanTrace(page_id_t num_hot_pages, page_id_t num_scan_pages, size_t length,
+                                            double scan_fraction, uint32_t seed = 15445) {
+  ZipfianGenerator zipf(num_hot_pages, 0.99, seed);
+  std::mt19937 rng(seed);
+  std::bernoulli_distribution is_scan(scan_fraction);
+  std::vector<page_id_t> trace(length);
+  page_id_t cursor = 0;
+  for (auto &page_id : trace) {
+    if (is_scan(rng)) {
+      page_id = num_hot_pages + cursor;
+      cursor = (cursor + 1) % num_scan_pages;
+    } else {
+      page_id = zipf.Next();
+    }
+  }
+  return trace;
+}
+
+/**
+ * Replays a trace against a replacer the way a buffer pool drives it: every access pins and unpins the page's frame,
+ * and a miss first takes a free frame or evicts the replacer's victim.
+ * @return fraction of accesses that hit a resident page
+ */
+inline double ReplayHitRatio(Replacer *replacer, size_t num_frames, const std::vector<page_id_t> &trace) {
+  std::unordered_map<page_id_t, frame_id_t> page_table;
+  std::vector<page_id_t> frame_to_page(num_frames, INVALID_PAGE_ID);
+  frame_id_t next_free = 0;
+  size_t hits = 0;
+  for (page_id_t page_id : trace) {
+    frame_id_t frame_id;
+    auto it = page_table.find(page_id);
+    if (it != page_table.end()) {
+      frame_id = it->second;
+      hits++;
+    } else if (static_cast<size_t>(next_free) < num_frames) {
+      frame_id = next_free++;
+      page_table[page_id] = frame_id;
+    } else {
+      if (!replacer->Victim(&frame_id)) {
+        return -1;
+      }
+      page_table.erase(frame_to_page[frame_id]);
+      page_table[page_id] = frame_id;
+    }
+    frame_to_page[frame_id] = page_id;
+    replacer->Pin(frame_id);
+    replacer->Unpin(frame_id);
+  }
+  return static_cast<double>(hits) / trace.size();
+}
+
+/**
+ * Times the replacer calls of a trace that always hits: one Pin and one Unpin per access, no evictions.
+ * @return nanoseconds per Pin or Unpin call
+ */
+inline double PinUnpinNanos(Replacer *replacer, size_t num_frames, const std::vector<page_id_t> &trace) {
+  for (size_t i = 0; i < num_frames; i++) {
+    replacer->Unpin(static_cast<frame_id_t>(i));
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (page_id_t page_id : trace) {
+    auto frame_id = static_cast<frame_id_t>(page_id % num_frames);
+    replacer->Pin(frame_id);
+    replacer->Unpin(frame_id);
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / (2 * trace.size());
+}
+
+}  // namespace bustub
@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_test.cpp
+//
+// Identification: test/common/crc32c_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/crc32c.h"
+
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, KnownValuesTest) {
+  // RFC 3720, appendix B.4
+  char buf[32];
+  memset(buf, 0, sizeof(buf));
+  EXPECT_EQ(0x8A9136AA, Crc32c(buf, sizeof(buf)));
+  memset(buf, 0xff, sizeof(buf));
+  EXPECT_EQ(0x62A8AB43, Crc32c(buf, sizeof(buf)));
+  for (int i = 0; i < 32; ++i) {
+    buf[i] = static_cast<char>(i);
+  }
+  EXPECT_EQ(0x46DD794E, Crc32c(buf, sizeof(buf)));
+  for (int i = 0; i < 32; ++i) {
+    buf[i] = static_cast<char>(31 - i);
+  }
+  EXPECT_EQ(0x113FDB5C, Crc32c(buf, sizeof(buf)));
+
+  std::string check = "123456789";
+  EXPECT_EQ(0xE3069283, Crc32c(check.data(), check.size()));
+  EXPECT_EQ(0xE3069283, Crc32cSoftware(check.data(), check.size()));
+  EXPECT_EQ(0, Crc32c(check.data(), 0));
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, HardwareMatchesSoftwareTest) {
+  std::mt19937 rng(15445);
+  std::vector<char> buf(3 * PAGE_SIZE + 16);
+  for (auto &c : buf) {
+    c = static_cast<char>(rng());
+  }
+  // every alignment, around the three-stripe block size, and whole pages
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t size : {size_t{0}, size_t{1}, size_t{7}, size_t{8}, size_t{767}, size_t{768}, size_t{769},
+                        size_t{1536}, size_t{PAGE_SIZE}, size_t{3 * PAGE_SIZE}}) {
+      const char *data = buf.data() + offset;
+      uint32_t crc = Crc32c(data, size);
+      EXPECT_EQ(Crc32cSoftware(data, size), crc);
+      // a checksum can be continued, split anywhere
+      size_t split = size / 3;
+      EXPECT_EQ(crc, Crc32c(data + split, size - split, Crc32c(data, split)));
+    }
+  }
+  std::cout << "CRC instructions: " << (Crc32cIsHardwareAccelerated() ? "yes" : "no") << std::endl;
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, DISABLED_ThroughputBenchmark) {
+  const int num_pages = 200000;
+  std::vector<char> page(PAGE_SIZE, 'x');
+  for (bool hardware : {false, true}) {
+    uint32_t crc = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_pages; ++i) {
+      page[i % PAGE_SIZE] = static_cast<char>(crc);
+      crc = hardware ? Crc32c(page.data(), PAGE_SIZE) : Crc32cSoftware(page.data(), PAGE_SIZE);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << (hardware ? "Crc32c        " : "Crc32cSoftware") << ": " << elapsed.count() * 1e9 / num_pages
+              << " ns/page, " << num_pages * PAGE_SIZE / elapsed.count() / (1 << 30) << " GB/s" << std::endl;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz4_test.cpp
+//
+// Identification: test/common/lz4_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/lz4.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** Compresses and decompresses data. @return the compressed size */
+static size_t RoundTrip(const std::string &data) {
+  std::vector<char> compressed(data.size() + data.size() / 255 + 16);
+  size_t compressed_size = Lz4Compress(data.data(), data.size(), compressed.data(), compressed.size());
+  EXPECT_LT(0, compressed_size);
+  std::vector<char> out(data.size() + 1);
+  size_t out_size = 0;
+  EXPECT_TRUE(Lz4Decompress(compressed.data(), compressed_size, out.data(), out.size(), &out_size));
+  EXPECT_EQ(data, std::string(out.data(), out_size));
+  return compressed_size;
+}
+
+// NOLINTNEXTLINE
+TEST(Lz4Test, RoundTripTest) {
+  std::mt19937 rng(15445);
+  // short inputs are all literals
+  for (size_t size = 0; size < 32; ++size) {
+    RoundTrip(std::string(size, 'a'));
+  }
+  EXPECT_GT(100, RoundTrip(std::string(PAGE_SIZE, '\0')));
+  std::string pattern;
+  for (int i = 0; i < 600; ++i) {
+    pattern += "abc" + std::to_string(i % 7);
+  }
+  EXPECT_GT(200, RoundTrip(pattern));
+
+  // random bytes do not compress, but still round trip at a bounded expansion
+  std::string noise(PAGE_SIZE, '\0');
+  for (auto &c : noise) {
+    c = static_cast<char>(rng());
+  }
+  EXPECT_GE(PAGE_SIZE + PAGE_SIZE / 255 + 16, RoundTrip(noise));
+
+  // a page-like mix: short runs of small integers between random bytes
+  std::string mixed;
+  while (mixed.size() < PAGE_SIZE) {
+    uint32_t value = rng() % 100;
+    mixed.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    mixed.append(rng() % 3 == 0 ? std::string(1, static_cast<char>(rng())) : std::string(4, '\0'));
+  }
+  EXPECT_GT(PAGE_SIZE, RoundTrip(mixed));
+
+  // Scenario: A buffer that is too small makes compression give up rather than overflow.
+  std::vector<char> small(64);
+  EXPECT_EQ(0, Lz4Compress(noise.data(), noise.size(), small.data(), small.size()));
+}
+
+// NOLINTNEXTLINE
+TEST(Lz4Test, FormatTest) {
+  // 3 literals, a 6 byte match 3 back; then 5 literals
+  const char block[] = {0x32, 'a', 'b', 'c', 0x03, 0x00, 0x50, 'x', 'y', 'z', 'z', 'y'};
+  char out[64];
+  size_t out_size = 0;
+  ASSERT_TRUE(Lz4Decompress(block, sizeof(block), out, sizeof(out), &out_size));
+  EXPECT_EQ("abcabcabcxyzzy", std::string(out, out_size));
+
+  // Scenario: Malformed blocks are rejected: truncated, a match before the start, and output too small.
+  EXPECT_FALSE(Lz4Decompress(block, 0, out, sizeof(out), &out_size));
+  EXPECT_FALSE(Lz4Decompress(block, 5, out, sizeof(out), &out_size));
+  EXPECT_FALSE(Lz4Decompress(block, 9, out, sizeof(out), &out_size));
+  const char before_start[] = {0x12, 'a', 0x02, 0x00, 0x10, 'b'};
+  EXPECT_FALSE(Lz4Decompress(before_start, sizeof(before_start), out, sizeof(out), &out_size));
+  EXPECT_FALSE(Lz4Decompress(block, sizeof(block), out, 10, &out_size));
+  const char no_offset[] = {0x12, 'a', 0x00, 0x00, 0x10, 'b'};
+  EXPECT_FALSE(Lz4Decompress(no_offset, sizeof(no_offset), out, sizeof(out), &out_size));
+
+  // Scenario: Garbage never crashes the decoder.
+  std::mt19937 rng(15445);
+  std::vector<char> garbage(256);
+  std::vector<char> page(PAGE_SIZE);
+  for (int round = 0; round < 1000; ++round) {
+    for (auto &c : garbage) {
+      c = static_cast<char>(rng());
+    }
+    Lz4Decompress(garbage.data(), rng() % garbage.size(), page.data(), page.size(), &out_size);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,347 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_manager_test.cpp
+//
+// Identification: test/recovery/log_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/log_manager.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class LogManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override { RemoveFiles(); }
+
+  void TearDown() override {
+    enable_logging = false;
+    RemoveFiles();
+  }
+
+  static void RemoveFiles() {
+    for (const char *name : {"test.db", "test.log", "test.fsm"}) {
+      remove(name);
+    }
+  }
+
+  /** The header fields of a logged record. */
+  struct Header {
+    int32_t size_;
+    lsn_t lsn_;
+    txn_id_t txn_id_;
+    lsn_t prev_lsn_;
+    LogRecordType type_;
+  };
+
+  /** @return the whole log file */
+  static std::vector<char> ReadLogFile(DiskManager *disk_manager) {
+    std::vector<char> log;
+    char buf[4096];
+    for (int offset = 0; disk_manager->ReadLog(buf, sizeof(buf), offset); offset += sizeof(buf)) {
+      log.insert(log.end(), buf, buf + sizeof(buf));
+    }
+    // ReadLog pads the last chunk with zeros, which no record starts with
+    return log;
+  }
+
+  /** @return the records of a log, by their offsets in it; stops at the first zero size */
+  static std::vector<size_t> SplitLog(const std::vector<char> &log) {
+    std::vector<size_t> offsets;
+    size_t offset = 0;
+    while (offset + sizeof(Header) <= log.size()) {
+      Header header;
+      memcpy(&header, &log[offset], sizeof(header));
+      if (header.size_ <= 0) {
+        break;
+      }
+      offsets.push_back(offset);
+      offset += header.size_;
+    }
+    return offsets;
+  }
+
+  static Header HeaderAt(const std::vector<char> &log, size_t offset) {
+    Header header;
+    memcpy(&header, &log[offset], sizeof(header));
+    return header;
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, AppendTest) {
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"name", TypeId::VARCHAR, 32}});
+  Tuple old_tuple({ValueFactory::GetIntegerValue(1), ValueFactory::GetVarcharValue("old")}, &schema);
+  Tuple new_tuple({ValueFactory::GetIntegerValue(1), ValueFactory::GetVarcharValue("a new name")}, &schema);
+  RID rid(3, 7);
+
+  // Scenario: Every kind of record is laid out as LogRecord documents, in LSN order.
+  std::vector<LogRecord> records;
+  records.emplace_back(5, INVALID_LSN, LogRecordType::BEGIN);
+  records.emplace_back(5, 0, LogRecordType::NEWPAGE, INVALID_PAGE_ID, 3);
+  records.emplace_back(5, 1, LogRecordType::INSERT, rid, old_tuple);
+  records.emplace_back(5, 2, LogRecordType::UPDATE, rid, old_tuple, new_tuple);
+  records.emplace_back(5, 3, LogRecordType::MARKDELETE, rid, new_tuple);
+  records.emplace_back(5, 4, LogRecordType::COMMIT);
+  for (size_t i = 0; i < records.size(); ++i) {
+    EXPECT_EQ(static_cast<lsn_t>(i), log_manager.AppendLogRecord(&records[i]));
+    EXPECT_EQ(static_cast<lsn_t>(i), records[i].GetLSN());
+  }
+  EXPECT_EQ(INVALID_LSN, log_manager.GetPersistentLSN());
+
+  // without a flush thread, Flush writes the log itself
+  log_manager.Flush(2);
+  EXPECT_EQ(5, log_manager.GetPersistentLSN());
+  EXPECT_EQ(1, disk_manager.GetNumFlushes());
+  log_manager.Flush(5);
+  EXPECT_EQ(1, disk_manager.GetNumFlushes());
+
+  std::vector<char> log = ReadLogFile(&disk_manager);
+  std::vector<size_t> offsets = SplitLog(log);
+  ASSERT_EQ(records.size(), offsets.size());
+  for (size_t i = 0; i < records.size(); ++i) {
+    Header header = HeaderAt(log, offsets[i]);
+    EXPECT_EQ(records[i].GetSize(), header.size_);
+    EXPECT_EQ(static_cast<lsn_t>(i), header.lsn_);
+    EXPECT_EQ(5, header.txn_id_);
+    EXPECT_EQ(records[i].GetPrevLSN(), header.prev_lsn_);
+    EXPECT_EQ(records[i].GetLogRecordType(), header.type_);
+  }
+  const char *payload = &log[offsets[1] + sizeof(Header)];
+  page_id_t page_ids[2];
+  memcpy(page_ids, payload, sizeof(page_ids));
+  EXPECT_EQ(INVALID_PAGE_ID, page_ids[0]);
+  EXPECT_EQ(3, page_ids[1]);
+
+  payload = &log[offsets[3] + sizeof(Header)];
+  RID logged_rid;
+  memcpy(&logged_rid, payload, sizeof(RID));
+  EXPECT_EQ(rid, logged_rid);
+  Tuple logged_old;
+  Tuple logged_new;
+  logged_old.DeserializeFrom(payload + sizeof(RID));
+  logged_new.DeserializeFrom(payload + sizeof(RID) + sizeof(int32_t) + logged_old.GetLength());
+  EXPECT_EQ("old", logged_old.GetValue(&schema, 1).ToString());
+  EXPECT_EQ("a new name", logged_new.GetValue(&schema, 1).ToString());
+
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, ConcurrentAppendTest) {
+  const int num_threads = 8;
+  const int records_per_thread = 2000;
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"payload", TypeId::VARCHAR, 200}});
+
+  // Scenario: Appends from many threads fill the log buffer over and over; nothing is lost or torn.
+  log_manager.RunFlushThread();
+  EXPECT_TRUE(enable_logging);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      for (int i = 0; i < records_per_thread; ++i) {
+        int id = tid * records_per_thread + i;
+        Tuple tuple({ValueFactory::GetIntegerValue(id), ValueFactory::GetVarcharValue(std::string(id % 200, 'x'))},
+                    &schema);
+        LogRecord record(tid, INVALID_LSN, LogRecordType::INSERT, RID(id, 0), tuple);
+        log_manager.AppendLogRecord(&record);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  log_manager.StopFlushThread();
+  EXPECT_FALSE(enable_logging);
+  const int num_records = num_threads * records_per_thread;
+  EXPECT_EQ(num_records - 1, log_manager.GetPersistentLSN());
+  EXPECT_GT(disk_manager.GetNumFlushes(), 1);
+
+  std::vector<char> log = ReadLogFile(&disk_manager);
+  std::vector<size_t> offsets = SplitLog(log);
+  ASSERT_EQ(num_records, offsets.size());
+  std::vector<bool> seen(num_records, false);
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    Header header = HeaderAt(log, offsets[i]);
+    ASSERT_EQ(static_cast<lsn_t>(i), header.lsn_);
+    ASSERT_EQ(LogRecordType::INSERT, header.type_);
+    RID rid;
+    memcpy(&rid, &log[offsets[i] + sizeof(Header)], sizeof(RID));
+    Tuple tuple;
+    tuple.DeserializeFrom(&log[offsets[i] + sizeof(Header) + sizeof(RID)]);
+    int id = tuple.GetValue(&schema, 0).GetAs<int32_t>();
+    ASSERT_EQ(rid.GetPageId(), id);
+    ASSERT_EQ(header.txn_id_, id / records_per_thread);
+    ASSERT_EQ(std::string(id % 200, 'x'), tuple.GetValue(&schema, 1).ToString());
+    ASSERT_FALSE(seen[id]);
+    seen[id] = true;
+  }
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, GroupCommitTest) {
+  const int num_threads = 8;
+  const int commits_per_thread = 50;
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  LockManager lock_manager;
+  TransactionManager txn_manager(&lock_manager, &log_manager);
+
+  // Scenario: Every commit returns durable, and concurrent commits share log writes.
+  log_manager.RunFlushThread();
+  std::vector<std::thread> threads;
+  std::atomic<int> not_durable(0);
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < commits_per_thread; ++i) {
+        Transaction *txn = txn_manager.Begin();
+        txn_manager.Commit(txn);
+        if (log_manager.GetPersistentLSN() < txn->GetPrevLSN()) {
+          not_durable++;
+        }
+        delete txn;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, not_durable);
+  EXPECT_LT(disk_manager.GetNumFlushes(), num_threads * commits_per_thread);
+  log_manager.StopFlushThread();
+
+  // BEGIN and COMMIT of each transaction, the commit pointing back at the begin
+  std::vector<char> log = ReadLogFile(&disk_manager);
+  std::vector<size_t> offsets = SplitLog(log);
+  ASSERT_EQ(2 * num_threads * commits_per_thread, offsets.size());
+  int num_commits = 0;
+  for (size_t offset : offsets) {
+    Header header = HeaderAt(log, offset);
+    if (header.type_ == LogRecordType::COMMIT) {
+      num_commits++;
+      EXPECT_EQ(LogRecordType::BEGIN, HeaderAt(log, offsets[header.prev_lsn_]).type_);
+    }
+  }
+  EXPECT_EQ(num_threads * commits_per_thread, num_commits);
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, WriteAheadTest) {
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  LockManager lock_manager;
+  auto *bpm = new BufferPoolManagerInstance(8, &disk_manager, &log_manager);
+  Schema schema({Column{"id", TypeId::INTEGER}});
+
+  // Scenario: A page goes to disk only after the log records that changed it.
+  log_manager.RunFlushThread();
+  Transaction txn(0);
+  auto *table = new TableHeap(bpm, &lock_manager, &log_manager, &txn);
+  RID rid;
+  ASSERT_TRUE(table->InsertTuple(Tuple({ValueFactory::GetIntegerValue(1)}, &schema), &rid, &txn));
+  lsn_t insert_lsn = txn.GetPrevLSN();
+  EXPECT_NE(INVALID_LSN, insert_lsn);
+  bpm->FlushAllPages();
+  EXPECT_GE(log_manager.GetPersistentLSN(), insert_lsn);
+  log_manager.StopFlushThread();
+
+  // Scenario: A page that carries no LSN, e.g. a hash table header page, does not wait for the log, whatever its
+  // bytes at the LSN's offset.
+  enable_logging = true;
+  int num_flushes = disk_manager.GetNumFlushes();
+  LogRecord record(txn.GetTransactionId(), txn.GetPrevLSN(), LogRecordType::INSERT, rid,
+                   Tuple({ValueFactory::GetIntegerValue(2)}, &schema));
+  lsn_t record_lsn = log_manager.AppendLogRecord(&record);
+  page_id_t page_id;
+  Page *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  memset(page->GetData(), 0x7f, PAGE_SIZE);
+  bpm->UnpinPage(page_id, true);
+  EXPECT_TRUE(bpm->FlushPage(page_id));
+  EXPECT_EQ(num_flushes, disk_manager.GetNumFlushes());
+  EXPECT_LT(log_manager.GetPersistentLSN(), record_lsn);
+  enable_logging = false;
+
+  delete table;
+  delete bpm;
+  disk_manager.ShutDown();
+}
+
+// Commit throughput with group commit: every client thread runs transactions of one INSERT record each, back to
+// back, for a second. With one thread every commit waits for its own log write and sync; more threads share them.
+// Run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, DISABLED_GroupCommitBenchmark) {
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"payload", TypeId::VARCHAR, 100}});
+  Tuple tuple({ValueFactory::GetIntegerValue(1), ValueFactory::GetVarcharValue(std::string(100, 'x'))}, &schema);
+
+  for (int num_threads : {1, 2, 4, 8, 16, 32, 64}) {
+    RemoveFiles();
+    auto *disk_manager = new DiskManager("test.db");
+    auto *log_manager = new LogManager(disk_manager);
+    LockManager lock_manager;
+    TransactionManager txn_manager(&lock_manager, log_manager);
+    log_manager->RunFlushThread();
+
+    std::atomic<bool> stop(false);
+    std::atomic<int64_t> num_commits(0);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([&] {
+        int64_t commits = 0;
+        while (!stop) {
+          Transaction *txn = txn_manager.Begin();
+          LogRecord record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::INSERT, RID(0, 0), tuple);
+          txn->SetPrevLSN(log_manager->AppendLogRecord(&record));
+          txn_manager.Commit(txn);
+          delete txn;
+          commits++;
+        }
+        num_commits += commits;
+      });
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    stop = true;
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    log_manager->StopFlushThread();
+    int num_flushes = disk_manager->GetNumFlushes();
+    std::cout << "  " << num_threads << " threads: " << num_commits / elapsed.count() << " commits/s, "
+              << static_cast<double>(num_commits) / num_flushes << " commits per log write, "
+              << elapsed.count() * 1e6 * num_threads / num_commits << " us/commit" << std::endl;
+    disk_manager->ShutDown();
+    delete log_manager;
+    delete disk_manager;
+  }
+}
+
+}  // namespace bustub
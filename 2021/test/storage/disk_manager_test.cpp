@@ -10,11 +10,26 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
 
 namespace bustub {
 
@@ -24,13 +39,26 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
+    remove("test.cpm");
+    RemoveStripeFiles();
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
+    remove("test.cpm");
+    RemoveStripeFiles();
   };
+
+  static void RemoveStripeFiles() {
+    remove("test.tbs");
+    for (const char *name : {"test_1.db", "test_2.db", "test_3.db"}) {
+      remove(name);
+    }
+  }
 };
 
 // NOLINTNEXTLINE
@@ -72,7 +100,950 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, BatchAndConcurrentIoTest) {
+  std::string db_file("test.db");
+  DiskManager dm(db_file);
+  const int num_threads = 8;
+  const page_id_t pages_per_thread = 32;
+
+  // Scenario: Threads write and read back disjoint pages at the same time.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&dm, tid] {
+      char data[PAGE_SIZE];
+      char buf[PAGE_SIZE];
+      for (page_id_t i = 0; i < pages_per_thread; ++i) {
+        page_id_t page_id = i * num_threads + tid;
+        snprintf(data, sizeof(data), "page %d", page_id);
+        dm.WritePage(page_id, data);
+        dm.ReadPage(page_id, buf);
+        EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  dm.Sync();
+  EXPECT_EQ(num_threads * pages_per_thread, dm.GetNumWrites());
+  EXPECT_EQ(num_threads * pages_per_thread, dm.GetNumReads());
+
+  // Scenario: A batch with adjacent runs, a gap and pages past the end of the file; the latter read as zeros.
+  page_id_t last = num_threads * pages_per_thread - 1;
+  std::vector<page_id_t> page_ids = {3, 4, 5, 9, last, last + 1, last + 2};
+  std::vector<std::vector<char>> bufs(page_ids.size(), std::vector<char>(PAGE_SIZE, 'x'));
+  std::vector<char *> data;
+  for (auto &buf : bufs) {
+    data.push_back(buf.data());
+  }
+  dm.ReadPages(page_ids.data(), data.data(), page_ids.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    if (page_ids[i] <= last) {
+      EXPECT_EQ("page " + std::to_string(page_ids[i]), std::string(data[i]));
+    } else {
+      EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), bufs[i]);
+    }
+  }
+  EXPECT_EQ(num_threads * pages_per_thread + static_cast<int>(page_ids.size()), dm.GetNumReads());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AsyncIoTest) {
+  for (bool use_io_uring : {true, false}) {
+    std::string db_file("test.db");
+    DiskManagerOptions options;
+    options.use_io_uring_ = use_io_uring;
+    DiskManager dm(db_file, options);
+    if (use_io_uring && !dm.UsesIoUring()) {
+      std::cout << "  io_uring is not available, only the fallback is tested" << std::endl;
+    }
+    // more pages than the queue holds, so submitting also has to make room
+    const page_id_t num_pages = DiskManager::ASYNC_QUEUE_DEPTH * 3;
+
+    // Scenario: Writes complete through Poll, and only through Poll.
+    std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+    size_t written = 0;
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      snprintf(data[page_id].data(), PAGE_SIZE, "page %d", page_id);
+      dm.SubmitWrite(page_id, data[page_id].data(), [&written](bool ok) {
+        EXPECT_TRUE(ok);
+        written++;
+      });
+    }
+    while (dm.GetNumPending() > 0) {
+      dm.Poll(1);
+    }
+    EXPECT_EQ(num_pages, written);
+    EXPECT_EQ(0, dm.Poll(1));
+
+    // Scenario: Reads, including one past the end of the file that comes back zeroed, and a callback that chains
+    // another read.
+    std::vector<std::vector<char>> bufs(num_pages + 2, std::vector<char>(PAGE_SIZE, 'x'));
+    size_t read = 0;
+    for (page_id_t page_id = num_pages; page_id >= 0; --page_id) {
+      dm.SubmitRead(page_id, bufs[page_id].data(), [&read](bool ok) {
+        EXPECT_TRUE(ok);
+        read++;
+      });
+    }
+    bool chained = false;
+    dm.SubmitRead(0, bufs[num_pages + 1].data(), [&dm, &bufs, &chained](bool ok) {
+      dm.SubmitRead(1, bufs[num_pages + 1].data(), [&chained](bool ok) { chained = ok; });
+    });
+    // a full queue makes SubmitRead poll too, so some callbacks have run already
+    while (dm.GetNumPending() > 0) {
+      dm.Poll(1);
+    }
+    EXPECT_EQ(num_pages + 1, read);
+    EXPECT_TRUE(chained);
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      EXPECT_EQ(data[page_id], bufs[page_id]);
+    }
+    EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), bufs[num_pages]);
+    EXPECT_EQ(data[1], bufs[num_pages + 1]);
+
+    // Scenario: Several threads submit and poll at once; every callback runs exactly once.
+    const int num_threads = 4;
+    std::atomic<int> callbacks(0);
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([&dm, &callbacks, tid] {
+        std::vector<std::vector<char>> thread_bufs(64, std::vector<char>(PAGE_SIZE));
+        for (size_t i = 0; i < thread_bufs.size(); ++i) {
+          dm.SubmitRead(static_cast<page_id_t>(i) * num_threads + tid, thread_bufs[i].data(),
+                        [&callbacks](bool ok) { callbacks++; });
+        }
+        while (dm.GetNumPending() > 0) {
+          dm.Poll(1);
+        }
+        for (size_t i = 0; i < thread_bufs.size(); ++i) {
+          EXPECT_EQ("page " + std::to_string(i * num_threads + tid), std::string(thread_bufs[i].data()));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(num_threads * 64, callbacks);
+
+    // Scenario: A batch of scattered runs reads through the queue as well.
+    std::vector<page_id_t> page_ids = {1, 2, 3, 10, 20, 21, num_pages + 5};
+    std::vector<char *> batch;
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      batch.push_back(bufs[i].data());
+    }
+    dm.ReadPages(page_ids.data(), batch.data(), page_ids.size());
+    for (size_t i = 0; i + 1 < page_ids.size(); ++i) {
+      EXPECT_EQ(data[page_ids[i]], bufs[i]);
+    }
+    EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), bufs[page_ids.size() - 1]);
+
+    dm.ShutDown();
+    remove("test.db");
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_RandomIoBenchmark) {
+  // Random 4 KB page reads and writes over a 64 MiB file, all threads sharing one DiskManager.
+  const page_id_t num_pages = 16384;
+  const int num_ops = 80000;
+  std::string db_file("test.db");
+  DiskManager dm(db_file);
+  char data[PAGE_SIZE] = {0};
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    dm.WritePage(page_id, data);
+  }
+
+  for (bool write : {false, true}) {
+    for (int num_threads : {1, 4, 16, 64}) {
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> threads;
+      for (int tid = 0; tid < num_threads; ++tid) {
+        threads.emplace_back([&dm, write, tid, num_threads] {
+          std::mt19937 rng(tid);
+          std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+          char buf[PAGE_SIZE];
+          std::memset(buf, tid, sizeof(buf));
+          for (int i = 0; i < num_ops / num_threads; ++i) {
+            if (write) {
+              dm.WritePage(dist(rng), buf);
+            } else {
+              dm.ReadPage(dist(rng), buf);
+            }
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+      std::cout << "  " << (write ? "write" : "read") << ", " << num_threads << " threads: "
+                << static_cast<double>(num_ops / num_threads * num_threads) / elapsed.count() * 1000 << " kIOPS"
+                << std::endl;
+    }
+  }
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIoTest) {
+  std::string db_file("test.db");
+  DiskManagerOptions options;
+  options.direct_io_ = true;
+  DiskManager dm(db_file, options);
+  if (!dm.UsesDirectIo()) {
+    std::cout << "  O_DIRECT is not supported here, only the buffered fallback is tested" << std::endl;
+  }
+
+  // one aligned page buffer, and one deliberately misaligned that has to go through the bounce buffer
+  const page_id_t num_pages = 8;
+  auto *arena = static_cast<char *>(aligned_alloc(DiskManager::DIRECT_IO_ALIGNMENT, (num_pages + 1) * PAGE_SIZE));
+  char *aligned = arena;
+  char *unaligned = arena + PAGE_SIZE + 8;
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    char *buf = page_id % 2 == 0 ? aligned : unaligned;
+    memset(buf, 'a' + page_id, PAGE_SIZE);
+    dm.WritePage(page_id, buf);
+  }
+  dm.Sync();
+
+  char check[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    char *buf = page_id % 2 == 0 ? unaligned : aligned;
+    dm.ReadPage(page_id, buf);
+    memset(check, 'a' + page_id, PAGE_SIZE);
+    EXPECT_EQ(0, memcmp(buf, check, PAGE_SIZE));
+  }
+  // past the end of the file
+  dm.ReadPage(num_pages + 3, unaligned);
+  memset(check, 0, PAGE_SIZE);
+  EXPECT_EQ(0, memcmp(unaligned, check, PAGE_SIZE));
+
+  // Scenario: A batch mixing aligned and unaligned buffers, read by runs and through the asynchronous path.
+  std::vector<std::vector<char>> heap_bufs(2, std::vector<char>(PAGE_SIZE + 1));
+  std::vector<page_id_t> page_ids = {1, 2, 3, 6};
+  std::vector<char *> batch = {arena + PAGE_SIZE * 0, heap_bufs[0].data() + 1, arena + PAGE_SIZE * 1,
+                               heap_bufs[1].data() + 1};
+  dm.ReadPages(page_ids.data(), batch.data(), page_ids.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    memset(check, 'a' + page_ids[i], PAGE_SIZE);
+    EXPECT_EQ(0, memcmp(batch[i], check, PAGE_SIZE));
+  }
+  int completed = 0;
+  memset(heap_bufs[0].data() + 1, 'z', PAGE_SIZE);
+  dm.SubmitWrite(num_pages, heap_bufs[0].data() + 1, [&completed](bool ok) { completed += ok ? 1 : 0; });
+  dm.SubmitRead(5, aligned, [&completed](bool ok) { completed += ok ? 1 : 0; });
+  while (dm.GetNumPending() > 0) {
+    dm.Poll(1);
+  }
+  EXPECT_EQ(2, completed);
+  memset(check, 'a' + 5, PAGE_SIZE);
+  EXPECT_EQ(0, memcmp(aligned, check, PAGE_SIZE));
+  dm.ShutDown();
+
+  // the file is the same whether it is read with or without the page cache
+  DiskManager buffered(db_file);
+  EXPECT_FALSE(buffered.UsesDirectIo());
+  buffered.ReadPage(num_pages, aligned);
+  memset(check, 'z', PAGE_SIZE);
+  EXPECT_EQ(0, memcmp(aligned, check, PAGE_SIZE));
+  buffered.ShutDown();
+  free(arena);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AllocationMapTest) {
+  std::string db_file("test.db");
+  char data[PAGE_SIZE];
+  memset(data, 'x', PAGE_SIZE);
+  auto *dm = new DiskManager(db_file);
+
+  // Scenario: Fresh pages come in order; freed pages are handed out again, most recently freed first.
+  for (page_id_t page_id = 0; page_id < 16; ++page_id) {
+    EXPECT_EQ(page_id, dm->AllocatePage());
+    dm->WritePage(page_id, data);
+  }
+  dm->DeallocatePage(3);
+  dm->DeallocatePage(9);
+  dm->DeallocatePage(9);
+  dm->DeallocatePage(100);
+  EXPECT_EQ(14, dm->GetNumAllocatedPages());
+  EXPECT_FALSE(dm->IsAllocated(3));
+  EXPECT_EQ(9, dm->AllocatePage());
+  EXPECT_EQ(3, dm->AllocatePage());
+  EXPECT_EQ(16, dm->AllocatePage());
+  EXPECT_EQ(17, dm->GetNumAllocatedPages());
+
+  // Scenario: The map survives a restart, and the free pages come back lowest first.
+  for (page_id_t page_id : {5, 6, 7, 12, 13, 14, 15, 16}) {
+    dm->DeallocatePage(page_id);
+  }
+  dm->ShutDown();
+  delete dm;
+  dm = new DiskManager(db_file);
+  EXPECT_EQ(9, dm->GetNumAllocatedPages());
+  EXPECT_TRUE(dm->IsAllocated(4));
+  EXPECT_FALSE(dm->IsAllocated(5));
+
+  // Scenario: Shrink truncates the free tail and punches out the free pages before it.
+  EXPECT_EQ(12, dm->Shrink());
+  struct stat stat_buf;
+  ASSERT_EQ(0, stat(db_file.c_str(), &stat_buf));
+  EXPECT_EQ(12 * PAGE_SIZE, stat_buf.st_size);
+  std::cout << "  blocks in use after shrink: " << stat_buf.st_blocks * 512 / PAGE_SIZE << " pages" << std::endl;
+  char buf[PAGE_SIZE];
+  dm->ReadPage(4, buf);
+  EXPECT_EQ(0, memcmp(buf, data, PAGE_SIZE));
+  for (page_id_t expected : {5, 6, 7, 12, 13}) {
+    EXPECT_EQ(expected, dm->AllocatePage());
+  }
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: A db file without a map has all of its pages allocated; the stale map of a removed file is ignored.
+  remove("test.fsm");
+  dm = new DiskManager(db_file);
+  EXPECT_EQ(12, dm->GetNumAllocatedPages());
+  EXPECT_EQ(12, dm->AllocatePage());
+  dm->ShutDown();
+  delete dm;
+  remove("test.db");
+  dm = new DiskManager(db_file);
+  EXPECT_EQ(0, dm->GetNumAllocatedPages());
+  EXPECT_EQ(0, dm->AllocatePage());
+  dm->ShutDown();
+  delete dm;
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AllocationPartitionTest) {
+  std::string db_file("test.db");
+  DiskManager dm(db_file);
+  const uint32_t num_partitions = 4;
+  const int pages_per_thread = 1000;
+  dm.SetAllocationPartitions(num_partitions, [](page_id_t page_id) { return page_id % num_partitions; });
+
+  // Scenario: Threads allocate and free concurrently, each from its own partition, and only get pages it owns.
+  std::vector<std::vector<page_id_t>> allocated(num_partitions);
+  std::vector<std::thread> threads;
+  for (uint32_t partition = 0; partition < num_partitions; ++partition) {
+    threads.emplace_back([&dm, &allocated, partition] {
+      std::vector<page_id_t> &pages = allocated[partition];
+      for (int i = 0; i < pages_per_thread; ++i) {
+        pages.push_back(dm.AllocatePage(partition));
+        // every third page goes back and is reused right away
+        if (i % 3 == 0) {
+          dm.DeallocatePage(pages.back());
+          EXPECT_EQ(pages.back(), dm.AllocatePage(partition));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (uint32_t partition = 0; partition < num_partitions; ++partition) {
+    for (int i = 0; i < pages_per_thread; ++i) {
+      EXPECT_EQ(static_cast<page_id_t>(i * num_partitions + partition), allocated[partition][i]);
+    }
+  }
+  EXPECT_EQ(num_partitions * pages_per_thread, dm.GetNumAllocatedPages());
+
+  // Scenario: A page freed behind a partition's cursor is reused by that partition only.
+  dm.DeallocatePage(2);
+  EXPECT_EQ(static_cast<page_id_t>(num_partitions * pages_per_thread + 1), dm.AllocatePage(1));
+  EXPECT_EQ(2, dm.AllocatePage(2));
+
+  // Scenario: Repartitioning rebuilds the free lists from the bitmap.
+  dm.DeallocatePage(5);
+  dm.DeallocatePage(6);
+  dm.SetAllocationPartitions(1, nullptr);
+  EXPECT_EQ(5, dm.AllocatePage());
+  EXPECT_EQ(6, dm.AllocatePage());
+
+  // Scenario: An extent is contiguous and starts past every allocated page; allocation cursors skip over it.
+  const page_id_t extent = dm.AllocateExtent(8);
+  EXPECT_EQ(static_cast<page_id_t>(num_partitions * pages_per_thread + 2), extent);
+  for (page_id_t page_id = extent; page_id < extent + 8; ++page_id) {
+    EXPECT_TRUE(dm.IsAllocated(page_id));
+  }
+  EXPECT_EQ(static_cast<page_id_t>(num_partitions * pages_per_thread), dm.AllocatePage());
+  EXPECT_EQ(extent + 8, dm.AllocatePage());
+  EXPECT_EQ(extent + 9, dm.AllocateExtent(4));
+  dm.ShutDown();
+}
+
+/** Flips one byte of a page behind the disk manager's back. */
+static void CorruptPage(const std::string &db_file, page_id_t page_id) {
+  int fd = open(db_file.c_str(), O_RDWR);
+  ASSERT_GE(fd, 0);
+  char byte;
+  off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE + 100;
+  ASSERT_EQ(1, pread(fd, &byte, 1, offset));
+  byte = static_cast<char>(~byte);
+  ASSERT_EQ(1, pwrite(fd, &byte, 1, offset));
+  close(fd);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChecksumTest) {
+  std::string db_file("test.db");
+  const page_id_t num_pages = 8;
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  DiskManagerOptions options;
+  options.checksums_ = true;
+  auto *dm = new DiskManager(db_file, options);
+  ASSERT_TRUE(dm->UsesChecksums());
+
+  // Scenario: A page reads back with its trailer cleared; the buffer it was written from is left as it was.
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    EXPECT_EQ(page_id, dm->AllocatePage());
+    memset(data, 'a' + page_id, PAGE_SIZE);
+    dm->WritePage(page_id, data);
+  }
+  EXPECT_EQ('a' + num_pages - 1, data[PAGE_SIZE - 1]);
+  dm->ReadPage(num_pages - 1, buf);
+  EXPECT_EQ(0, memcmp(buf, data, PAGE_USABLE_SIZE));
+  EXPECT_EQ(0, buf[PAGE_SIZE - 1]);
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: A corrupted page is caught by a plain read, a batched read and an asynchronous read.
+  CorruptPage(db_file, 2);
+  CorruptPage(db_file, 5);
+  dm = new DiskManager(db_file, options);
+  EXPECT_TRUE(dm->VerifyPage(1));
+  dm->ReadPage(1, buf);
+  EXPECT_EQ(0, dm->GetNumChecksumFailures());
+  dm->ReadPage(2, buf);
+  EXPECT_EQ(1, dm->GetNumChecksumFailures());
+  std::vector<std::vector<char>> bufs(3, std::vector<char>(PAGE_SIZE));
+  std::vector<page_id_t> page_ids = {4, 5, 6};
+  std::vector<char *> batch = {bufs[0].data(), bufs[1].data(), bufs[2].data()};
+  dm->ReadPages(page_ids.data(), batch.data(), page_ids.size());
+  EXPECT_EQ(2, dm->GetNumChecksumFailures());
+  std::vector<bool> results;
+  dm->SubmitRead(5, bufs[0].data(), [&results](bool ok) { results.push_back(ok); });
+  dm->SubmitRead(6, bufs[1].data(), [&results](bool ok) { results.push_back(ok); });
+  while (dm->GetNumPending() > 0) {
+    dm->Poll(1);
+  }
+  EXPECT_EQ(std::vector<bool>({false, true}), results);
+  EXPECT_FALSE(dm->VerifyPage(2));
+  EXPECT_EQ((std::vector<page_id_t>{2, 5}), dm->GetCorruptPages());
+
+  // Scenario: Rewriting a page replaces its checksum; a freed page is not checked.
+  memset(data, 'z', PAGE_SIZE);
+  dm->WritePage(2, data);
+  EXPECT_TRUE(dm->VerifyPage(2));
+  dm->DeallocatePage(5);
+  EXPECT_TRUE(dm->VerifyPage(5));
+  EXPECT_TRUE(dm->GetCorruptPages().empty());
+  // a page written asynchronously is checked like any other
+  dm->SubmitWrite(6, data, nullptr);
+  while (dm->GetNumPending() > 0) {
+    dm->Poll(1);
+  }
+  dm->ShutDown();
+  delete dm;
+  CorruptPage(db_file, 6);
+  dm = new DiskManager(db_file, options);
+  EXPECT_FALSE(dm->VerifyPage(6));
+  EXPECT_TRUE(dm->VerifyPage(2));
+
+  // Scenario: A checksum goes to disk with its page, so pages written since the last Sync check out after a crash.
+  memset(data, 'q', PAGE_SIZE);
+  dm->WritePage(3, data);
+  dm->WritePage(4, data);
+  delete dm;
+  dm = new DiskManager(db_file, options);
+  dm->ReadPage(3, buf);
+  EXPECT_TRUE(dm->VerifyPage(4));
+  EXPECT_EQ(0, dm->GetNumChecksumFailures());
+
+  // Scenario: A page that keeps changing while it is written, like a frame flushed under a pin, is stored with the
+  // checksum of the bytes that reached the disk.
+  std::atomic<bool> done = false;
+  std::thread changer([&data, &done] {
+    volatile char *page = data;
+    for (char round = 0; !done; ++round) {
+      for (size_t i = 0; i < PAGE_SIZE; i += 64) {
+        page[i] = round;
+      }
+    }
+  });
+  for (int i = 0; i < 200; ++i) {
+    dm->WritePage(1, data);
+    ASSERT_TRUE(dm->VerifyPage(1));
+  }
+  done = true;
+  changer.join();
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: With checksums off nothing is checked, and the pages written meanwhile are not checked later either.
+  dm = new DiskManager(db_file);
+  EXPECT_FALSE(dm->UsesChecksums());
+  dm->ReadPage(6, buf);
+  EXPECT_TRUE(dm->VerifyPage(6));
+  EXPECT_EQ(0, dm->GetNumChecksumFailures());
+  // a page layout leaves the trailer zero
+  memset(data, 'y', PAGE_USABLE_SIZE);
+  memset(data + PAGE_USABLE_SIZE, 0, PAGE_CHECKSUM_SIZE);
+  dm->WritePage(1, data);
+  dm->ShutDown();
+  delete dm;
+  dm = new DiskManager(db_file, options);
+  EXPECT_TRUE(dm->VerifyPage(1));
+  EXPECT_FALSE(dm->VerifyPage(6));
+  dm->ShutDown();
+  delete dm;
+}
+
+/** Fills a page that compresses to roughly a quarter: small integers among zeros, like a table page. */
+static void FillCompressible(char *page, int seed) {
+  std::mt19937 rng(seed);
+  memset(page, 0, PAGE_SIZE);
+  for (size_t offset = 0; offset + sizeof(int32_t) <= PAGE_SIZE; offset += 8) {
+    int32_t value = static_cast<int32_t>(rng() % 100);
+    memcpy(page + offset, &value, sizeof(value));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, CompressionTest) {
+  std::string db_file("test.db");
+  const page_id_t num_pages = 64;
+  DiskManagerOptions options;
+  options.compress_pages_ = true;
+  options.checksums_ = true;
+  auto *dm = new DiskManager(db_file, options);
+  ASSERT_TRUE(dm->UsesCompression());
+
+  // Scenario: Pages read back as written, whether they compress well, not at all, or were never written.
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  std::mt19937 rng(15445);
+  auto fill = [&rng](char *page, page_id_t page_id) {
+    if (page_id % 8 == 7) {
+      for (size_t i = 0; i < PAGE_SIZE; ++i) {
+        page[i] = static_cast<char>(rng());
+      }
+    } else {
+      FillCompressible(page, page_id);
+    }
+  };
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    EXPECT_EQ(page_id, dm->AllocatePage());
+    fill(data, page_id);
+    dm->WritePage(page_id, data);
+    dm->ReadPage(page_id, buf);
+    EXPECT_EQ(0, memcmp(buf, data, PAGE_USABLE_SIZE));
+  }
+  EXPECT_EQ(num_pages, dm->AllocatePage());
+  dm->ReadPage(num_pages, buf);
+  memset(data, 0, PAGE_SIZE);
+  EXPECT_EQ(0, memcmp(buf, data, PAGE_USABLE_SIZE));
+  uint64_t stored_bytes = dm->GetNumStoredBytes();
+  EXPECT_GT(num_pages * PAGE_SIZE * 3 / 4, stored_bytes);
+  dm->ShutDown();
+  delete dm;
+  struct stat stat_buf;
+  ASSERT_EQ(0, stat(db_file.c_str(), &stat_buf));
+  EXPECT_GT(num_pages * PAGE_SIZE * 3 / 4, stat_buf.st_size);
+  std::cout << "  " << num_pages << " pages stored in " << stored_bytes << " bytes, file of " << stat_buf.st_size
+            << " bytes" << std::endl;
+
+  // Scenario: After a restart pages read back through every read path.
+  dm = new DiskManager(db_file, options);
+  EXPECT_EQ(stored_bytes, dm->GetNumStoredBytes());
+  EXPECT_EQ(num_pages + 1, dm->GetNumAllocatedPages());
+  std::vector<std::vector<char>> bufs(3, std::vector<char>(PAGE_SIZE));
+  std::vector<page_id_t> page_ids = {6, 7, 8};
+  std::vector<char *> batch = {bufs[0].data(), bufs[1].data(), bufs[2].data()};
+  dm->ReadPages(page_ids.data(), batch.data(), page_ids.size());
+  FillCompressible(data, 6);
+  EXPECT_EQ(0, memcmp(bufs[0].data(), data, PAGE_USABLE_SIZE));
+  FillCompressible(data, 8);
+  EXPECT_EQ(0, memcmp(bufs[2].data(), data, PAGE_USABLE_SIZE));
+  bool read_ok = false;
+  dm->SubmitRead(9, buf, [&read_ok](bool ok) { read_ok = ok; });
+  while (dm->GetNumPending() > 0) {
+    dm->Poll(1);
+  }
+  EXPECT_TRUE(read_ok);
+  FillCompressible(data, 9);
+  EXPECT_EQ(0, memcmp(buf, data, PAGE_USABLE_SIZE));
+  EXPECT_TRUE(dm->VerifyPage(9));
+
+  // Scenario: Rewrites move pages to new slots; the old ones are reused once the map is saved, so the file stops
+  // growing.
+  std::vector<off_t> file_sizes;
+  for (int round = 0; round < 40; ++round) {
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      FillCompressible(data, page_id + round);
+      dm->WritePage(page_id, data);
+    }
+    if (round % 10 == 9) {
+      dm->Sync();
+      ASSERT_EQ(0, stat(db_file.c_str(), &stat_buf));
+      file_sizes.push_back(stat_buf.st_size);
+    }
+  }
+  // the file ends with the last slot written, not on a sector boundary
+  EXPECT_GE(file_sizes[1] + static_cast<off_t>(PAGE_SIZE), file_sizes[3]);
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    dm->ReadPage(page_id, buf);
+    FillCompressible(data, page_id + 39);
+    EXPECT_EQ(0, memcmp(buf, data, PAGE_USABLE_SIZE));
+  }
+
+  // Scenario: A crash loses the writes since the last save of the map, not the pages they replaced.
+  FillCompressible(data, 1000);
+  dm->WritePage(3, data);
+  delete dm;
+  dm = new DiskManager(db_file, options);
+  dm->ReadPage(3, buf);
+  FillCompressible(data, 3 + 39);
+  EXPECT_EQ(0, memcmp(buf, data, PAGE_USABLE_SIZE));
+
+  // Scenario: Freed pages give their slots back, and Shrink the space at the end of the file.
+  for (page_id_t page_id = 0; page_id <= num_pages; ++page_id) {
+    if (page_id >= 8) {
+      dm->DeallocatePage(page_id);
+    }
+  }
+  dm->Sync();
+  EXPECT_EQ(8, dm->Shrink());
+  ASSERT_EQ(0, stat(db_file.c_str(), &stat_buf));
+  EXPECT_GE(static_cast<off_t>(8 * PAGE_SIZE), stat_buf.st_size);
+  dm->ReadPage(7, buf);
+  EXPECT_EQ(0, dm->GetNumChecksumFailures());
+
+  // Scenario: Damage to a compressed page is caught.
+  dm->ShutDown();
+  delete dm;
+  CorruptPage(db_file, 0);
+  dm = new DiskManager(db_file, options);
+  for (page_id_t page_id = 0; page_id < 8; ++page_id) {
+    dm->ReadPage(page_id, buf);
+  }
+  EXPECT_LT(0, dm->GetNumChecksumFailures());
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: A file that is not compressed, or a compressed one mapped read-only, is refused.
+  remove("test.cpm");
+  EXPECT_THROW(DiskManager(db_file, options), Exception);
+  options.mmap_read_only_ = true;
+  EXPECT_THROW(DiskManager(db_file, options), Exception);
+}
+
+/** @return the size of a file in pages, -1 if it does not exist */
+static off_t FilePages(const std::string &name) {
+  struct stat stat_buf;
+  return stat(name.c_str(), &stat_buf) == 0 ? stat_buf.st_size / PAGE_SIZE : -1;
+}
+
+/** @return true if page file_page of a file holds the page written for page_id */
+static bool FileHolds(const std::string &name, off_t file_page, page_id_t page_id) {
+  char buf[PAGE_SIZE];
+  int fd = open(name.c_str(), O_RDONLY);
+  bool read = fd >= 0 && pread(fd, buf, PAGE_SIZE, file_page * PAGE_SIZE) == PAGE_SIZE;
+  if (fd >= 0) {
+    close(fd);
+  }
+  page_id_t stored;
+  memcpy(&stored, buf, sizeof(stored));
+  return read && stored == page_id;
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, StripingTest) {
+  const std::string db_file("test.db");
+  const page_id_t num_pages = 100;
+  DiskManagerOptions options;
+  options.stripe_files_ = {"test_1.db", "test_2.db"};
+  options.stripe_pages_ = 4;
+  char data[PAGE_SIZE] = {0};
+  char buf[PAGE_SIZE];
+  page_id_t stored;
+
+  // Scenario: Pages are dealt out to the files four at a time, each file packed.
+  auto *dm = new DiskManager(db_file, options);
+  EXPECT_EQ(3, dm->GetTablespace().GetNumFiles());
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    memcpy(data, &page_id, sizeof(page_id));
+    dm->WritePage(page_id, data);
+  }
+  EXPECT_EQ(36, FilePages(db_file));
+  EXPECT_EQ(32, FilePages("test_1.db"));
+  EXPECT_EQ(32, FilePages("test_2.db"));
+  EXPECT_TRUE(FileHolds(db_file, 3, 3));
+  EXPECT_TRUE(FileHolds("test_1.db", 1, 5));
+  EXPECT_TRUE(FileHolds("test_2.db", 0, 8));
+  EXPECT_TRUE(FileHolds(db_file, 5, 13));
+  EXPECT_TRUE(FileHolds(db_file, 35, 99));
+
+  // Scenario: Every read path finds the pages, including batches that cross from file to file.
+  std::vector<char> batch(static_cast<size_t>(num_pages) * PAGE_SIZE);
+  std::vector<page_id_t> page_ids;
+  std::vector<char *> buffers;
+  for (page_id_t page_id = 2; page_id < num_pages; ++page_id) {
+    page_ids.push_back(page_id);
+    buffers.push_back(&batch[page_id * PAGE_SIZE]);
+  }
+  page_ids.push_back(0);
+  buffers.push_back(&batch[0]);
+  dm->ReadPages(page_ids.data(), buffers.data(), page_ids.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    memcpy(&stored, buffers[i], sizeof(stored));
+    EXPECT_EQ(page_ids[i], stored);
+  }
+  bool done = false;
+  dm->SubmitRead(57, buf, [&done](bool ok) { done = ok; });
+  while (dm->GetNumPending() > 0) {
+    dm->Poll(1);
+  }
+  EXPECT_TRUE(done);
+  memcpy(&stored, buf, sizeof(stored));
+  EXPECT_EQ(57, stored);
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    EXPECT_TRUE(dm->VerifyPage(page_id));
+  }
+
+  // Scenario: The files open again with the same layout, and not with another one.
+  dm->ShutDown();
+  delete dm;
+  dm = new DiskManager(db_file, options);
+  EXPECT_EQ(num_pages, dm->GetPageIdLimit());
+  dm->ReadPage(77, buf);
+  memcpy(&stored, buf, sizeof(stored));
+  EXPECT_EQ(77, stored);
+  DiskManagerOptions other = options;
+  other.stripe_pages_ = 8;
+  EXPECT_THROW(DiskManager(db_file, other), Exception);
+  other = options;
+  other.stripe_layout_ = StripeLayout::RANGE;
+  EXPECT_THROW(DiskManager(db_file, other), Exception);
+  EXPECT_THROW(DiskManager(db_file, DiskManagerOptions()), Exception);
+  other = options;
+  other.compress_pages_ = true;
+  EXPECT_THROW(DiskManager(db_file, other), Exception);
+
+  // Scenario: Shrink cuts off every file after its last allocated page.
+  for (page_id_t page_id = 50; page_id < num_pages; ++page_id) {
+    dm->DeallocatePage(page_id);
+  }
+  EXPECT_EQ(50, dm->Shrink());
+  EXPECT_EQ(18, FilePages(db_file));
+  EXPECT_EQ(16, FilePages("test_1.db"));
+  EXPECT_EQ(16, FilePages("test_2.db"));
+  dm->ReadPage(49, buf);
+  memcpy(&stored, buf, sizeof(stored));
+  EXPECT_EQ(49, stored);
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: A range layout fills the files one after the other, the last one taking the rest.
+  remove(db_file.c_str());
+  RemoveStripeFiles();
+  options.stripe_layout_ = StripeLayout::RANGE;
+  options.stripe_pages_ = 10;
+  dm = new DiskManager(db_file, options);
+  for (page_id_t page_id = 0; page_id < 45; ++page_id) {
+    memcpy(data, &page_id, sizeof(page_id));
+    dm->WritePage(page_id, data);
+  }
+  EXPECT_EQ(10, FilePages(db_file));
+  EXPECT_EQ(10, FilePages("test_1.db"));
+  EXPECT_EQ(25, FilePages("test_2.db"));
+  EXPECT_TRUE(FileHolds("test_1.db", 4, 14));
+  EXPECT_TRUE(FileHolds("test_2.db", 24, 44));
+  dm->ShutDown();
+  delete dm;
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_QueueDepthBenchmark) {
+  // Random 4 KB reads from one thread, keeping a fixed number of asynchronous requests in flight, against one
+  // blocking ReadPage at a time.
+  const page_id_t num_pages = 16384;
+  const int num_ops = 100000;
+  std::string db_file("test.db");
+  DiskManager dm(db_file);
+  std::cout << "  backend: " << (dm.UsesIoUring() ? "io_uring" : "pread fallback") << std::endl;
+  char data[PAGE_SIZE] = {0};
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    dm.WritePage(page_id, data);
+  }
+  dm.Sync();
+
+  std::mt19937 rng(15445);
+  std::vector<char> buf(static_cast<size_t>(DiskManager::ASYNC_QUEUE_DEPTH) * PAGE_SIZE);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_ops; ++i) {
+    dm.ReadPage(static_cast<page_id_t>(rng() % num_pages), buf.data());
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  std::cout << "  sync pread: " << static_cast<double>(num_ops) / elapsed.count() * 1000 << " kIOPS" << std::endl;
+
+  for (unsigned depth = 1; depth <= DiskManager::ASYNC_QUEUE_DEPTH; depth *= 2) {
+    int submitted = 0;
+    int completed = 0;
+    start = std::chrono::steady_clock::now();
+    // every completion frees its buffer slot for the next request
+    std::function<void(unsigned)> submit = [&](unsigned slot) {
+      if (submitted == num_ops) {
+        return;
+      }
+      submitted++;
+      dm.SubmitRead(static_cast<page_id_t>(rng() % num_pages), &buf[static_cast<size_t>(slot) * PAGE_SIZE],
+                    [&, slot](bool ok) {
+                      completed++;
+                      submit(slot);
+                    });
+    };
+    for (unsigned slot = 0; slot < depth; ++slot) {
+      submit(slot);
+    }
+    while (completed < num_ops) {
+      dm.Poll(1);
+    }
+    elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "  queue depth " << depth << ": " << static_cast<double>(num_ops) / elapsed.count() * 1000
+              << " kIOPS" << std::endl;
+  }
+  dm.ShutDown();
+}
+
+// Random page reads and writes with and without checksums, through the OS page cache (where checksumming is most
+// visible) and with O_DIRECT (where every access pays for the device), from one thread and from four. Run with
+// --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_ChecksumOverheadBenchmark) {
+  const page_id_t num_pages = 4096;
+  std::string db_file("test.db");
+
+  for (bool direct_io : {false, true}) {
+    const int num_ops = direct_io ? 20000 : 200000;
+    for (int num_threads : {1, 4}) {
+      for (bool write : {false, true}) {
+        double baseline = 0;
+        for (bool checksums : {false, true}) {
+          remove(db_file.c_str());
+          DiskManagerOptions options;
+          options.checksums_ = checksums;
+          options.direct_io_ = direct_io;
+          DiskManager dm(db_file, options);
+          if (direct_io && !dm.UsesDirectIo()) {
+            std::cout << "  O_DIRECT is not supported here" << std::endl;
+            dm.ShutDown();
+            return;
+          }
+          auto run = [&dm, write, num_pages](int seed, int ops) {
+            auto *buf = static_cast<char *>(aligned_alloc(DiskManager::DIRECT_IO_ALIGNMENT, PAGE_SIZE));
+            memset(buf, 'x', PAGE_SIZE);
+            std::mt19937 rng(seed);
+            std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+            for (int i = 0; i < ops; ++i) {
+              if (write) {
+                dm.WritePage(dist(rng), buf);
+              } else {
+                dm.ReadPage(dist(rng), buf);
+              }
+            }
+            free(buf);
+          };
+          // every page is written once, so that reads find a checksum to check
+          char data[PAGE_SIZE];
+          memset(data, 'x', PAGE_SIZE);
+          for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+            dm.WritePage(page_id, data);
+          }
+          auto start = std::chrono::steady_clock::now();
+          std::vector<std::thread> threads;
+          for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back(run, 15445 + t, num_ops / num_threads);
+          }
+          for (auto &thread : threads) {
+            thread.join();
+          }
+          std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+          double per_op = elapsed.count() / num_ops;
+          std::cout << "  " << (direct_io ? "O_DIRECT " : "buffered ") << (write ? "write" : "read ") << ", "
+                    << num_threads << (num_threads == 1 ? " thread,  " : " threads, ")
+                    << (checksums ? "checksums:    " : "no checksums: ") << per_op << " ns/page";
+          if (checksums) {
+            std::cout << " (+" << (per_op / baseline - 1) * 100 << "%)";
+          }
+          std::cout << std::endl;
+          baseline = per_op;
+          dm.ShutDown();
+        }
+      }
+    }
+  }
+}
+
+// Cold batched reads of a whole file, 64 pages per ReadPages, from one file and striped over four. With all files on
+// one device this shows the cost of splitting the batches; put the stripe files on other devices to see the gain.
+// Run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_StripingBenchmark) {
+  const page_id_t num_pages = 16384;
+  const size_t batch_pages = 64;
+  const std::vector<std::string> stripe_files = {"test_1.db", "test_2.db", "test_3.db"};
+  std::string db_file("test.db");
+  std::vector<char> batch(batch_pages * PAGE_SIZE, 'x');
+  std::vector<char *> buffers;
+  for (size_t i = 0; i < batch_pages; ++i) {
+    buffers.push_back(&batch[i * PAGE_SIZE]);
+  }
+
+  for (bool striped : {false, true}) {
+    remove(db_file.c_str());
+    RemoveStripeFiles();
+    DiskManagerOptions options;
+    if (striped) {
+      options.stripe_files_ = stripe_files;
+      options.stripe_pages_ = 16;
+    }
+    auto *dm = new DiskManager(db_file, options);
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      dm->WritePage(page_id, batch.data());
+    }
+    dm->Sync();
+    std::vector<std::string> files = {db_file};
+    files.insert(files.end(), options.stripe_files_.begin(), options.stripe_files_.end());
+    for (const std::string &name : files) {
+      int fd = open(name.c_str(), O_RDONLY);
+      ASSERT_GE(fd, 0);
+      posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+      close(fd);
+    }
+    std::vector<page_id_t> page_ids(batch_pages);
+    auto start = std::chrono::steady_clock::now();
+    for (page_id_t first = 0; first < num_pages; first += batch_pages) {
+      for (size_t i = 0; i < batch_pages; ++i) {
+        page_ids[i] = first + static_cast<page_id_t>(i);
+      }
+      dm->ReadPages(page_ids.data(), buffers.data(), batch_pages);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "  " << files.size() << (striped ? " files: " : " file:  ") << elapsed.count() * 1000 << " ms, "
+              << num_pages * PAGE_SIZE / elapsed.count() / (1 << 20) << " MB/s" << std::endl;
+    dm->ShutDown();
+    delete dm;
+  }
+}
+
 }  // namespace bustub
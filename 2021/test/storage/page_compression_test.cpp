@@ -0,0 +1,197 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_compression_test.cpp
+//
+// Identification: test/storage/page_compression_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/table_generator.h"
+#include "common/lz4.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+class PageCompressionTest : public ::testing::Test {
+ protected:
+  void SetUp() override { TearDown(); }
+
+  void TearDown() override {
+    for (const std::string name : {"plain", "compressed"}) {
+      for (const std::string extension : {".db", ".log", ".fsm", ".cpm"}) {
+        remove((name + extension).c_str());
+      }
+    }
+  }
+
+  /**
+   * Creates TableGenerator's test tables num_copies times over through a buffer pool of pool_size frames, and shuts
+   * the disk manager down. The generator's data does not change from run to run.
+   */
+  static void GenerateTables(const std::string &db_file, bool compress, size_t pool_size, int num_copies) {
+    DiskManagerOptions options;
+    options.compress_pages_ = compress;
+    DiskManager disk_manager(db_file, options);
+    auto *bpm = new BufferPoolManagerInstance(pool_size, &disk_manager);
+    LockManager lock_manager;
+    TransactionManager txn_mgr(&lock_manager, nullptr);
+    for (int copy = 0; copy < num_copies; ++copy) {
+      Catalog catalog(bpm, &lock_manager, nullptr);
+      Transaction *txn = txn_mgr.Begin();
+      ExecutorContext exec_ctx(txn, &catalog, bpm, &txn_mgr, &lock_manager);
+      TableGenerator gen{&exec_ctx};
+      gen.GenerateTestTables();
+      txn_mgr.Commit(txn);
+      delete txn;
+    }
+    bpm->FlushAllPages();
+    delete bpm;
+    disk_manager.ShutDown();
+  }
+
+  static off_t FileSize(const std::string &file_name) {
+    struct stat stat_buf;
+    return stat(file_name.c_str(), &stat_buf) == 0 ? stat_buf.st_size : -1;
+  }
+
+  /**
+   * @return the pages of a plain db file that were written. Table heaps allocate pages in extents, so many pages are
+   * allocated but never written, and they cost nothing compressed.
+   */
+  static std::vector<page_id_t> WrittenPages(const std::string &db_file) {
+    DiskManager disk_manager(db_file);
+    std::vector<page_id_t> written;
+    char page[PAGE_SIZE];
+    char zeros[PAGE_SIZE] = {0};
+    for (page_id_t page_id = 0; page_id < disk_manager.GetPageIdLimit(); ++page_id) {
+      disk_manager.ReadPage(page_id, page);
+      if (memcmp(page, zeros, PAGE_SIZE) != 0) {
+        written.push_back(page_id);
+      }
+    }
+    disk_manager.ShutDown();
+    return written;
+  }
+
+  /** Reads pages of a db file. @return the elapsed time in ms */
+  static double ReadPages(const std::string &db_file, bool compress, bool cold, const std::vector<page_id_t> &pages) {
+    if (cold) {
+      int fd = open(db_file.c_str(), O_RDONLY);
+      posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+      close(fd);
+    }
+    DiskManagerOptions options;
+    options.compress_pages_ = compress;
+    DiskManager disk_manager(db_file, options);
+    char page[PAGE_SIZE];
+    auto start = std::chrono::steady_clock::now();
+    for (page_id_t page_id : pages) {
+      disk_manager.ReadPage(page_id, page);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    disk_manager.ShutDown();
+    return elapsed.count();
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(PageCompressionTest, TableGeneratorTest) {
+  // a small pool, so that pages are evicted and read back while the tables fill up
+  GenerateTables("plain.db", false, 16, 3);
+  GenerateTables("compressed.db", true, 16, 3);
+
+  // Scenario: The compressed file holds the same pages, in a fraction of the space.
+  DiskManager plain("plain.db");
+  DiskManagerOptions options;
+  options.compress_pages_ = true;
+  DiskManager compressed("compressed.db", options);
+  ASSERT_EQ(plain.GetPageIdLimit(), compressed.GetPageIdLimit());
+  char expected[PAGE_SIZE];
+  char page[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < plain.GetPageIdLimit(); ++page_id) {
+    plain.ReadPage(page_id, expected);
+    compressed.ReadPage(page_id, page);
+    ASSERT_EQ(0, memcmp(expected, page, PAGE_SIZE)) << "page " << page_id;
+  }
+  EXPECT_EQ(0, compressed.GetNumChecksumFailures());
+  uint64_t stored_bytes = compressed.GetNumStoredBytes();
+  plain.ShutDown();
+  compressed.ShutDown();
+  EXPECT_GT(WrittenPages("plain.db").size() * PAGE_SIZE / 2, stored_bytes);
+}
+
+// Compression ratio of TableGenerator's tables, and the time to read them back with and without compression, from
+// the OS page cache and cold. Run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST_F(PageCompressionTest, DISABLED_CompressionBenchmark) {
+  const int num_copies = 100;
+  GenerateTables("plain.db", false, 1024, num_copies);
+  GenerateTables("compressed.db", true, 1024, num_copies);
+  std::vector<page_id_t> written = WrittenPages("plain.db");
+  off_t plain_bytes = written.size() * PAGE_SIZE;
+  off_t compressed_bytes = FileSize("compressed.db");
+  DiskManagerOptions options;
+  options.compress_pages_ = true;
+  auto *disk_manager = new DiskManager("compressed.db", options);
+  std::cout << written.size() << " pages written of " << disk_manager->GetPageIdLimit() << " allocated: " << plain_bytes
+            << " bytes plain, " << disk_manager->GetNumStoredBytes() << " bytes compressed, file of "
+            << compressed_bytes << " bytes (ratio " << static_cast<double>(plain_bytes) / compressed_bytes << ")"
+            << std::endl;
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  // the codec alone, on the same pages
+  std::vector<std::vector<char>> blocks;
+  {
+    DiskManager plain("plain.db");
+    char page[PAGE_SIZE];
+    std::vector<char> block(PAGE_SIZE + PAGE_SIZE / 255 + 16);
+    for (page_id_t page_id : written) {
+      plain.ReadPage(page_id, page);
+      size_t size = Lz4Compress(page, PAGE_SIZE, block.data(), block.size());
+      blocks.emplace_back(block.begin(), block.begin() + size);
+    }
+    plain.ShutDown();
+  }
+  const int rounds = 20;
+  char page[PAGE_SIZE];
+  size_t size;
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < rounds; ++round) {
+    for (const auto &block : blocks) {
+      Lz4Decompress(block.data(), block.size(), page, PAGE_SIZE, &size);
+    }
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << "Lz4Decompress: " << elapsed.count() * 1e9 / (rounds * blocks.size()) << " ns/page, "
+            << rounds * blocks.size() * PAGE_SIZE / elapsed.count() / (1 << 30) << " GB/s" << std::endl;
+
+  for (bool cold : {true, false}) {
+    for (bool compress : {false, true}) {
+      double ms = ReadPages(compress ? "compressed.db" : "plain.db", compress, cold, written);
+      std::cout << (cold ? "cold " : "warm ") << (compress ? "compressed" : "plain     ")
+                << " read of the written pages: " << ms << " ms, " << ms * 1e6 / written.size()
+                << " ns/page" << std::endl;
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,208 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard_test.cpp
+//
+// Identification: test/storage/page_guard_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/page_guard.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  {
+    WritePageGuard guard = bpm->NewPageGuarded(&page_id);
+    ASSERT_TRUE(guard);
+    snprintf(guard.GetDataMut(), PAGE_SIZE, "Hello");
+  }
+  Page *page = bpm->FetchPage(page_id);
+  EXPECT_EQ(1, page->GetPinCount());
+  EXPECT_TRUE(page->IsDirty());
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  // Moving hands the pin over; only the last owner unpins.
+  {
+    ReadPageGuard first = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(1, page->GetPinCount());
+    ReadPageGuard second = std::move(first);
+    EXPECT_FALSE(first);  // NOLINT
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(0, strcmp(second.GetData(), "Hello"));
+
+    // read latches are shared
+    ReadPageGuard third = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(2, page->GetPinCount());
+    third.Drop();
+    third.Drop();
+    EXPECT_EQ(1, page->GetPinCount());
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+
+  // Assigning over a guard releases what it held first.
+  {
+    WritePageGuard guard = bpm->FetchPageWrite(page_id);
+    page_id_t other_id;
+    WritePageGuard other = bpm->NewPageGuarded(&other_id);
+    Page *other_page = bpm->FetchPage(other_id);
+    bpm->UnpinPage(other_id, false);
+    guard = std::move(other);
+    EXPECT_EQ(0, page->GetPinCount());
+    EXPECT_EQ(1, other_page->GetPinCount());
+    EXPECT_EQ(other_id, guard.PageId());
+  }
+
+  // Pins are never leaked: cycle far more pages than frames through guards.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size * 4; ++i) {
+    WritePageGuard guard = bpm->NewPageGuarded(&page_id);
+    ASSERT_TRUE(guard);
+    snprintf(guard.GetDataMut(), PAGE_SIZE, "%d", page_id);
+    page_ids.push_back(page_id);
+  }
+  for (page_id_t id : page_ids) {
+    ReadPageGuard guard = bpm->FetchPageRead(id);
+    ASSERT_TRUE(guard);
+    EXPECT_EQ(std::to_string(id), guard.GetData());
+  }
+
+  // A failed fetch yields an empty guard.
+  std::vector<ReadPageGuard> held;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    held.push_back(bpm->FetchPageRead(page_ids[i]));
+  }
+  EXPECT_FALSE(bpm->FetchPageRead(page_ids.back()));
+  EXPECT_FALSE(bpm->NewPageGuarded(&page_id));
+
+  held.clear();
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, OptimisticTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  bpm->NewPageGuarded(&page_id).Drop();
+
+  OptimisticPageGuard guard = bpm->FetchPageOptimistic(page_id);
+  ASSERT_TRUE(guard);
+  EXPECT_TRUE(guard.Validate());
+
+  // readers do not invalidate each other
+  bpm->FetchPageRead(page_id).Drop();
+  EXPECT_TRUE(guard.Validate());
+
+  // a writer does, even one that changes nothing
+  bpm->FetchPageWrite(page_id).Drop();
+  EXPECT_FALSE(guard.Validate());
+  EXPECT_TRUE(guard.Restart());
+  EXPECT_TRUE(guard.Validate());
+
+  // the optimistic guard holds a pin, so the frame cannot be reused under it
+  std::vector<WritePageGuard> others;
+  page_id_t other_id;
+  for (size_t i = 1; i < buffer_pool_size; ++i) {
+    others.push_back(bpm->NewPageGuarded(&other_id));
+  }
+  EXPECT_FALSE(bpm->NewPageGuarded(&other_id));
+  guard.Drop();
+  EXPECT_TRUE(bpm->NewPageGuarded(&other_id));
+
+  others.clear();
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, ConcurrentOptimisticTest) {
+  // A writer keeps two counters on the page equal under the write latch; an optimistic reader must never validate
+  // a read that saw them differ.
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const int num_writes = 20000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  bpm->NewPageGuarded(&page_id).Drop();
+
+  std::atomic<bool> done = false;
+  std::thread writer([bpm, page_id, &done] {
+    for (int i = 1; i <= num_writes; ++i) {
+      WritePageGuard guard = bpm->FetchPageWrite(page_id);
+      char *data = guard.GetDataMut();
+      memcpy(data, &i, sizeof(i));
+      std::this_thread::yield();
+      memcpy(data + PAGE_SIZE / 2, &i, sizeof(i));
+    }
+    done = true;
+  });
+
+  int validated = 0;
+  int last_seen = 0;
+  OptimisticPageGuard guard = bpm->FetchPageOptimistic(page_id);
+  bool writer_done;
+  do {
+    // sample the flag first, so the last round reads the final contents
+    writer_done = done;
+    int first;
+    int second;
+    do {
+      memcpy(&first, guard.GetData(), sizeof(first));
+      memcpy(&second, guard.GetData() + PAGE_SIZE / 2, sizeof(second));
+    } while (!guard.Validate() && guard.Restart());
+    EXPECT_EQ(first, second);
+    EXPECT_LE(last_seen, first);
+    last_seen = first;
+    validated++;
+    guard.Restart();
+  } while (!writer_done);
+  writer.join();
+  EXPECT_GT(validated, 0);
+  EXPECT_EQ(num_writes, last_seen);
+  guard.Drop();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
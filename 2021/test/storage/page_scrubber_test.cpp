@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_scrubber_test.cpp
+//
+// Identification: test/storage/page_scrubber_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_scrubber.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+class PageScrubberTest : public ::testing::Test {
+ protected:
+  void SetUp() override { TearDown(); }
+
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  }
+
+  /** Overwrites one byte of a page, bypassing the disk manager. */
+  static void CorruptPage(page_id_t page_id) {
+    int fd = open("test.db", O_RDWR);
+    ASSERT_GE(fd, 0);
+    char byte = '!';
+    ASSERT_EQ(1, pwrite(fd, &byte, 1, static_cast<off_t>(page_id) * PAGE_SIZE + 10));
+    close(fd);
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(PageScrubberTest, ScrubRoundTest) {
+  const page_id_t num_pages = 32;
+  DiskManagerOptions options;
+  options.checksums_ = true;
+  auto *disk_manager = new DiskManager("test.db", options);
+  auto *bpm = new BufferPoolManagerInstance(4, disk_manager);
+  page_id_t page_id;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    memset(page->GetData(), 'a' + i % 26, PAGE_SIZE);
+    bpm->UnpinPage(page_id, true);
+  }
+  bpm->FlushAllPages();
+  bpm->DeletePage(num_pages - 1);
+
+  // Scenario: Rounds pick up where the last one stopped and wrap around; freed pages are not read.
+  PageScrubber scrubber(disk_manager);
+  EXPECT_EQ(20, scrubber.ScrubRound(20));
+  EXPECT_EQ(0, scrubber.GetNumPasses());
+  EXPECT_EQ(20, scrubber.ScrubRound(20));
+  EXPECT_EQ(1, scrubber.GetNumPasses());
+  EXPECT_EQ(40, scrubber.GetNumScrubbed());
+  EXPECT_EQ(num_pages - 1, scrubber.ScrubRound(1000));
+  EXPECT_EQ(0, disk_manager->GetNumChecksumFailures());
+
+  // Scenario: Corruption in a cold page is found; pages resident in the buffer pool are left alone.
+  CorruptPage(3);
+  CorruptPage(num_pages - 2);
+  PageScrubber skips_resident(disk_manager, bpm);
+  size_t num_resident = bpm->GetResidentPages().size();
+  EXPECT_LT(0, num_resident);
+  EXPECT_EQ(num_pages - 1 - num_resident, skips_resident.ScrubRound(1000));
+  EXPECT_EQ(std::vector<page_id_t>{3}, disk_manager->GetCorruptPages());
+
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(PageScrubberTest, BackgroundTest) {
+  const page_id_t num_pages = 64;
+  DiskManagerOptions options;
+  options.checksums_ = true;
+  DiskManager disk_manager("test.db", options);
+  char data[PAGE_SIZE];
+  memset(data, 'x', PAGE_SIZE);
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    disk_manager.WritePage(disk_manager.AllocatePage(), data);
+  }
+  CorruptPage(50);
+
+  // Scenario: The background thread keeps passing over the file at its rate limit and reports the bad page.
+  PageScrubber scrubber(&disk_manager);
+  PageScrubberConfig config;
+  config.interval_ = std::chrono::milliseconds(1);
+  config.pages_per_round_ = 16;
+  scrubber.Start(config);
+  scrubber.Start(config);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (scrubber.GetNumPasses() < 2 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  scrubber.Stop();
+  scrubber.Stop();
+  EXPECT_LE(2, scrubber.GetNumPasses());
+  EXPECT_LE(2 * num_pages, scrubber.GetNumScrubbed());
+  EXPECT_EQ(std::vector<page_id_t>{50}, disk_manager.GetCorruptPages());
+  EXPECT_LE(2, disk_manager.GetNumChecksumFailures());
+
+  // Scenario: Foreground writes racing with the scrubber are never mistaken for corruption.
+  disk_manager.WritePage(50, data);
+  uint64_t failures = disk_manager.GetNumChecksumFailures();
+  config.interval_ = std::chrono::milliseconds(0);
+  scrubber.Start(config);
+  for (int round = 0; round < 20; ++round) {
+    for (page_id_t i = 0; i < num_pages; ++i) {
+      memset(data, 'a' + round, PAGE_SIZE);
+      disk_manager.WritePage(i, data);
+    }
+  }
+  scrubber.Stop();
+  EXPECT_EQ(failures, disk_manager.GetNumChecksumFailures());
+  EXPECT_TRUE(disk_manager.GetCorruptPages().empty());
+  disk_manager.ShutDown();
+}
+
+}  // namespace bustub
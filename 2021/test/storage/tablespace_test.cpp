@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tablespace_test.cpp
+//
+// Identification: test/storage/tablespace_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/tablespace.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(TablespaceTest, LocateTest) {
+  Tablespace single;
+  EXPECT_EQ(0, single.Locate(12345).file_);
+  EXPECT_EQ(12345 * PAGE_SIZE, single.Locate(12345).offset_);
+
+  Tablespace round_robin(3, StripeLayout::ROUND_ROBIN, 4);
+  EXPECT_EQ(1, round_robin.Locate(5).file_);
+  EXPECT_EQ(1 * PAGE_SIZE, round_robin.Locate(5).offset_);
+  EXPECT_EQ(0, round_robin.Locate(13).file_);
+  EXPECT_EQ(5 * PAGE_SIZE, round_robin.Locate(13).offset_);
+  EXPECT_EQ(3, round_robin.GetRunLength(5));
+
+  Tablespace range(3, StripeLayout::RANGE, 10);
+  EXPECT_EQ(1, range.Locate(14).file_);
+  EXPECT_EQ(4 * PAGE_SIZE, range.Locate(14).offset_);
+  EXPECT_EQ(2, range.Locate(1000).file_);
+  EXPECT_EQ(980 * PAGE_SIZE, range.Locate(1000).offset_);
+  EXPECT_EQ(6, range.GetRunLength(14));
+  EXPECT_GT(range.GetRunLength(1000), 1000000);
+}
+
+// NOLINTNEXTLINE
+TEST(TablespaceTest, ConsistencyTest) {
+  // every way of computing a page's place agrees with Locate
+  for (uint32_t num_files : {1, 2, 3, 5}) {
+    for (StripeLayout layout : {StripeLayout::ROUND_ROBIN, StripeLayout::RANGE}) {
+      for (page_id_t stripe_pages : {1, 4, 7}) {
+        Tablespace tablespace(num_files, layout, stripe_pages);
+        std::vector<page_id_t> file_pages(num_files, 0);
+        for (page_id_t limit = 0; limit < 120; ++limit) {
+          for (uint32_t file = 0; file < num_files; ++file) {
+            ASSERT_EQ(file_pages[file], tablespace.GetFilePages(file, limit));
+          }
+          ASSERT_EQ(limit, tablespace.GetPageIdLimit(file_pages));
+
+          Tablespace::Location location = tablespace.Locate(limit);
+          page_id_t file_page = location.offset_ / PAGE_SIZE;
+          // files are packed: the next page id of a file goes right after its last one
+          ASSERT_EQ(file_pages[location.file_], file_page);
+          ASSERT_EQ(limit, tablespace.GetPageId(location.file_, file_page));
+          file_pages[location.file_]++;
+
+          page_id_t run_length = tablespace.GetRunLength(limit);
+          ASSERT_GE(run_length, 1);
+          if (run_length < 1000) {
+            Tablespace::Location last = tablespace.Locate(limit + run_length - 1);
+            ASSERT_EQ(location.file_, last.file_);
+            ASSERT_EQ(location.offset_ + (run_length - 1) * PAGE_SIZE, last.offset_);
+            // and the run really ends there
+            Tablespace::Location next = tablespace.Locate(limit + run_length);
+            ASSERT_TRUE(next.file_ != location.file_ || next.offset_ != last.offset_ + PAGE_SIZE);
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace bustub
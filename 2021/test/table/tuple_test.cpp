@@ -10,7 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <iostream>
 #include <string>
@@ -21,6 +25,7 @@
 #include "logging/common.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
@@ -71,4 +76,204 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+/** Fills a table through a pool large enough to hold all of it and writes it out. @return its first page id */
+static page_id_t BuildTable(DiskManager *disk_manager, int num_tuples) {
+  auto *transaction = new Transaction(0);
+  auto *bpm = new BufferPoolManagerInstance(4096, disk_manager);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, transaction);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"payload", TypeId::VARCHAR, 100}});
+  std::string payload(100, 'x');
+  for (int i = 0; i < num_tuples; ++i) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(payload)}, &schema);
+    RID rid;
+    EXPECT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  }
+  page_id_t first_page_id = table->GetFirstPageId();
+  bpm->FlushAllPages();
+  delete table;
+  delete bpm;
+  delete transaction;
+  return first_page_id;
+}
+
+/** Scans the whole table through a fresh, cold pool. @return the number of tuples seen, all in insertion order */
+static int ColdScan(DiskManager *disk_manager, page_id_t first_page_id, size_t buffer_pool_size, size_t read_ahead,
+                    uint64_t *prefetched) {
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"payload", TypeId::VARCHAR, 100}});
+  auto *transaction = new Transaction(0);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, first_page_id);
+  table->SetReadAhead(read_ahead);
+  int scanned = 0;
+  for (auto it = table->Begin(transaction); it != table->End(); ++it) {
+    EXPECT_EQ(scanned, it->GetValue(&schema, 0).GetAs<int32_t>());
+    scanned++;
+  }
+  *prefetched = bpm->GetPrefetchCount();
+  delete table;
+  delete bpm;
+  delete transaction;
+  return scanned;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, ReadAheadScanTest) {
+  const int num_tuples = 4000;
+  auto *disk_manager = new DiskManager("test.db");
+  page_id_t first_page_id = BuildTable(disk_manager, num_tuples);
+
+  // The prefetcher only changes when pages are read, never what the scan sees.
+  uint64_t prefetched;
+  EXPECT_EQ(num_tuples, ColdScan(disk_manager, first_page_id, 32, 0, &prefetched));
+  EXPECT_EQ(0, prefetched);
+  EXPECT_EQ(num_tuples, ColdScan(disk_manager, first_page_id, 32, TableHeap::DEFAULT_READ_AHEAD_PAGES, &prefetched));
+  EXPECT_GT(prefetched, 0);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// Cold full-table scan with read-ahead off and on. The table is pushed out of the OS page cache before every scan.
+// Run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(TupleTest, DISABLED_ColdScanReadAheadBenchmark) {
+  const int num_tuples = 30000;
+  const size_t buffer_pool_size = 128;
+  auto *disk_manager = new DiskManager("test.db");
+  page_id_t first_page_id = BuildTable(disk_manager, num_tuples);
+
+  for (size_t read_ahead : {size_t{0}, size_t{8}, size_t{32}}) {
+    int fd = open("test.db", O_RDONLY);
+    ASSERT_GE(fd, 0);
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+
+    uint64_t prefetched;
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(num_tuples, ColdScan(disk_manager, first_page_id, buffer_pool_size, read_ahead, &prefetched));
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "read-ahead " << read_ahead << " pages: " << elapsed.count() << " ms, " << prefetched
+              << " prefetcher fetches" << std::endl;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+/**
+ * Fills several tables at once, one tuple to each in turn, so that they all grow at the same time.
+ * @param[out] fragmentation the fragmentation of every table
+ * @return the first page ids of the tables
+ */
+static std::vector<page_id_t> BuildInterleavedTables(DiskManager *disk_manager, int num_tables, int num_tuples,
+                                                     size_t extent_pages,
+                                                     std::vector<PageFragmentation> *fragmentation) {
+  auto *transaction = new Transaction(0);
+  auto *bpm = new BufferPoolManagerInstance(4096, disk_manager);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"payload", TypeId::VARCHAR, 100}});
+  std::string payload(100, 'x');
+  std::vector<TableHeap *> tables;
+  for (int t = 0; t < num_tables; ++t) {
+    tables.push_back(new TableHeap(bpm, nullptr, nullptr, transaction, extent_pages));
+  }
+  for (int i = 0; i < num_tuples; ++i) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(payload)}, &schema);
+    for (auto *table : tables) {
+      RID rid;
+      EXPECT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    }
+  }
+  std::vector<page_id_t> first_page_ids;
+  fragmentation->clear();
+  for (auto *table : tables) {
+    first_page_ids.push_back(table->GetFirstPageId());
+    fragmentation->push_back(table->GetFragmentation());
+    delete table;
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+  delete transaction;
+  return first_page_ids;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, InterleavedTablesTest) {
+  const int num_tables = 3;
+  const int num_tuples = 2000;
+  const size_t extent_pages = 8;
+  std::vector<PageFragmentation> fragmentation;
+
+  // Scenario: Page at a time, tables growing together take turns on disk and every step of a scan is a jump.
+  auto *disk_manager = new DiskManager("test.db");
+  BuildInterleavedTables(disk_manager, num_tables, num_tuples, 1, &fragmentation);
+  for (const auto &table : fragmentation) {
+    EXPECT_GT(table.num_pages_, 4 * extent_pages);
+    EXPECT_EQ(table.num_pages_, table.num_runs_);
+    EXPECT_DOUBLE_EQ(1, table.Fragmentation());
+  }
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+  delete disk_manager;
+
+  // Scenario: With extents, every table is a few sequential runs, one per extent, and scans the same tuples.
+  disk_manager = new DiskManager("test.db");
+  std::vector<page_id_t> first_page_ids =
+      BuildInterleavedTables(disk_manager, num_tables, num_tuples, extent_pages, &fragmentation);
+  for (int t = 0; t < num_tables; ++t) {
+    const PageFragmentation &table = fragmentation[t];
+    EXPECT_EQ((table.num_pages_ + extent_pages - 1) / extent_pages, table.num_runs_);
+    EXPECT_LT(table.Fragmentation(), 1.0 / extent_pages + 0.01);
+    uint64_t prefetched;
+    EXPECT_EQ(num_tuples, ColdScan(disk_manager, first_page_ids[t], 32, 0, &prefetched));
+  }
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+  delete disk_manager;
+}
+
+// Cold scans of tables that were loaded together, one tuple to each in turn, with growing extent sizes. Extent size 1
+// is plain page-at-a-time allocation. The tables are pushed out of the OS page cache before every scan.
+// Run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(TupleTest, DISABLED_InterleavedScanBenchmark) {
+  const int num_tables = 4;
+  const int num_tuples = 20000;
+  const size_t buffer_pool_size = 128;
+
+  for (size_t extent_pages : {size_t{1}, size_t{8}, PageSegment::DEFAULT_EXTENT_PAGES}) {
+    auto *disk_manager = new DiskManager("test.db");
+    std::vector<PageFragmentation> fragmentation;
+    std::vector<page_id_t> first_page_ids =
+        BuildInterleavedTables(disk_manager, num_tables, num_tuples, extent_pages, &fragmentation);
+
+    for (size_t read_ahead : {size_t{0}, TableHeap::DEFAULT_READ_AHEAD_PAGES}) {
+      int fd = open("test.db", O_RDONLY);
+      ASSERT_GE(fd, 0);
+      fdatasync(fd);
+      posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+      close(fd);
+
+      uint64_t prefetched;
+      auto start = std::chrono::steady_clock::now();
+      for (page_id_t first_page_id : first_page_ids) {
+        EXPECT_EQ(num_tuples, ColdScan(disk_manager, first_page_id, buffer_pool_size, read_ahead, &prefetched));
+      }
+      std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << "extent " << extent_pages << " pages, read-ahead " << read_ahead << " pages: fragmentation "
+                << fragmentation[0].Fragmentation() << ", mean run " << fragmentation[0].MeanRunPages()
+                << " pages, scan " << elapsed.count() << " ms" << std::endl;
+    }
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.fsm");
+    delete disk_manager;
+  }
+}
+
 }  // namespace bustub